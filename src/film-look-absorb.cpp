@@ -0,0 +1,471 @@
+#include "film-look-absorb.h"
+#include "film-look-cache.h"
+#include "film-look-lut.h"
+#include "film-look-stock.h"
+
+#include "plugin-support.h"
+
+#include <util/dstr.h>
+#include <util/platform.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 内置滤镜的 id（带版本），只认识这两个的运算
+#define COLOR_CORRECTION_ID "color_filter_v2"
+#define APPLY_LUT_ID "clut_filter"
+
+// 写在被关掉的滤镜的私有设置里，下次启动时还能认出是这里关掉的
+#define ABSORBED_FLAG "film_look_absorbed"
+// 用户把这里关掉的滤镜重新打开了：不再吸收它，直到用户切换“吸收上游调色滤镜”或者胶片外观滤镜本身
+#define DECLINED_FLAG "film_look_absorb_declined"
+
+enum absorb_op {
+	ABSORB_COLOR_CORRECTION,
+	ABSORB_CUBE_LUT,
+};
+
+struct cube_lut {
+	float *table;
+	uint32_t size;
+
+	~cube_lut() { bfree(table); }
+};
+
+struct cached_lut {
+	int64_t mtime;
+	std::shared_ptr<cube_lut> lut;
+};
+
+struct absorb_step {
+	absorb_op op;
+
+	// 色彩校正：和内置滤镜一样先做 gamma，再乘它在 CPU 上拼好的颜色矩阵。
+	// 行向量的写法，最后一行是平移
+	float gamma;
+	float matrix[4][3];
+
+	// 应用 LUT
+	std::shared_ptr<cube_lut> lut;
+	float amount;
+};
+
+struct film_look_absorb {
+	std::vector<obs_weak_source_t *> absorbed;
+	std::vector<obs_weak_source_t *> declined;
+	std::vector<absorb_step> steps;
+	uint64_t signature;
+
+	// .cube 按路径和修改时间缓存，链里其他滤镜的设置变化时不用重新解析，文件被覆盖时重新读
+	std::unordered_map<std::string, cached_lut> luts;
+};
+
+typedef float mat4[4][4];
+
+struct film_look_absorb *film_look_absorb_create(void)
+{
+	return new film_look_absorb();
+}
+
+static bool get_flag(obs_source_t *source, const char *name)
+{
+	obs_data_t *priv = obs_source_get_private_settings(source);
+	const bool value = obs_data_get_bool(priv, name);
+	obs_data_release(priv);
+	return value;
+}
+
+static void set_flag(obs_source_t *source, const char *name, bool value)
+{
+	obs_data_t *priv = obs_source_get_private_settings(source);
+	obs_data_set_bool(priv, name, value);
+	obs_data_release(priv);
+}
+
+static void set_absorbed(obs_source_t *source, bool absorbed)
+{
+	set_flag(source, ABSORBED_FLAG, absorbed);
+	obs_source_set_enabled(source, !absorbed);
+}
+
+static void release_weak_list(std::vector<obs_weak_source_t *> &list, void (*fn)(obs_source_t *source))
+{
+	for (obs_weak_source_t *weak : list) {
+		obs_source_t *source = obs_weak_source_get_source(weak);
+		if (source && fn)
+			fn(source);
+		obs_source_release(source);
+		obs_weak_source_release(weak);
+	}
+	list.clear();
+}
+
+static void restore_absorbed(obs_source_t *source)
+{
+	set_absorbed(source, false);
+}
+
+static void clear_declined(obs_source_t *source)
+{
+	set_flag(source, DECLINED_FLAG, false);
+}
+
+void film_look_absorb_destroy(struct film_look_absorb *absorb)
+{
+	if (!absorb)
+		return;
+
+	// 拒绝吸收的标记留在私有设置里，下次启动时照样不吸收
+	release_weak_list(absorb->absorbed, restore_absorbed);
+	release_weak_list(absorb->declined, nullptr);
+	delete absorb;
+}
+
+void film_look_absorb_restore(struct film_look_absorb *absorb)
+{
+	release_weak_list(absorb->absorbed, restore_absorbed);
+	release_weak_list(absorb->declined, clear_declined);
+	absorb->steps.clear();
+	absorb->signature = 0;
+	absorb->luts.clear();
+}
+
+size_t film_look_absorb_count(const struct film_look_absorb *absorb)
+{
+	return absorb->steps.size();
+}
+
+static void color_from_int(uint32_t color, float out[3])
+{
+	// 颜色属性是 0xAABBGGRR
+	out[0] = (float)(color & 0xff) / 255.0f;
+	out[1] = (float)((color >> 8) & 0xff) / 255.0f;
+	out[2] = (float)((color >> 16) & 0xff) / 255.0f;
+}
+
+// out = a * b。行向量右乘，也就是先做 a 再做 b
+static void mat4_mul(const mat4 a, const mat4 b, mat4 out)
+{
+	mat4 m;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			m[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
+	}
+	memcpy(out, m, sizeof(m));
+}
+
+// 绕灰轴旋转色相。和内置滤镜一样从四元数构造（matrix4_from_quat），连 0.57735 这个近似值也照搬
+static void hue_rotation(float degrees, mat4 m)
+{
+	const float half_angle = 0.5f * degrees * (3.14159265f / 180.0f);
+	const float x = 0.57735f * std::sin(half_angle);
+	const float w = std::cos(half_angle);
+	const float norm = 3.0f * x * x + w * w;
+	const float s = norm > 0.0f ? 2.0f / norm : 0.0f;
+	const float xx = x * x * s;
+	const float wx = w * x * s;
+
+	const mat4 rotation = {
+		{1.0f - 2.0f * xx, xx + wx, xx - wx, 0.0f},
+		{xx - wx, 1.0f - 2.0f * xx, xx + wx, 0.0f},
+		{xx + wx, xx - wx, 1.0f - 2.0f * xx, 0.0f},
+		{0.0f, 0.0f, 0.0f, 1.0f},
+	};
+	memcpy(m, rotation, sizeof(rotation));
+}
+
+// color_filter_v2 的 update：亮度 -> 对比度 -> 饱和度（BT.601 权重）-> 色相 -> 乘色和加色
+// 拼成一个矩阵，shader 里先 pow(gamma) 再乘这个矩阵
+static bool parse_color_correction(obs_data_t *settings, absorb_step &step)
+{
+	// 不透明度改的是 alpha，和调色 LUT 合不到一起
+	if (obs_data_get_double(settings, "opacity") < 1.0)
+		return false;
+
+	const double gamma = obs_data_get_double(settings, "gamma");
+	step.op = ABSORB_COLOR_CORRECTION;
+	step.gamma = (float)(gamma < 0.0 ? -gamma + 1.0 : 1.0 / (gamma + 1.0));
+
+	const float contrast = (float)obs_data_get_double(settings, "contrast") + 1.0f;
+	const float con_offset = (1.0f - contrast) / 2.0f;
+	const mat4 con = {
+		{contrast, 0.0f, 0.0f, 0.0f},
+		{0.0f, contrast, 0.0f, 0.0f},
+		{0.0f, 0.0f, contrast, 0.0f},
+		{con_offset, con_offset, con_offset, 1.0f},
+	};
+
+	const float brightness = (float)obs_data_get_double(settings, "brightness");
+	const mat4 bright = {
+		{1.0f, 0.0f, 0.0f, 0.0f},
+		{0.0f, 1.0f, 0.0f, 0.0f},
+		{0.0f, 0.0f, 1.0f, 0.0f},
+		{brightness, brightness, brightness, 1.0f},
+	};
+
+	const float saturation = (float)obs_data_get_double(settings, "saturation") + 1.0f;
+	const float sat_r = (1.0f - saturation) * 0.299f;
+	const float sat_g = (1.0f - saturation) * 0.587f;
+	const float sat_b = (1.0f - saturation) * 0.114f;
+	const mat4 sat = {
+		{sat_r + saturation, sat_r, sat_r, 0.0f},
+		{sat_g, sat_g + saturation, sat_g, 0.0f},
+		{sat_b, sat_b, sat_b + saturation, 0.0f},
+		{0.0f, 0.0f, 0.0f, 1.0f},
+	};
+
+	mat4 hue;
+	hue_rotation((float)obs_data_get_double(settings, "hue_shift"), hue);
+
+	float multiply[3];
+	float add[3];
+	color_from_int((uint32_t)obs_data_get_int(settings, "color_multiply"), multiply);
+	color_from_int((uint32_t)obs_data_get_int(settings, "color_add"), add);
+	const mat4 color = {
+		{multiply[0], 0.0f, 0.0f, 0.0f},
+		{0.0f, multiply[1], 0.0f, 0.0f},
+		{0.0f, 0.0f, multiply[2], 0.0f},
+		{add[0], add[1], add[2], 1.0f},
+	};
+
+	mat4 m;
+	mat4_mul(bright, con, m);
+	mat4_mul(m, sat, m);
+	mat4_mul(m, hue, m);
+	mat4_mul(m, color, m);
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 3; j++)
+			step.matrix[i][j] = m[i][j];
+	}
+	return true;
+}
+
+// 按路径和修改时间取缓存的 .cube，文件变了才重新解析
+static std::shared_ptr<cube_lut> load_cube_lut(struct film_look_absorb *absorb, const char *path, int64_t *mtime)
+{
+	struct stat st;
+	if (os_stat(path, &st) != 0)
+		return nullptr;
+
+	auto found = absorb->luts.find(path);
+	if (found != absorb->luts.end() && found->second.mtime == (int64_t)st.st_mtime) {
+		*mtime = found->second.mtime;
+		return found->second.lut;
+	}
+
+	auto lut = std::make_shared<cube_lut>();
+	lut->table = film_look_lut_load_cube(path, &lut->size);
+	if (!lut->table) {
+		absorb->luts.erase(path);
+		return nullptr;
+	}
+
+	*mtime = (int64_t)st.st_mtime;
+	absorb->luts[path] = {*mtime, lut};
+	return lut;
+}
+
+static bool parse_cube_lut(struct film_look_absorb *absorb, obs_data_t *settings, absorb_step &step, int64_t *mtime)
+{
+	const char *path = obs_data_get_string(settings, "image_path");
+	const size_t len = strlen(path);
+	if (len < 5 || astrcmpi(path + len - 5, ".cube") != 0)
+		return false; // 图片格式的 LUT 不吸收
+
+	step.lut = load_cube_lut(absorb, path, mtime);
+	if (!step.lut)
+		return false;
+
+	step.op = ABSORB_CUBE_LUT;
+	step.amount = (float)obs_data_get_double(settings, "clut_amount");
+	return true;
+}
+
+// 解析一个滤镜的运算，并把它的设置（和 .cube 的修改时间）算进签名
+static bool parse_step(struct film_look_absorb *absorb, const char *id, obs_data_t *settings, absorb_step &step,
+		       uint64_t *signature)
+{
+	int64_t mtime = 0;
+	bool supported = false;
+	if (strcmp(id, COLOR_CORRECTION_ID) == 0)
+		supported = parse_color_correction(settings, step);
+	else if (strcmp(id, APPLY_LUT_ID) == 0)
+		supported = parse_cube_lut(absorb, settings, step, &mtime);
+	if (!supported)
+		return false;
+
+	const char *json = obs_data_get_json(settings);
+	*signature = film_look_cache_hash(id, strlen(id), *signature);
+	*signature = film_look_cache_hash(json, strlen(json), *signature);
+	*signature = film_look_cache_hash(&mtime, sizeof(mtime), *signature);
+	return true;
+}
+
+bool film_look_absorb_append(struct film_look_absorb *absorb, const char *id, obs_data_t *settings)
+{
+	absorb_step step = {};
+	if (!parse_step(absorb, id, settings, step, &absorb->signature))
+		return false;
+
+	absorb->steps.push_back(std::move(step));
+	return true;
+}
+
+static bool contains(const std::vector<obs_weak_source_t *> &list, obs_source_t *source)
+{
+	return std::any_of(list.begin(), list.end(), [source](obs_weak_source_t *weak) {
+		return obs_weak_source_references_source(weak, source);
+	});
+}
+
+struct filter_list {
+	std::vector<obs_source_t *> filters;
+};
+
+static void collect_filter(obs_source_t *parent, obs_source_t *child, void *param)
+{
+	UNUSED_PARAMETER(parent);
+	static_cast<filter_list *>(param)->filters.push_back(obs_source_get_ref(child));
+}
+
+bool film_look_absorb_scan(struct film_look_absorb *absorb, obs_source_t *filter)
+{
+	obs_source_t *parent = obs_filter_get_parent(filter);
+	filter_list list;
+	if (parent)
+		obs_source_enum_filters(parent, collect_filter, &list);
+
+	// 枚举顺序就是应用顺序，从自己往前找连续的可吸收滤镜。
+	// 用户自己关掉的滤镜不参与渲染，跳过它继续往前找。
+	auto self = std::find(list.filters.begin(), list.filters.end(), filter);
+	if (self == list.filters.end())
+		self = list.filters.begin(); // 还没挂到源上
+	std::vector<obs_source_t *> chain;
+	std::vector<absorb_step> steps;
+	uint64_t signature = 0;
+
+	for (auto it = self; it != list.filters.begin();) {
+		obs_source_t *source = *--it;
+		if (!source)
+			continue;
+
+		const bool enabled = obs_source_enabled(source);
+		const bool ours = get_flag(source, ABSORBED_FLAG);
+
+		// 只有这里会在标记吸收的同时关掉滤镜，标记着却开着，说明是用户重新打开的
+		if (ours && enabled) {
+			set_flag(source, ABSORBED_FLAG, false);
+			set_flag(source, DECLINED_FLAG, true);
+			blog(LOG_INFO, "[%s] '%s' was re-enabled, no longer absorbing it", PLUGIN_NAME,
+			     obs_source_get_name(source));
+		}
+
+		if (!ours || enabled) {
+			if (!enabled)
+				continue;
+			// 拒绝吸收的滤镜照常渲染，它前面的滤镜也不能再越过它吸收
+			if (get_flag(source, DECLINED_FLAG)) {
+				if (!contains(absorb->declined, source))
+					absorb->declined.push_back(obs_source_get_weak_source(source));
+				break;
+			}
+		}
+
+		absorb_step step = {};
+		obs_data_t *settings = obs_source_get_settings(source);
+		const bool supported = parse_step(absorb, obs_source_get_id(source), settings, step, &signature);
+		obs_data_release(settings);
+
+		if (!supported)
+			break;
+
+		chain.push_back(source);
+		steps.insert(steps.begin(), std::move(step));
+	}
+
+	// 不再吸收的先恢复，再关掉新吸收的
+	for (obs_weak_source_t *weak : absorb->absorbed) {
+		obs_source_t *source = obs_weak_source_get_source(weak);
+		if (source && std::find(chain.begin(), chain.end(), source) == chain.end() &&
+		    get_flag(source, ABSORBED_FLAG))
+			set_absorbed(source, false);
+		obs_source_release(source);
+		obs_weak_source_release(weak);
+	}
+	absorb->absorbed.clear();
+
+	for (obs_source_t *source : chain) {
+		if (obs_source_enabled(source))
+			set_absorbed(source, true);
+		absorb->absorbed.push_back(obs_source_get_weak_source(source));
+	}
+
+	for (obs_source_t *source : list.filters)
+		obs_source_release(source);
+
+	// 链里不再用到的 .cube 不留在缓存里
+	for (auto it = absorb->luts.begin(); it != absorb->luts.end();) {
+		const bool used = std::any_of(steps.begin(), steps.end(),
+					      [&it](const absorb_step &step) { return step.lut == it->second.lut; });
+		it = used ? std::next(it) : absorb->luts.erase(it);
+	}
+
+	const bool changed = signature != absorb->signature || steps.size() != absorb->steps.size();
+	if (changed && !steps.empty())
+		blog(LOG_INFO, "[%s] absorbed %zu upstream colour filters", PLUGIN_NAME, steps.size());
+	absorb->steps = std::move(steps);
+	absorb->signature = signature;
+	return changed;
+}
+
+static void apply_color_correction(const absorb_step &step, float c[3])
+{
+	float v[3];
+	for (int i = 0; i < 3; i++)
+		v[i] = std::pow(std::max(c[i], 0.0f), step.gamma);
+
+	// 矩阵之间内置滤镜不截断，只有写进 8 位的渲染目标时才截断
+	for (int i = 0; i < 3; i++) {
+		const float x = v[0] * step.matrix[0][i] + v[1] * step.matrix[1][i] + v[2] * step.matrix[2][i] +
+				step.matrix[3][i];
+		c[i] = std::clamp(x, 0.0f, 1.0f);
+	}
+}
+
+static void apply_cube_lut(const absorb_step &step, float c[3])
+{
+	float graded[3];
+	film_look_stock_sample(step.lut->table, step.lut->size, c, graded);
+	for (int i = 0; i < 3; i++)
+		c[i] = std::clamp(c[i] + (graded[i] - c[i]) * step.amount, 0.0f, 1.0f);
+}
+
+void film_look_absorb_bake(const struct film_look_absorb *absorb, uint32_t size, float *out)
+{
+	const float scale = 1.0f / (float)(size - 1);
+
+	for (uint32_t b = 0; b < size; b++) {
+		for (uint32_t g = 0; g < size; g++) {
+			for (uint32_t r = 0; r < size; r++) {
+				float *c = out + (((size_t)b * size + g) * size + r) * 3;
+				c[0] = (float)r * scale;
+				c[1] = (float)g * scale;
+				c[2] = (float)b * scale;
+
+				for (const absorb_step &step : absorb->steps) {
+					if (step.op == ABSORB_COLOR_CORRECTION)
+						apply_color_correction(step, c);
+					else
+						apply_cube_lut(step, c);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <obs-module.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 吸收紧挨在胶片外观滤镜前面的逐像素调色滤镜（内置的“色彩校正”和 .cube 的“应用 LUT”）：
+// 把它们的运算烘焙进一个 3D LUT 在主 shader 里采样，并在运行时关掉这些滤镜，
+// 省掉它们各自的整帧渲染。被关掉的滤镜在私有设置里做了标记，关闭吸收或者
+// 滤镜链变化时重新打开。用户把被关掉的滤镜重新打开时不再吸收它。
+struct film_look_absorb;
+
+struct film_look_absorb *film_look_absorb_create(void);
+// 同时恢复所有被吸收的滤镜
+void film_look_absorb_destroy(struct film_look_absorb *absorb);
+
+// 重新检查 filter 前面的滤镜链，吸收新的、恢复不再相邻或不再支持的。
+// 吸收的运算变化时返回 true。
+bool film_look_absorb_scan(struct film_look_absorb *absorb, obs_source_t *filter);
+
+// 恢复所有被吸收的滤镜，清掉用户拒绝吸收的标记
+void film_look_absorb_restore(struct film_look_absorb *absorb);
+
+// 不经过滤镜链，直接按滤镜 id 和设置追加一步运算。不支持时返回 false，测试用
+bool film_look_absorb_append(struct film_look_absorb *absorb, const char *id, obs_data_t *settings);
+
+size_t film_look_absorb_count(const struct film_look_absorb *absorb);
+
+// 按应用顺序在 size^3 的格点上计算吸收的运算，布局和 film_look_lut_bake 相同
+void film_look_absorb_bake(const struct film_look_absorb *absorb, uint32_t size, float *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,609 @@
+#include "film-look-api.h"
+
+#include "film-look-cpu.h"
+#include "film-look-params.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// 每个线程对每个外观独占一个 CPU 内核，加上一对浮点缓冲和共用的中间结果，跨批复用
+struct flc_worker {
+	std::vector<struct film_look_cpu *> cpus;
+	struct film_look_cpu_shared *shared = nullptr;
+	std::vector<float> in;
+	std::vector<float> out;
+};
+
+// 常驻线程池：flc_create 时创建，flc_destroy 时回收，每批只唤醒一次而不是重新建线程。
+// 调用线程自己是第 0 个参与者，pool 里的线程依次是 1、2……
+struct flc_pool {
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start;
+	std::condition_variable done;
+	uint64_t generation = 0;
+	bool quit = false;
+
+	// 当前任务：前 participants 个参与者从 next 里抢 task_count 个任务
+	const std::function<void(uint32_t, uint32_t)> *task = nullptr;
+	uint32_t task_count = 0;
+	uint32_t participants = 0;
+	uint32_t busy = 0;
+	std::atomic<uint32_t> next{0};
+};
+
+struct flc_context {
+	std::vector<struct film_look_params> looks;
+	std::vector<flc_worker> workers;
+	uint32_t max_threads = 0;
+	flc_pool pool;
+
+	// 按行分段处理单帧时所有线程共用的浮点缓冲
+	std::vector<float> frame_in;
+	std::vector<float> frame_out;
+};
+
+// 单帧按行分段时每段至少这么多行，太窄时光晕边框的重复计算会超过并行带来的收益
+#define FLC_MIN_BAND_ROWS 32
+
+static inline float half_to_float(uint16_t h)
+{
+	const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	const uint32_t exp = (h >> 10) & 0x1f;
+	const uint32_t mant = h & 0x3ff;
+	uint32_t bits;
+
+	if (exp == 0) {
+		float f = std::ldexp((float)mant, -24);
+		return sign ? -f : f;
+	} else if (exp == 31) {
+		bits = sign | 0x7f800000 | (mant << 13);
+	} else {
+		bits = sign | ((exp + 112) << 23) | (mant << 13);
+	}
+
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+// 输出已经被 clamp 到 0~1，这里只需要处理正规数和下溢
+static inline uint16_t float_to_half(float f)
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+
+	const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	const int exp = (int)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mant = bits & 0x7fffff;
+
+	if (exp <= 0) {
+		if (exp < -10)
+			return sign;
+		mant |= 0x800000;
+		const int shift = 14 - exp;
+		return (uint16_t)(sign | ((mant + (1u << (shift - 1))) >> shift));
+	}
+	if (exp >= 31)
+		return (uint16_t)(sign | 0x7c00);
+
+	return (uint16_t)((sign | (exp << 10) | (mant >> 13)) + ((mant >> 12) & 1));
+}
+
+struct yuv_coeffs {
+	float kr, kg, kb;
+	float y_offset, y_scale;
+	float c_scale;
+};
+
+static yuv_coeffs get_yuv_coeffs(uint32_t flags)
+{
+	yuv_coeffs c;
+	c.kr = (flags & FLC_FRAME_BT601) ? 0.299f : 0.2126f;
+	c.kb = (flags & FLC_FRAME_BT601) ? 0.114f : 0.0722f;
+	c.kg = 1.0f - c.kr - c.kb;
+
+	if (flags & FLC_FRAME_FULL_RANGE) {
+		c.y_offset = 0.0f;
+		c.y_scale = 255.0f;
+		c.c_scale = 255.0f;
+	} else {
+		c.y_offset = 16.0f;
+		c.y_scale = 219.0f;
+		c.c_scale = 224.0f;
+	}
+	return c;
+}
+
+// 转换 [y0, y1) 行
+static void unpack_rows(const flc_frame *f, struct film_look_image *dst, uint32_t y0, uint32_t y1)
+{
+	const uint32_t w = f->width;
+
+	if (f->format == FLC_FORMAT_RGBA8) {
+		for (uint32_t y = y0; y < y1; y++) {
+			const uint8_t *s = static_cast<const uint8_t *>(f->planes[0]) + (size_t)y * f->strides[0];
+			float *d = dst->data + (size_t)y * dst->stride;
+			for (uint32_t i = 0; i < w * 4; i++)
+				d[i] = (float)s[i] * (1.0f / 255.0f);
+		}
+	} else if (f->format == FLC_FORMAT_RGBA16F) {
+		for (uint32_t y = y0; y < y1; y++) {
+			const auto *s = reinterpret_cast<const uint16_t *>(static_cast<const uint8_t *>(f->planes[0]) +
+									 (size_t)y * f->strides[0]);
+			float *d = dst->data + (size_t)y * dst->stride;
+			for (uint32_t i = 0; i < w * 4; i++)
+				d[i] = half_to_float(s[i]);
+		}
+	} else {
+		const yuv_coeffs c = get_yuv_coeffs(f->flags);
+		for (uint32_t y = y0; y < y1; y++) {
+			const uint8_t *ys = static_cast<const uint8_t *>(f->planes[0]) + (size_t)y * f->strides[0];
+			const uint8_t *uv = static_cast<const uint8_t *>(f->planes[1]) + (size_t)(y / 2) * f->strides[1];
+			float *d = dst->data + (size_t)y * dst->stride;
+
+			for (uint32_t x = 0; x < w; x++) {
+				const float luma = ((float)ys[x] - c.y_offset) / c.y_scale;
+				const float cb = ((float)uv[(x / 2) * 2 + 0] - 128.0f) / c.c_scale;
+				const float cr = ((float)uv[(x / 2) * 2 + 1] - 128.0f) / c.c_scale;
+				const float r = luma + 2.0f * (1.0f - c.kr) * cr;
+				const float b = luma + 2.0f * (1.0f - c.kb) * cb;
+				const float g = (luma - c.kr * r - c.kb * b) / c.kg;
+
+				d[x * 4 + 0] = std::clamp(r, 0.0f, 1.0f);
+				d[x * 4 + 1] = std::clamp(g, 0.0f, 1.0f);
+				d[x * 4 + 2] = std::clamp(b, 0.0f, 1.0f);
+				d[x * 4 + 3] = 1.0f;
+			}
+		}
+	}
+}
+
+// 转换 [y0, y1) 行；NV12 的色度按 2x2 块计算，y0 必须是偶数，y1 是偶数或者帧高
+static void pack_rows(const struct film_look_image *src, const flc_frame *f, uint32_t y0, uint32_t y1)
+{
+	const uint32_t w = f->width;
+	const uint32_t h = f->height;
+
+	if (y0 >= y1)
+		return;
+
+	if (f->format == FLC_FORMAT_RGBA8) {
+		for (uint32_t y = y0; y < y1; y++) {
+			const float *s = src->data + (size_t)y * src->stride;
+			uint8_t *d = static_cast<uint8_t *>(f->planes[0]) + (size_t)y * f->strides[0];
+			for (uint32_t i = 0; i < w * 4; i++)
+				d[i] = (uint8_t)(s[i] * 255.0f + 0.5f);
+		}
+	} else if (f->format == FLC_FORMAT_RGBA16F) {
+		for (uint32_t y = y0; y < y1; y++) {
+			const float *s = src->data + (size_t)y * src->stride;
+			auto *d = reinterpret_cast<uint16_t *>(static_cast<uint8_t *>(f->planes[0]) +
+							       (size_t)y * f->strides[0]);
+			for (uint32_t i = 0; i < w * 4; i++)
+				d[i] = float_to_half(s[i]);
+		}
+	} else {
+		const yuv_coeffs c = get_yuv_coeffs(f->flags);
+
+		for (uint32_t y = y0; y < y1; y++) {
+			const float *s = src->data + (size_t)y * src->stride;
+			uint8_t *d = static_cast<uint8_t *>(f->planes[0]) + (size_t)y * f->strides[0];
+			for (uint32_t x = 0; x < w; x++) {
+				const float luma = c.kr * s[x * 4 + 0] + c.kg * s[x * 4 + 1] + c.kb * s[x * 4 + 2];
+				d[x] = (uint8_t)std::clamp(c.y_offset + luma * c.y_scale + 0.5f, 0.0f, 255.0f);
+			}
+		}
+
+		// 色度取 2x2 块的平均值
+		for (uint32_t cy = y0 / 2; cy < (y1 + 1) / 2; cy++) {
+			uint8_t *d = static_cast<uint8_t *>(f->planes[1]) + (size_t)cy * f->strides[1];
+			for (uint32_t cx = 0; cx < (w + 1) / 2; cx++) {
+				float rgb[3] = {0.0f, 0.0f, 0.0f};
+				float n = 0.0f;
+				for (uint32_t y = cy * 2; y < std::min(cy * 2 + 2, h); y++) {
+					for (uint32_t x = cx * 2; x < std::min(cx * 2 + 2, w); x++) {
+						const float *p = src->data + (size_t)y * src->stride + x * 4;
+						rgb[0] += p[0];
+						rgb[1] += p[1];
+						rgb[2] += p[2];
+						n += 1.0f;
+					}
+				}
+
+				const float r = rgb[0] / n;
+				const float g = rgb[1] / n;
+				const float b = rgb[2] / n;
+				const float luma = c.kr * r + c.kg * g + c.kb * b;
+				const float cb = (b - luma) / (2.0f * (1.0f - c.kb));
+				const float cr = (r - luma) / (2.0f * (1.0f - c.kr));
+				d[cx * 2 + 0] = (uint8_t)std::clamp(128.0f + cb * c.c_scale + 0.5f, 0.0f, 255.0f);
+				d[cx * 2 + 1] = (uint8_t)std::clamp(128.0f + cr * c.c_scale + 0.5f, 0.0f, 255.0f);
+			}
+		}
+	}
+}
+
+// 调用方可能用更新版本的头文件编译（struct_size 更大），所以按 struct_size 步进
+static inline const flc_frame *frame_at(const flc_frame *frames, uint32_t i)
+{
+	return reinterpret_cast<const flc_frame *>(reinterpret_cast<const uint8_t *>(frames) +
+						   (size_t)i * frames->struct_size);
+}
+
+static int validate_frame(const flc_frame *f)
+{
+	if (f->struct_size < sizeof(flc_frame) || !f->width || !f->height || !f->planes[0])
+		return FLC_ERROR_INVALID_ARGUMENT;
+
+	// 行字节数用 64 位算，width 接近 2^32 时 uint32 的乘法会回绕成一个很小的值
+	const uint64_t width = f->width;
+	switch (f->format) {
+	case FLC_FORMAT_RGBA8:
+		return f->strides[0] >= width * 4 ? FLC_OK : FLC_ERROR_INVALID_ARGUMENT;
+	case FLC_FORMAT_RGBA16F:
+		return f->strides[0] >= width * 8 ? FLC_OK : FLC_ERROR_INVALID_ARGUMENT;
+	case FLC_FORMAT_NV12:
+		return f->planes[1] && f->strides[0] >= width && f->strides[1] >= (width + 1) / 2 * 2
+			       ? FLC_OK
+			       : FLC_ERROR_INVALID_ARGUMENT;
+	default:
+		return FLC_ERROR_UNSUPPORTED_FORMAT;
+	}
+}
+
+// 用 worker 自己的内核渲染 [y0, y1) 行并写到每个外观的输出里。
+// outputs 指向这一帧在第 0 个外观里的输出，look_stride 是相邻两个外观之间隔的帧数
+static void render_rows(flc_worker &worker, const struct film_look_image *src, struct film_look_image *dst,
+			double time, const flc_frame *outputs, uint32_t look_stride, uint32_t y0, uint32_t y1)
+{
+	if (worker.cpus.size() == 1) {
+		film_look_cpu_render_rows(worker.cpus[0], src, dst, (float)time, y0, y1);
+		pack_rows(dst, outputs, y0, y1);
+		return;
+	}
+
+	int padding = 0;
+	for (struct film_look_cpu *cpu : worker.cpus)
+		padding = std::max(padding, film_look_cpu_padding(cpu));
+
+	film_look_cpu_shared_begin_rows(worker.shared, src, padding, y0, y1);
+	for (uint32_t l = 0; l < (uint32_t)worker.cpus.size(); l++) {
+		film_look_cpu_render_shared(worker.cpus[l], worker.shared, dst, (float)time);
+		pack_rows(dst, frame_at(outputs, l * look_stride), y0, y1);
+	}
+}
+
+// 整帧交给一个线程
+static void process_frame(flc_worker &worker, const flc_frame *in, const flc_frame *outputs, uint32_t look_stride)
+{
+	const size_t floats = (size_t)in->width * in->height * 4;
+	worker.in.resize(floats);
+	worker.out.resize(floats);
+
+	struct film_look_image src = {worker.in.data(), in->width, in->height, (size_t)in->width * 4};
+	struct film_look_image dst = {worker.out.data(), in->width, in->height, (size_t)in->width * 4};
+
+	unpack_rows(in, &src, 0, in->height);
+	render_rows(worker, &src, &dst, in->time, outputs, look_stride, 0, in->height);
+}
+
+static void ensure_workers(flc_context *context, size_t count)
+{
+	while (context->workers.size() < count) {
+		context->workers.emplace_back();
+		flc_worker &worker = context->workers.back();
+		for (const struct film_look_params &params : context->looks) {
+			worker.cpus.push_back(film_look_cpu_create());
+			film_look_cpu_update(worker.cpus.back(), &params);
+		}
+		if (context->looks.size() > 1)
+			worker.shared = film_look_cpu_shared_create();
+	}
+}
+
+static void pool_thread(flc_pool *pool, uint32_t index)
+{
+	uint64_t seen = 0;
+	std::unique_lock<std::mutex> lock(pool->mutex);
+
+	for (;;) {
+		pool->start.wait(lock, [&] { return pool->quit || pool->generation != seen; });
+		if (pool->quit)
+			return;
+		seen = pool->generation;
+
+		if (index < pool->participants) {
+			const std::function<void(uint32_t, uint32_t)> &task = *pool->task;
+			const uint32_t count = pool->task_count;
+			lock.unlock();
+			for (uint32_t i = pool->next++; i < count; i = pool->next++)
+				task(index, i);
+			lock.lock();
+
+			if (--pool->busy == 0)
+				pool->done.notify_one();
+		}
+	}
+}
+
+static void pool_stop(flc_pool *pool)
+{
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->quit = true;
+	}
+	pool->start.notify_all();
+	for (std::thread &thread : pool->threads)
+		thread.join();
+	pool->threads.clear();
+	pool->quit = false;
+}
+
+// 线程创建失败时就用已经建好的线程，调用线程总能兜底
+static void pool_start(flc_pool *pool, uint32_t threads)
+{
+	for (uint32_t t = 1; t < threads; t++) {
+		try {
+			pool->threads.emplace_back(pool_thread, pool, t);
+		} catch (const std::exception &) {
+			break;
+		}
+	}
+}
+
+// 把 task(participant, i) (i = 0 … count - 1) 分给调用线程和前 participants - 1 个池线程，全部完成后返回
+static void pool_run(flc_pool *pool, uint32_t participants, uint32_t count,
+		     const std::function<void(uint32_t, uint32_t)> &task)
+{
+	participants = std::min(participants, (uint32_t)pool->threads.size() + 1);
+	pool->next = 0;
+
+	if (participants > 1) {
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->task = &task;
+		pool->task_count = count;
+		pool->participants = participants;
+		pool->busy = participants - 1;
+		pool->generation++;
+	}
+	if (participants > 1)
+		pool->start.notify_all();
+
+	for (uint32_t i = pool->next++; i < count; i = pool->next++)
+		task(0, i);
+
+	if (participants > 1) {
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		pool->done.wait(lock, [&] { return pool->busy == 0; });
+		pool->task = nullptr;
+	}
+}
+
+static uint32_t thread_limit(const flc_context *context)
+{
+	const uint32_t threads = context->max_threads ? context->max_threads : std::thread::hardware_concurrency();
+	return std::max(threads, 1u);
+}
+
+uint32_t flc_get_version(void)
+{
+	return FLC_API_VERSION;
+}
+
+const char *flc_status_string(int status)
+{
+	switch (status) {
+	case FLC_OK:
+		return "ok";
+	case FLC_ERROR_INVALID_ARGUMENT:
+		return "invalid argument";
+	case FLC_ERROR_UNSUPPORTED_FORMAT:
+		return "unsupported pixel format";
+	case FLC_ERROR_SETTINGS:
+		return "malformed settings json";
+	case FLC_ERROR_VERSION:
+		return "incompatible api version";
+	case FLC_ERROR_OUT_OF_MEMORY:
+		return "out of memory";
+	default:
+		return "unknown error";
+	}
+}
+
+int flc_create(uint32_t api_version, const char *settings_json, flc_context **out_context)
+{
+	return flc_create_looks(api_version, &settings_json, 1, out_context);
+}
+
+int flc_create_looks(uint32_t api_version, const char *const *settings_json, uint32_t look_count,
+		     flc_context **out_context)
+{
+	if (!out_context || !look_count)
+		return FLC_ERROR_INVALID_ARGUMENT;
+	*out_context = nullptr;
+
+	if ((api_version >> 16) != FLC_API_VERSION_MAJOR || (api_version & 0xffff) > FLC_API_VERSION_MINOR)
+		return FLC_ERROR_VERSION;
+
+	auto *context = new (std::nothrow) flc_context();
+	if (!context)
+		return FLC_ERROR_OUT_OF_MEMORY;
+
+	try {
+		context->looks.resize(look_count);
+	} catch (const std::bad_alloc &) {
+		delete context;
+		return FLC_ERROR_OUT_OF_MEMORY;
+	}
+
+	for (uint32_t l = 0; l < look_count; l++) {
+		if (!film_look_params_load_json(&context->looks[l], settings_json ? settings_json[l] : nullptr)) {
+			delete context;
+			return FLC_ERROR_SETTINGS;
+		}
+	}
+
+	pool_start(&context->pool, thread_limit(context));
+	*out_context = context;
+	return FLC_OK;
+}
+
+uint32_t flc_get_look_count(const flc_context *context)
+{
+	return context ? (uint32_t)context->looks.size() : 0;
+}
+
+int flc_update(flc_context *context, const char *settings_json)
+{
+	return flc_update_look(context, 0, settings_json);
+}
+
+int flc_update_look(flc_context *context, uint32_t look, const char *settings_json)
+{
+	if (!context || look >= context->looks.size())
+		return FLC_ERROR_INVALID_ARGUMENT;
+	if (!film_look_params_load_json(&context->looks[look], settings_json))
+		return FLC_ERROR_SETTINGS;
+
+	for (flc_worker &worker : context->workers)
+		film_look_cpu_update(worker.cpus[look], &context->looks[look]);
+	return FLC_OK;
+}
+
+void flc_destroy(flc_context *context)
+{
+	if (!context)
+		return;
+
+	pool_stop(&context->pool);
+	for (flc_worker &worker : context->workers) {
+		for (struct film_look_cpu *cpu : worker.cpus)
+			film_look_cpu_destroy(cpu);
+		film_look_cpu_shared_destroy(worker.shared);
+	}
+	delete context;
+}
+
+int flc_set_thread_count(flc_context *context, uint32_t threads)
+{
+	if (!context)
+		return FLC_ERROR_INVALID_ARGUMENT;
+
+	// 同一个上下文不会被并发调用，这时池里没有正在执行的任务，可以直接按新的上限重建
+	if (threads != context->max_threads) {
+		context->max_threads = threads;
+		pool_stop(&context->pool);
+		pool_start(&context->pool, thread_limit(context));
+	}
+	return FLC_OK;
+}
+
+int flc_process_batch(flc_context *context, const flc_frame *inputs, const flc_frame *outputs, uint32_t count)
+{
+	if (!context || (count && (!inputs || !outputs)))
+		return FLC_ERROR_INVALID_ARGUMENT;
+	if (!count)
+		return FLC_OK;
+
+	// 先检查整批，开始处理之后就不会再失败
+	const uint32_t look_count = (uint32_t)context->looks.size();
+	for (uint32_t i = 0; i < count; i++) {
+		const flc_frame *in = frame_at(inputs, i);
+		int status = validate_frame(in);
+		if (status != FLC_OK)
+			return status;
+
+		for (uint32_t l = 0; l < look_count; l++) {
+			const flc_frame *out = frame_at(outputs, l * count + i);
+			status = validate_frame(out);
+			if (status != FLC_OK)
+				return status;
+			if (in->width != out->width || in->height != out->height)
+				return FLC_ERROR_INVALID_ARGUMENT;
+		}
+	}
+
+	const uint32_t threads = std::min(thread_limit(context), (uint32_t)context->pool.threads.size() + 1);
+
+	try {
+		ensure_workers(context, threads);
+	} catch (const std::bad_alloc &) {
+		return FLC_ERROR_OUT_OF_MEMORY;
+	}
+
+	std::atomic<bool> failed{false};
+
+	// 帧数不少于线程数时每个线程处理整帧，不需要任何同步
+	if (count >= threads || threads == 1) {
+		const std::function<void(uint32_t, uint32_t)> task = [&](uint32_t t, uint32_t i) {
+			if (failed)
+				return;
+			try {
+				process_frame(context->workers[t], frame_at(inputs, i), frame_at(outputs, i), count);
+			} catch (const std::bad_alloc &) {
+				failed = true;
+			}
+		};
+		pool_run(&context->pool, threads, count, task);
+		return failed ? FLC_ERROR_OUT_OF_MEMORY : FLC_OK;
+	}
+
+	// 帧数少于线程数（典型的是逐帧调用）：一帧一帧处理，每帧按行分段给所有线程。
+	// 先整帧解码到共用的缓冲（光晕和抖动会读到段外的行），再各段独立渲染和输出。
+	for (uint32_t i = 0; i < count && !failed; i++) {
+		const flc_frame *in = frame_at(inputs, i);
+		const flc_frame *out = frame_at(outputs, i);
+		const size_t floats = (size_t)in->width * in->height * 4;
+
+		try {
+			context->frame_in.resize(floats);
+			context->frame_out.resize(floats);
+		} catch (const std::bad_alloc &) {
+			return FLC_ERROR_OUT_OF_MEMORY;
+		}
+
+		struct film_look_image src = {context->frame_in.data(), in->width, in->height, (size_t)in->width * 4};
+		struct film_look_image dst = {context->frame_out.data(), in->width, in->height, (size_t)in->width * 4};
+
+		// 段高取偶数，NV12 的 2x2 色度块不会跨段
+		const uint32_t bands = std::clamp(in->height / FLC_MIN_BAND_ROWS, 1u, threads);
+		const uint32_t band_rows = ((in->height + bands - 1) / bands + 1) & ~1u;
+		auto band = [&](uint32_t b, uint32_t *y0, uint32_t *y1) {
+			*y0 = std::min(b * band_rows, in->height);
+			*y1 = std::min(*y0 + band_rows, in->height);
+		};
+
+		const std::function<void(uint32_t, uint32_t)> unpack = [&](uint32_t, uint32_t b) {
+			uint32_t y0, y1;
+			band(b, &y0, &y1);
+			unpack_rows(in, &src, y0, y1);
+		};
+		pool_run(&context->pool, threads, bands, unpack);
+
+		const std::function<void(uint32_t, uint32_t)> render = [&](uint32_t t, uint32_t b) {
+			if (failed)
+				return;
+			uint32_t y0, y1;
+			band(b, &y0, &y1);
+			try {
+				render_rows(context->workers[t], &src, &dst, in->time, out, count, y0, y1);
+			} catch (const std::bad_alloc &) {
+				failed = true;
+			}
+		};
+		pool_run(&context->pool, threads, bands, render);
+	}
+
+	if (failed)
+		return FLC_ERROR_OUT_OF_MEMORY;
+	return FLC_OK;
+}
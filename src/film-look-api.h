@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ * libfilm-look：不依赖 OBS 场景/渲染的嵌入式接口，供 ffmpeg 滤镜、GStreamer 元素、
+ * Python (ctypes/cffi) 等封装使用。
+ *
+ * ABI 约定：
+ *   - 上下文是不透明指针，所有结构体以 struct_size 开头，新字段只会追加在末尾；
+ *   - FLC_API_VERSION 的主版本变化才会破坏兼容，flc_create 会拒绝不兼容的版本；
+ *   - 设置使用与 OBS 滤镜相同键名的 JSON，缺省的键取滤镜默认值。
+ *
+ * 同一个上下文不能同时从多个线程调用；不同上下文之间互不影响。
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#if defined(FLC_BUILDING)
+#define FLC_API __declspec(dllexport)
+#else
+#define FLC_API __declspec(dllimport)
+#endif
+#else
+#define FLC_API __attribute__((visibility("default")))
+#endif
+
+#define FLC_API_VERSION_MAJOR 1
+#define FLC_API_VERSION_MINOR 1
+#define FLC_API_VERSION ((FLC_API_VERSION_MAJOR << 16) | FLC_API_VERSION_MINOR)
+
+typedef struct flc_context flc_context;
+
+enum flc_status {
+	FLC_OK = 0,
+	FLC_ERROR_INVALID_ARGUMENT = -1,
+	FLC_ERROR_UNSUPPORTED_FORMAT = -2,
+	FLC_ERROR_SETTINGS = -3,
+	FLC_ERROR_VERSION = -4,
+	FLC_ERROR_OUT_OF_MEMORY = -5,
+};
+
+enum flc_pixel_format {
+	FLC_FORMAT_RGBA8 = 1,   /* planes[0]，每像素 4 字节 */
+	FLC_FORMAT_RGBA16F = 2, /* planes[0]，每像素 4 个半精度浮点 */
+	FLC_FORMAT_NV12 = 3,    /* planes[0] 为 Y，planes[1] 为交错的 UV（宽高各减半） */
+};
+
+enum flc_frame_flags {
+	FLC_FRAME_FULL_RANGE = 1 << 0, /* NV12 使用全范围 (0-255)，默认限定范围 (16-235) */
+	FLC_FRAME_BT601 = 1 << 1,      /* NV12 使用 BT.601 矩阵，默认 BT.709 */
+};
+
+typedef struct flc_frame {
+	uint32_t struct_size; /* sizeof(flc_frame) */
+	uint32_t format;      /* enum flc_pixel_format */
+	uint32_t flags;       /* enum flc_frame_flags */
+	uint32_t width;
+	uint32_t height;
+	uint32_t strides[2]; /* 每个平面每行的字节数 */
+	void *planes[2];
+	double time; /* 秒，决定颗粒和抖动的相位；输出帧忽略此字段 */
+} flc_frame;
+
+/* 返回库实际实现的 FLC_API_VERSION */
+FLC_API uint32_t flc_get_version(void);
+FLC_API const char *flc_status_string(int status);
+
+/* api_version 传 FLC_API_VERSION；settings_json 可以为 NULL（全部取默认值） */
+FLC_API int flc_create(uint32_t api_version, const char *settings_json, flc_context **out_context);
+FLC_API int flc_update(flc_context *context, const char *settings_json);
+FLC_API void flc_destroy(flc_context *context);
+
+/* (1.1) 多外观上下文：同一路输入按 look_count 组设置各输出一路。每帧的解码、颜色转换、
+ * 补边和亮度计算只做一次，各外观只做调色、光晕和输出转换。
+ * settings_json 可以为 NULL，单个元素为 NULL 时该外观取默认值。flc_create 等价于 look_count 为 1。 */
+FLC_API int flc_create_looks(uint32_t api_version, const char *const *settings_json, uint32_t look_count,
+			     flc_context **out_context);
+FLC_API uint32_t flc_get_look_count(const flc_context *context);
+/* flc_update 更新的是第 0 个外观 */
+FLC_API int flc_update_look(flc_context *context, uint32_t look, const char *settings_json);
+
+/* 处理 count 帧。单外观时 inputs[i] -> outputs[i]；多外观时 outputs 有 look_count * count 个，
+ * 按外观分组，第 l 个外观的第 i 帧是 outputs[l * count + i]。
+ * 输入输出可以是不同格式；单外观时也可以是同一块内存，多外观时输出不能和输入重叠。
+ * 帧数不少于线程数时每个线程处理整帧；帧数较少（包括 count 为 1）时逐帧按行分段给所有线程。
+ * 线程在 flc_create 时创建、flc_destroy 时回收，临时缓冲跨批复用。 */
+FLC_API int flc_process_batch(flc_context *context, const flc_frame *inputs, const flc_frame *outputs,
+			      uint32_t count);
+
+/* 最多使用多少个线程处理一批帧，0 表示按 CPU 核数。改变上限会重建线程池 */
+FLC_API int flc_set_thread_count(flc_context *context, uint32_t threads);
+
+#ifdef __cplusplus
+}
+#endif
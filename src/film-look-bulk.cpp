@@ -0,0 +1,133 @@
+#include "film-look-bulk.h"
+#include "film-look-filter.h"
+#include "film-look-params.h"
+
+#include "plugin-support.h"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <vector>
+
+struct bulk_look {
+	struct film_look_params params;
+	std::vector<obs_source_t *> filters; // 持有引用，任务执行完放开
+};
+
+static void collect_filter(obs_source_t *parent, obs_source_t *child, void *param)
+{
+	UNUSED_PARAMETER(parent);
+	if (film_look_filter_is_instance(child))
+		static_cast<bulk_look *>(param)->filters.push_back(obs_source_get_ref(child));
+}
+
+static bool collect_source(void *param, obs_source_t *source)
+{
+	obs_source_enum_filters(source, collect_filter, param);
+	return true;
+}
+
+// 场景和分组不在 obs_enum_sources 里，要单独枚举
+static void collect_all(bulk_look *look)
+{
+	obs_enum_sources(collect_source, look);
+	obs_enum_scenes(collect_source, look);
+}
+
+// 同一个滤镜列了两次的条目跳过，applied 只数一次
+static void collect_targets(bulk_look *look, obs_data_t *targets)
+{
+	obs_data_array_t *filters = obs_data_get_array(targets, "filters");
+	const size_t count = obs_data_array_count(filters);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(filters, i);
+		const char *source_name = obs_data_get_string(item, "source");
+		const char *filter_name = obs_data_get_string(item, "filter");
+
+		obs_source_t *source = obs_get_source_by_name(source_name);
+		obs_source_t *filter = source ? obs_source_get_filter_by_name(source, filter_name) : nullptr;
+		const auto &collected = look->filters;
+		const bool listed = std::find(collected.begin(), collected.end(), filter) != collected.end();
+		if (filter && film_look_filter_is_instance(filter) && !listed) {
+			look->filters.push_back(filter);
+		} else if (filter) {
+			if (listed)
+				blog(LOG_WARNING, "[%s] bulk look: filter '%s' on '%s' listed twice", PLUGIN_NAME,
+				     filter_name, source_name);
+			obs_source_release(filter);
+		} else {
+			blog(LOG_WARNING, "[%s] bulk look: no filter '%s' on '%s'", PLUGIN_NAME, filter_name,
+			     source_name);
+		}
+
+		obs_source_release(source);
+		obs_data_release(item);
+	}
+
+	obs_data_array_release(filters);
+}
+
+// 在图形线程的帧间隙执行：所有目标在同一帧之前换上新参数
+static void publish_look(void *param)
+{
+	auto *look = static_cast<bulk_look *>(param);
+
+	for (obs_source_t *filter : look->filters) {
+		if (filter)
+			film_look_filter_publish(filter, &look->params);
+		obs_source_release(filter);
+	}
+	delete look;
+}
+
+static void apply_look(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(data);
+	const char *settings_json = calldata_string(cd, "settings");
+	const char *targets_json = calldata_string(cd, "targets");
+	calldata_set_int(cd, "applied", 0);
+
+	// 和属性窗口、帧服务器同一个加载函数，半径和预设已经限制到属性的范围
+	auto *look = new bulk_look();
+	if (!film_look_params_load_json(&look->params, settings_json)) {
+		blog(LOG_WARNING, "[%s] bulk look: invalid settings JSON", PLUGIN_NAME);
+		delete look;
+		return;
+	}
+
+	if (targets_json && *targets_json) {
+		obs_data_t *targets = obs_data_create_from_json(targets_json);
+		if (!targets) {
+			blog(LOG_WARNING, "[%s] bulk look: invalid targets JSON", PLUGIN_NAME);
+			delete look;
+			return;
+		}
+		collect_targets(look, targets);
+		obs_data_release(targets);
+	} else {
+		collect_all(look);
+	}
+
+	// 设置里也写一份，保存场景集合和打开属性窗口时看到的是新外观。
+	// obs_data_apply 不会触发 update，参数由下面的图形任务统一换上。
+	obs_data_t *explicit_settings = obs_data_create();
+	film_look_params_save(&look->params, explicit_settings);
+	for (obs_source_t *filter : look->filters) {
+		obs_data_t *settings = obs_source_get_settings(filter);
+		obs_data_apply(settings, explicit_settings);
+		obs_data_release(settings);
+	}
+	obs_data_release(explicit_settings);
+
+	const long long applied = (long long)look->filters.size();
+	obs_queue_task(OBS_TASK_GRAPHICS, publish_look, look, false);
+	calldata_set_int(cd, "applied", applied);
+}
+
+void film_look_bulk_init(void)
+{
+	proc_handler_t *handler = obs_get_proc_handler();
+	proc_handler_add(handler, "void film_look_apply_look(in string settings, in string targets, out int applied)",
+			 apply_look, nullptr);
+}
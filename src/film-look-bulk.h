@@ -0,0 +1,19 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 在全局 proc handler 上注册批量应用外观的调用：
+//
+//   void film_look_apply_look(in string settings, in string targets, out int applied)
+//
+// settings 是外观的 JSON（键名和滤镜设置相同，没给出的参数取默认值，非外观的设置项忽略）。
+// targets 为空时应用到所有胶片外观滤镜，否则是
+//   {"filters": [{"source": "<源名称>", "filter": "<滤镜名称>"}, ...]}
+// 设置只解析一次，各实例在同一个图形任务里换上新参数，下一帧同时生效。
+void film_look_bulk_init(void);
+
+#ifdef __cplusplus
+}
+#endif
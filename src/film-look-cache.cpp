@@ -0,0 +1,181 @@
+#include "film-look-cache.h"
+#include "film-look-mmap.h"
+
+#include "plugin-support.h"
+
+#include <obs-module.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+
+#define CACHE_MAGIC 0x43434c46 // "FLCC"
+#define CACHE_FORMAT_VERSION 1
+#define CACHE_SUFFIX ".flcache"
+
+// payload 从 64 字节对齐的位置开始，映射后可以直接当纹理数据用
+struct cache_header {
+	uint32_t magic;
+	uint32_t format_version;
+	uint64_t plugin_version; // PLUGIN_VERSION 字符串的 hash
+	uint64_t key;
+	uint64_t payload_size;
+	uint8_t reserved[32];
+};
+
+static_assert(sizeof(struct cache_header) == 64, "cache header must keep the payload 64-byte aligned");
+
+struct film_look_cache_entry {
+	struct film_look_mapped_file *file;
+	const uint8_t *base;
+	size_t size;
+};
+
+uint64_t film_look_cache_hash(const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	uint64_t hash = 0xcbf29ce484222325ull ^ seed;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static uint64_t plugin_version_hash(void)
+{
+	return film_look_cache_hash(PLUGIN_VERSION, strlen(PLUGIN_VERSION), 0);
+}
+
+static void cache_file_path(struct dstr *path, const char *kind, uint64_t key)
+{
+	char *dir = obs_module_config_path("cache");
+	dstr_printf(path, "%s/%s-%016llx" CACHE_SUFFIX, dir, kind, (unsigned long long)key);
+	bfree(dir);
+}
+
+static bool header_valid(const struct cache_header *header, uint64_t key, size_t file_size)
+{
+	return header->magic == CACHE_MAGIC && header->format_version == CACHE_FORMAT_VERSION &&
+	       header->plugin_version == plugin_version_hash() && header->key == key &&
+	       header->payload_size == file_size - sizeof(struct cache_header);
+}
+
+struct film_look_cache_entry *film_look_cache_open(const char *kind, uint64_t key)
+{
+	struct dstr path = {0};
+	cache_file_path(&path, kind, key);
+	struct film_look_mapped_file *file = film_look_mapped_file_open(path.array);
+	dstr_free(&path);
+
+	if (!file)
+		return nullptr;
+
+	size_t size = 0;
+	auto *base = static_cast<const uint8_t *>(film_look_mapped_file_data(file, &size));
+	if (size < sizeof(struct cache_header) ||
+	    !header_valid(reinterpret_cast<const struct cache_header *>(base), key, size)) {
+		film_look_mapped_file_close(file);
+		return nullptr;
+	}
+
+	auto *entry = static_cast<struct film_look_cache_entry *>(bzalloc(sizeof(struct film_look_cache_entry)));
+	entry->file = file;
+	entry->base = base;
+	entry->size = size;
+	return entry;
+}
+
+const void *film_look_cache_data(const struct film_look_cache_entry *entry, size_t *size)
+{
+	*size = entry->size - sizeof(struct cache_header);
+	return entry->base + sizeof(struct cache_header);
+}
+
+void film_look_cache_close(struct film_look_cache_entry *entry)
+{
+	if (!entry)
+		return;
+
+	film_look_mapped_file_close(entry->file);
+	bfree(entry);
+}
+
+bool film_look_cache_store(const char *kind, uint64_t key, const void *data, size_t size)
+{
+	char *dir = obs_module_config_path("cache");
+	os_mkdirs(dir);
+	bfree(dir);
+
+	struct dstr path = {0};
+	struct dstr temp = {0};
+	cache_file_path(&path, kind, key);
+	dstr_printf(&temp, "%s.%llx.tmp", path.array, (unsigned long long)os_gettime_ns());
+
+	struct cache_header header = {};
+	header.magic = CACHE_MAGIC;
+	header.format_version = CACHE_FORMAT_VERSION;
+	header.plugin_version = plugin_version_hash();
+	header.key = key;
+	header.payload_size = size;
+
+	bool ok = false;
+	FILE *file = os_fopen(temp.array, "wb");
+	if (file) {
+		ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(data, 1, size, file) == size;
+		ok = fclose(file) == 0 && ok;
+	}
+
+	// 已经有映射的旧文件不受影响：替换的是目录项，不是文件内容
+	if (ok)
+		ok = os_safe_replace(path.array, temp.array, nullptr) == 0;
+	if (!ok) {
+		os_unlink(temp.array);
+		blog(LOG_WARNING, "[%s] failed to write cache file '%s'", PLUGIN_NAME, path.array);
+	}
+
+	dstr_free(&temp);
+	dstr_free(&path);
+	return ok;
+}
+
+void film_look_cache_prune(void)
+{
+	char *dir_path = obs_module_config_path("cache");
+	os_dir_t *dir = os_opendir(dir_path);
+	if (!dir) {
+		bfree(dir_path);
+		return;
+	}
+
+	const uint64_t version = plugin_version_hash();
+	const size_t suffix_len = strlen(CACHE_SUFFIX);
+	struct dstr path = {0};
+	int removed = 0;
+
+	struct os_dirent *ent;
+	while ((ent = os_readdir(dir)) != nullptr) {
+		size_t len = strlen(ent->d_name);
+		if (ent->directory || len <= suffix_len || strcmp(ent->d_name + len - suffix_len, CACHE_SUFFIX) != 0)
+			continue;
+
+		dstr_printf(&path, "%s/%s", dir_path, ent->d_name);
+
+		struct cache_header header = {};
+		FILE *file = os_fopen(path.array, "rb");
+		if (!file)
+			continue;
+		bool current = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CACHE_MAGIC &&
+			       header.format_version == CACHE_FORMAT_VERSION && header.plugin_version == version;
+		fclose(file);
+
+		if (!current && os_unlink(path.array) == 0)
+			removed++;
+	}
+
+	os_closedir(dir);
+	dstr_free(&path);
+	bfree(dir_path);
+
+	if (removed)
+		blog(LOG_INFO, "[%s] removed %d stale cache files", PLUGIN_NAME, removed);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 烘焙结果的磁盘缓存，放在插件配置目录的 cache/ 下。
+// 每个文件 = 带版本的文件头 + 原样的 payload（已经是纹理上传需要的格式），
+// 读取时直接映射到内存，交给 gs_*texture_create，不做解析和复制。
+struct film_look_cache_entry;
+
+// FNV-1a 64，用于把参数算成缓存 key
+uint64_t film_look_cache_hash(const void *data, size_t size, uint64_t seed);
+
+// 找到并映射缓存文件；不存在、版本不符或文件损坏时返回 NULL
+struct film_look_cache_entry *film_look_cache_open(const char *kind, uint64_t key);
+const void *film_look_cache_data(const struct film_look_cache_entry *entry, size_t *size);
+void film_look_cache_close(struct film_look_cache_entry *entry);
+
+// 写入临时文件后再替换，其他实例不会读到写了一半的文件
+bool film_look_cache_store(const char *kind, uint64_t key, const void *data, size_t size);
+
+// 删除其他插件版本或旧格式留下的缓存文件，模块加载时调用一次
+void film_look_cache_prune(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,505 @@
+#include "film-look-cpu.h"
+#include "film-look-stock.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+typedef void (*film_look_cpu_kernel_fn)(struct film_look_cpu *cpu, const struct film_look_image *src,
+					struct film_look_cpu_shared *shared, struct film_look_image *dst,
+					float elapsed_time, int y0, int y1);
+
+// 一个已启用的光晕层（强度为 0 的层在 update 时就被剔除了）
+struct cpu_glow_layer {
+	float threshold;
+	float inv_range; // 1 / (1 - threshold)
+	int radius;
+	float weight[3]; // tint * intensity / 采样数
+	bool screen;     // false: 直接相加 (bloom)，true: 滤色混合 (halation / secondary glow)
+};
+
+struct film_look_cpu {
+	struct film_look_params params;
+	uint32_t stage_mask;
+	film_look_cpu_kernel_fn kernel;
+
+	cpu_glow_layer layers[3];
+	int layer_count;
+	int max_radius;
+
+	std::vector<float> padded;   // 补零边框后的源图像 (RGBA)，只在有抖动时使用
+	std::vector<float> shifted;  // 按抖动偏移重采样、四周留出 max_radius 边框的源图像 (RGBA)，只含当前行段
+	std::vector<float> bright;   // 当前层的高光提取结果 (RGB)
+	std::vector<float> row_sums; // 水平方向盒式求和的中间结果 (RGB)
+	std::vector<float> glows[3]; // 每一层的光晕求和结果 (RGB, width * height)
+	std::vector<float> row;      // 合成时的一行 (RGB)
+
+	std::vector<float> stock_lut; // 烘焙好的胶片模拟 LUT，FILM_LOOK_STOCK_LUT_SIZE^3
+	int stock_lut_id = FILM_LOOK_STOCK_NONE;
+};
+
+// 按某个抖动偏移重采样、补好边框的源图像和它的亮度，抖动偏移相同的外观共用
+struct cpu_shared_view {
+	float dx;
+	float dy;
+	int pad;
+	bool has_luma;
+	std::vector<float> pixels; // RGBA，(w + 2 * pad) * (y1 - y0 + 2 * pad)
+	std::vector<float> luma;
+};
+
+struct film_look_cpu_shared {
+	struct film_look_image src;
+	int pad;
+	int y0; // 当前帧要渲染的行段 [y0, y1)
+	int y1;
+	std::vector<cpu_shared_view> views; // 前 view_count 个属于当前帧，其余的缓冲留着复用
+	size_t view_count;
+	std::vector<float> padded; // shift_source 的临时缓冲
+};
+
+static inline float luma(const float *c)
+{
+	return c[0] * 0.299f + c[1] * 0.587f + c[2] * 0.114f;
+}
+
+static inline float smoothstep(float edge0, float edge1, float x)
+{
+	float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+	return t * t * (3.0f - 2.0f * t);
+}
+
+static inline float frac(float x)
+{
+	return x - std::floor(x);
+}
+
+// 与 shader 中 PART 1 完全一致
+static inline void grade_pixel(const film_look_params *p, float *c)
+{
+	c[0] = std::pow(c[0], p->contrast);
+	c[1] = std::pow(c[1], p->contrast);
+	c[2] = std::pow(c[2], p->contrast);
+
+	float l = luma(c);
+	float teal = smoothstep(0.5f, 1.0f, l) * p->teal_amount;
+	c[0] += (0.7f - c[0]) * teal;
+	c[1] += (0.85f - c[1]) * teal;
+	c[2] += (1.0f - c[2]) * teal;
+
+	float orange = smoothstep(0.4f, 0.0f, l) * p->orange_amount;
+	c[0] += (1.0f - c[0]) * orange;
+	c[1] += (0.9f - c[1]) * orange;
+	c[2] += (0.7f - c[2]) * orange;
+}
+
+// 把源图像的 [y0, y1) 行复制到四周补 border 个像素的缓冲区，图像外的部分为零，
+// 对应 shader 里 Border 寻址的黑色边框。输出的第 j 行是源图像的第 y0 - border + j 行。
+static void pad_source(const film_look_image *src, int border, int y0, int y1, std::vector<float> &out)
+{
+	const int w = (int)src->width;
+	const int h = (int)src->height;
+	const size_t out_w = (size_t)w + 2 * border;
+	const size_t out_h = (size_t)(y1 - y0) + 2 * border;
+
+	out.assign(out_w * out_h * 4, 0.0f);
+	for (int y = std::max(y0 - border, 0); y < std::min(y1 + border, h); y++) {
+		const float *s = src->data + (size_t)y * src->stride;
+		std::copy(s, s + (size_t)w * 4, out.data() + ((size_t)(y - y0 + border) * out_w + border) * 4);
+	}
+}
+
+// 整帧共用同一个抖动偏移，所以所有像素的双线性权重都相同：
+// shifted(x, y) 就是 shader 里 image.Sample(shaken_uv + (x, y) * pixel_size)
+static void shift_source(const film_look_image *src, float dx, float dy, int pad, int y0, int y1,
+			 std::vector<float> &padded, std::vector<float> &out)
+{
+	const int ix = (int)std::floor(dx);
+	const int iy = (int)std::floor(dy);
+	const float fx = dx - (float)ix;
+	const float fy = dy - (float)iy;
+	const float w00 = (1.0f - fx) * (1.0f - fy);
+	const float w10 = fx * (1.0f - fy);
+	const float w01 = (1.0f - fx) * fy;
+	const float w11 = fx * fy;
+
+	const int border = pad + std::max(std::abs(ix), std::abs(iy)) + 1;
+	pad_source(src, border, y0, y1, padded);
+
+	const size_t pw = (size_t)src->width + 2 * border;
+	const size_t sw = (size_t)src->width + 2 * pad;
+	const size_t sh = (size_t)(y1 - y0) + 2 * pad;
+	out.resize(sw * sh * 4);
+
+	for (size_t oy = 0; oy < sh; oy++) {
+		const size_t py = (size_t)((ptrdiff_t)oy - pad + iy + border);
+		const float *r0 = padded.data() + (py * pw + (size_t)(border - pad + ix)) * 4;
+		const float *r1 = r0 + pw * 4;
+		float *o = out.data() + oy * sw * 4;
+
+		for (size_t i = 0; i < sw * 4; i++)
+			o[i] = w00 * r0[i] + w10 * r0[i + 4] + w01 * r1[i] + w11 * r1[i + 4];
+	}
+}
+
+// 找到（或生成）当前帧里抖动偏移为 (dx, dy)、边框至少 pad 的共用源图像
+static const cpu_shared_view &shared_view(film_look_cpu_shared *shared, float dx, float dy, int pad, bool want_luma)
+{
+	pad = std::max(pad, shared->pad);
+
+	cpu_shared_view *view = nullptr;
+	for (size_t i = 0; i < shared->view_count; i++) {
+		cpu_shared_view &v = shared->views[i];
+		if (v.dx == dx && v.dy == dy && v.pad >= pad) {
+			view = &v;
+			break;
+		}
+	}
+
+	if (!view) {
+		if (shared->view_count == shared->views.size())
+			shared->views.emplace_back();
+		view = &shared->views[shared->view_count++];
+		view->dx = dx;
+		view->dy = dy;
+		view->pad = pad;
+		view->has_luma = false;
+		if (dx != 0.0f || dy != 0.0f)
+			shift_source(&shared->src, dx, dy, pad, shared->y0, shared->y1, shared->padded, view->pixels);
+		else
+			pad_source(&shared->src, pad, shared->y0, shared->y1, view->pixels);
+	}
+
+	if (want_luma && !view->has_luma) {
+		const size_t count = view->pixels.size() / 4;
+		view->luma.resize(count);
+		for (size_t i = 0; i < count; i++)
+			view->luma[i] = luma(view->pixels.data() + i * 4);
+		view->has_luma = true;
+	}
+	return *view;
+}
+
+// 一层光晕：先提取高光，再做可分离的盒式求和。结果尚未乘以权重。
+// source 是带 pad 边框的源图像（h 是当前行段的行数），lum 是对应的亮度（为空时现算）。
+static void build_glow(film_look_cpu *cpu, const cpu_glow_layer &layer, int w, int h, int pad, const float *source,
+		       const float *lum, std::vector<float> &out)
+{
+	const size_t sw = (size_t)w + 2 * pad;
+	const size_t sh = (size_t)h + 2 * pad;
+	const int r = layer.radius;
+	const size_t rows = (size_t)h + 2 * r;
+	const size_t row_len = (size_t)w * 3;
+
+	cpu->bright.resize(sw * sh * 3);
+	const float *s = source;
+	float *b = cpu->bright.data();
+	for (size_t i = 0; i < sw * sh; i++) {
+		const float l = lum ? lum[i] : luma(s + i * 4);
+		float t = std::clamp((l - layer.threshold) * layer.inv_range, 0.0f, 1.0f);
+		float f = t * t * (3.0f - 2.0f * t);
+		b[i * 3 + 0] = s[i * 4 + 0] * f;
+		b[i * 3 + 1] = s[i * 4 + 1] * f;
+		b[i * 3 + 2] = s[i * 4 + 2] * f;
+	}
+
+	// 水平方向：row_sums 的第 j 行对应 shifted 的第 pad - r + j 行
+	cpu->row_sums.assign(rows * row_len, 0.0f);
+	for (size_t j = 0; j < rows; j++) {
+		float *acc = cpu->row_sums.data() + j * row_len;
+		const float *line = b + ((j + pad - r) * sw + pad - r) * 3;
+		for (int k = 0; k <= 2 * r; k++) {
+			const float *tap = line + (size_t)k * 3;
+			for (size_t i = 0; i < row_len; i++)
+				acc[i] += tap[i];
+		}
+	}
+
+	// 垂直方向
+	out.assign((size_t)h * row_len, 0.0f);
+	for (int y = 0; y < h; y++) {
+		float *acc = out.data() + (size_t)y * row_len;
+		for (int k = 0; k <= 2 * r; k++) {
+			const float *tap = cpu->row_sums.data() + ((size_t)y + k) * row_len;
+			for (size_t i = 0; i < row_len; i++)
+				acc[i] += tap[i];
+		}
+	}
+}
+
+template<uint32_t Mask>
+static void film_look_kernel(film_look_cpu *cpu, const film_look_image *src, film_look_cpu_shared *shared,
+			     film_look_image *dst, float elapsed_time, int y0, int y1)
+{
+	constexpr bool glows = (Mask & FILM_LOOK_STAGE_GLOWS) != 0;
+	constexpr bool grade = (Mask & FILM_LOOK_STAGE_GRADE) != 0;
+	constexpr bool grain = (Mask & FILM_LOOK_STAGE_GRAIN) != 0;
+	constexpr bool shake = (Mask & FILM_LOOK_STAGE_SHAKE) != 0;
+	constexpr bool stock = (Mask & FILM_LOOK_STAGE_STOCK) != 0;
+
+	const film_look_params *p = &cpu->params;
+	if (shared)
+		src = &shared->src;
+	const int w = (int)src->width;
+	const int h = (int)src->height;
+	const int rows = y1 - y0;
+	int pad = glows ? cpu->max_radius : 0;
+
+	// === PART 0: CAMERA SHAKE ===
+	float shake_u = 0.0f;
+	float shake_v = 0.0f;
+	if constexpr (shake) {
+		float time = elapsed_time * p->shake_speed;
+		shake_u = (std::sin(time * 1.3f + 0.5f) + std::sin(time * 2.7f + 1.2f)) * 0.5f * p->shake_intensity;
+		shake_v = (std::cos(time * 1.7f - 0.8f) + std::cos(time * 3.1f - 0.3f)) * 0.5f * p->shake_intensity;
+	}
+
+	const float *s = src->data + (size_t)y0 * src->stride;
+	size_t s_stride = src->stride;
+	const float *base = nullptr;
+	const float *lum = nullptr;
+	if constexpr (glows || shake) {
+		if (shared) {
+			const cpu_shared_view &view =
+				shared_view(shared, shake_u * (float)w, shake_v * (float)h, pad, glows);
+			pad = view.pad;
+			base = view.pixels.data();
+			lum = glows ? view.luma.data() : nullptr;
+		} else {
+			if constexpr (shake)
+				shift_source(src, shake_u * (float)w, shake_v * (float)h, pad, y0, y1, cpu->padded,
+					     cpu->shifted);
+			else
+				pad_source(src, pad, y0, y1, cpu->shifted);
+			base = cpu->shifted.data();
+		}
+
+		const size_t sw = (size_t)w + 2 * pad;
+		s = base + ((size_t)pad * sw + pad) * 4;
+		s_stride = sw * 4;
+	}
+
+	// === PART 2: CALCULATE EFFECTS ===
+	if constexpr (glows) {
+		for (int l = 0; l < cpu->layer_count; l++)
+			build_glow(cpu, cpu->layers[l], w, rows, pad, base, lum, cpu->glows[l]);
+	}
+
+	const size_t row_len = (size_t)w * 3;
+	cpu->row.resize(row_len);
+	float *c = cpu->row.data();
+	const float time_seed = frac(elapsed_time);
+
+	for (int y = 0; y < rows; y++) {
+		const float *srow = s + (size_t)y * s_stride;
+
+		for (int x = 0; x < w; x++) {
+			c[x * 3 + 0] = srow[x * 4 + 0];
+			c[x * 3 + 1] = srow[x * 4 + 1];
+			c[x * 3 + 2] = srow[x * 4 + 2];
+		}
+
+		// === PART 1: CINEMATIC COLOR GRADING ===
+		if constexpr (grade) {
+			for (int x = 0; x < w; x++)
+				grade_pixel(p, c + x * 3);
+		}
+
+		if constexpr (stock) {
+			const float strength = p->film_stock_strength;
+			for (int x = 0; x < w; x++) {
+				float *px = c + x * 3;
+				float filmic[3];
+				film_look_stock_sample(cpu->stock_lut.data(), FILM_LOOK_STOCK_LUT_SIZE, px, filmic);
+				px[0] += (filmic[0] - px[0]) * strength;
+				px[1] += (filmic[1] - px[1]) * strength;
+				px[2] += (filmic[2] - px[2]) * strength;
+			}
+		}
+
+		// === PART 3: COMBINE EVERYTHING ===
+		if constexpr (glows) {
+			for (int l = 0; l < cpu->layer_count; l++) {
+				const cpu_glow_layer &layer = cpu->layers[l];
+				const float *g = cpu->glows[l].data() + (size_t)y * row_len;
+
+				const float wr = layer.weight[0];
+				const float wg = layer.weight[1];
+				const float wb = layer.weight[2];
+
+				if (layer.screen) {
+					for (int x = 0; x < w; x++) {
+						c[x * 3 + 0] = 1.0f - (1.0f - c[x * 3 + 0]) * (1.0f - g[x * 3 + 0] * wr);
+						c[x * 3 + 1] = 1.0f - (1.0f - c[x * 3 + 1]) * (1.0f - g[x * 3 + 1] * wg);
+						c[x * 3 + 2] = 1.0f - (1.0f - c[x * 3 + 2]) * (1.0f - g[x * 3 + 2] * wb);
+					}
+				} else {
+					for (int x = 0; x < w; x++) {
+						c[x * 3 + 0] += g[x * 3 + 0] * wr;
+						c[x * 3 + 1] += g[x * 3 + 1] * wg;
+						c[x * 3 + 2] += g[x * 3 + 2] * wb;
+					}
+				}
+			}
+		}
+
+		if constexpr (grain) {
+			const float v = ((float)(y0 + y) + 0.5f) / (float)h + shake_v + time_seed;
+			for (int x = 0; x < w; x++) {
+				const float u = ((float)x + 0.5f) / (float)w + shake_u + time_seed;
+				float n = (frac(std::sin(u * 12.9898f + v * 78.233f) * 43758.5453123f) - 0.5f) * 2.0f;
+				n *= p->grain_intensity;
+				c[x * 3 + 0] += n;
+				c[x * 3 + 1] += n;
+				c[x * 3 + 2] += n;
+			}
+		}
+
+		float *drow = dst->data + (size_t)(y0 + y) * dst->stride;
+		for (int x = 0; x < w; x++) {
+			drow[x * 4 + 0] = std::clamp(c[x * 3 + 0], 0.0f, 1.0f);
+			drow[x * 4 + 1] = std::clamp(c[x * 3 + 1], 0.0f, 1.0f);
+			drow[x * 4 + 2] = std::clamp(c[x * 3 + 2], 0.0f, 1.0f);
+			drow[x * 4 + 3] = srow[x * 4 + 3];
+		}
+	}
+}
+
+// 为每一种阶段组合实例化一个内核，按位掩码索引
+template<uint32_t... Masks>
+static constexpr std::array<film_look_cpu_kernel_fn, sizeof...(Masks)>
+make_kernel_table(std::integer_sequence<uint32_t, Masks...>)
+{
+	return {{&film_look_kernel<Masks>...}};
+}
+
+static constexpr auto kernel_table =
+	make_kernel_table(std::make_integer_sequence<uint32_t, 1u << FILM_LOOK_STAGE_COUNT>{});
+
+struct film_look_cpu *film_look_cpu_create(void)
+{
+	auto *cpu = new film_look_cpu();
+	cpu->kernel = kernel_table[0];
+	return cpu;
+}
+
+void film_look_cpu_destroy(struct film_look_cpu *cpu)
+{
+	delete cpu;
+}
+
+static void add_layer(film_look_cpu *cpu, float intensity, float threshold, int radius, const float tint[3],
+		      bool screen)
+{
+	if (intensity <= 0.0f)
+		return;
+
+	radius = std::max(radius, 0);
+	const float count = (float)(2 * radius + 1) * (float)(2 * radius + 1);
+
+	cpu_glow_layer &layer = cpu->layers[cpu->layer_count++];
+	layer.threshold = threshold;
+	layer.inv_range = threshold < 1.0f ? 1.0f / (1.0f - threshold) : 1e9f;
+	layer.radius = radius;
+	layer.screen = screen;
+	for (int i = 0; i < 3; i++)
+		layer.weight[i] = tint[i] * intensity / count;
+
+	cpu->max_radius = std::max(cpu->max_radius, radius);
+}
+
+void film_look_cpu_update(struct film_look_cpu *cpu, const struct film_look_params *params)
+{
+	static const float white[3] = {1.0f, 1.0f, 1.0f};
+	static const float halation_tint[3] = {1.0f, 0.2f, 0.1f};
+	static const float secondary_tint[3] = {0.6f, 0.8f, 1.0f};
+
+	cpu->params = *params;
+	cpu->stage_mask = film_look_params_stage_mask(params);
+	cpu->kernel = kernel_table[cpu->stage_mask];
+
+	// 只有换了胶片预设才重新烘焙
+	if ((cpu->stage_mask & FILM_LOOK_STAGE_STOCK) && cpu->stock_lut_id != params->film_stock) {
+		const size_t size = FILM_LOOK_STOCK_LUT_SIZE;
+		cpu->stock_lut.resize(size * size * size * 3);
+		film_look_stock_bake(params->film_stock, FILM_LOOK_STOCK_LUT_SIZE, cpu->stock_lut.data());
+		cpu->stock_lut_id = params->film_stock;
+	}
+
+	cpu->layer_count = 0;
+	cpu->max_radius = 0;
+	add_layer(cpu, params->bloom_intensity, params->bloom_threshold, params->bloom_radius, white, false);
+	add_layer(cpu, params->halation_intensity, params->halation_threshold, params->halation_radius,
+		  halation_tint, true);
+	add_layer(cpu, params->secondary_glow_intensity, params->secondary_glow_threshold,
+		  params->secondary_glow_radius, secondary_tint, true);
+}
+
+void film_look_cpu_grade(const struct film_look_params *params, float rgb[3])
+{
+	grade_pixel(params, rgb);
+
+	if (film_look_params_stage_mask(params) & FILM_LOOK_STAGE_STOCK) {
+		float filmic[3];
+		film_look_stock_eval(params->film_stock, rgb, filmic);
+		for (int i = 0; i < 3; i++)
+			rgb[i] += (filmic[i] - rgb[i]) * params->film_stock_strength;
+	}
+}
+
+void film_look_cpu_render(struct film_look_cpu *cpu, const struct film_look_image *src, struct film_look_image *dst,
+			  float elapsed_time)
+{
+	film_look_cpu_render_rows(cpu, src, dst, elapsed_time, 0, src->height);
+}
+
+void film_look_cpu_render_rows(struct film_look_cpu *cpu, const struct film_look_image *src,
+			       struct film_look_image *dst, float elapsed_time, uint32_t y0, uint32_t y1)
+{
+	y1 = std::min(y1, src->height);
+	if (!src->width || y0 >= y1)
+		return;
+
+	cpu->kernel(cpu, src, nullptr, dst, elapsed_time, (int)y0, (int)y1);
+}
+
+int film_look_cpu_padding(const struct film_look_cpu *cpu)
+{
+	return (cpu->stage_mask & FILM_LOOK_STAGE_GLOWS) ? cpu->max_radius : 0;
+}
+
+struct film_look_cpu_shared *film_look_cpu_shared_create(void)
+{
+	return new film_look_cpu_shared();
+}
+
+void film_look_cpu_shared_destroy(struct film_look_cpu_shared *shared)
+{
+	delete shared;
+}
+
+void film_look_cpu_shared_begin(struct film_look_cpu_shared *shared, const struct film_look_image *src, int padding)
+{
+	film_look_cpu_shared_begin_rows(shared, src, padding, 0, src->height);
+}
+
+void film_look_cpu_shared_begin_rows(struct film_look_cpu_shared *shared, const struct film_look_image *src,
+				     int padding, uint32_t y0, uint32_t y1)
+{
+	shared->src = *src;
+	shared->pad = std::max(padding, 0);
+	shared->y1 = (int)std::min(y1, src->height);
+	shared->y0 = std::min((int)y0, shared->y1);
+	shared->view_count = 0;
+}
+
+void film_look_cpu_render_shared(struct film_look_cpu *cpu, struct film_look_cpu_shared *shared,
+				 struct film_look_image *dst, float elapsed_time)
+{
+	if (!shared->src.width || shared->y0 >= shared->y1)
+		return;
+
+	cpu->kernel(cpu, nullptr, shared, dst, elapsed_time, shared->y0, shared->y1);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "film-look-params.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CPU 端的图像：RGBA 交错存储的 float，取值 0~1
+struct film_look_image {
+	float *data;
+	uint32_t width;
+	uint32_t height;
+	size_t stride; // 每行的 float 个数
+};
+
+// mainImage 的 CPU 实现。参数更新时按启用的阶段选出一个特化过的内核，
+// 渲染时内层循环里不再有任何功能开关判断。
+struct film_look_cpu;
+
+struct film_look_cpu *film_look_cpu_create(void);
+void film_look_cpu_destroy(struct film_look_cpu *cpu);
+void film_look_cpu_update(struct film_look_cpu *cpu, const struct film_look_params *params);
+
+// 只做调色部分（对比度、青橙、胶片模拟），rgb 原地修改，用于导出 LUT。
+// 胶片模拟在这里直接计算模型，不经过烘焙的 LUT。
+void film_look_cpu_grade(const struct film_look_params *params, float rgb[3]);
+
+// src 和 dst 不能是同一块内存（光晕需要读取邻域像素）
+void film_look_cpu_render(struct film_look_cpu *cpu, const struct film_look_image *src, struct film_look_image *dst,
+			  float elapsed_time);
+// 只写 dst 的 [y0, y1) 行，结果与整帧渲染的对应行相同。src 仍是整帧（光晕和抖动会读到行段以外）。
+// 每个线程用自己的 film_look_cpu 渲染不同的行段，就能把一帧分给多个线程。
+void film_look_cpu_render_rows(struct film_look_cpu *cpu, const struct film_look_image *src,
+			       struct film_look_image *dst, float elapsed_time, uint32_t y0, uint32_t y1);
+
+// 同一帧用多个外观渲染时共用的中间结果：补好边框（有抖动时按偏移重采样）的源图像和
+// 每个像素的亮度。抖动偏移相同的外观（比如都没有抖动）共用同一份，只有调色、高光提取、
+// 盒式求和和合成按外观各做一次。
+struct film_look_cpu_shared;
+
+struct film_look_cpu_shared *film_look_cpu_shared_create(void);
+void film_look_cpu_shared_destroy(struct film_look_cpu_shared *shared);
+
+// 这个外观需要的源图像边框（最大光晕半径）
+int film_look_cpu_padding(const struct film_look_cpu *cpu);
+
+// 开始新的一帧。padding 传所有外观 film_look_cpu_padding 的最大值，共用的副本只生成一次；
+// src 在这一帧的 render_shared 全部完成前必须保持有效
+void film_look_cpu_shared_begin(struct film_look_cpu_shared *shared, const struct film_look_image *src, int padding);
+// 同上，但这一帧只渲染 [y0, y1) 行，用法同 film_look_cpu_render_rows
+void film_look_cpu_shared_begin_rows(struct film_look_cpu_shared *shared, const struct film_look_image *src,
+				     int padding, uint32_t y0, uint32_t y1);
+void film_look_cpu_render_shared(struct film_look_cpu *cpu, struct film_look_cpu_shared *shared,
+				 struct film_look_image *dst, float elapsed_time);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,389 @@
+#include "film-look-dust.h"
+#include "film-look-effect.h"
+
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// 放映时的胶片帧率：瑕疵每个胶片帧换一次，和 OBS 的输出帧率无关
+#define DUST_FILM_FPS 24.0f
+
+// 图集是 4x4 个 64 像素的格子，每行一种形状，每种四个变体
+#define ATLAS_CELL 64
+#define ATLAS_GRID 4
+#define ATLAS_SIZE (ATLAS_CELL * ATLAS_GRID)
+#define ATLAS_MARGIN 2 // 格子边上留空，线性采样不会从相邻的格子渗过来
+
+enum dust_shape {
+	SHAPE_SPECK = 0,
+	SHAPE_FIBER = 1,
+	SHAPE_HAIR = 2,
+	SHAPE_SCRATCH = 3,
+};
+
+// 划痕和毛发各有固定数量的槽位，每个槽位按自己的周期决定出不出现，出现期间位置基本不变
+#define DUST_SCRATCH_SLOTS 8
+#define DUST_SCRATCH_FRAMES 36
+#define DUST_HAIR_SLOTS 4
+#define DUST_HAIR_FRAMES 48
+
+#define DUST_MAX_SPRITES 96
+#define VERTS_PER_SPRITE 6
+
+// 随机数流：同一个种子下灰尘、各个划痕槽位和毛发槽位互不相关
+#define STREAM_ATLAS 1
+#define STREAM_DUST 2
+#define STREAM_SCRATCH 16
+#define STREAM_SCRATCH_JITTER 32
+#define STREAM_HAIR 64
+
+struct dust_sprite {
+	float x, y;
+	float half_width, half_height;
+	float angle;
+	int shape; // enum dust_shape
+	int variant;
+	float v0, v1; // 取格子里这一段高度（0~1），划痕每帧取不同的一段
+	uint32_t color;
+};
+
+struct film_look_dust {
+	gs_texture_t *atlas;
+	bool atlas_failed;
+	gs_vertbuffer_t *vb;
+	uint32_t vert_count;
+
+	// vb 里现在是哪一帧、哪组设置的瑕疵
+	bool generated;
+	int64_t frame;
+	uint32_t width;
+	uint32_t height;
+	struct film_look_dust_settings settings;
+};
+
+struct dust_rng {
+	uint64_t state;
+};
+
+static uint64_t mix64(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+static void rng_seed(struct dust_rng *rng, uint32_t seed, uint64_t stream, int64_t epoch)
+{
+	rng->state = mix64((uint64_t)seed ^ mix64(stream * 0x9e3779b97f4a7c15ull + (uint64_t)epoch));
+}
+
+static float rng_float(struct dust_rng *rng)
+{
+	rng->state += 0x9e3779b97f4a7c15ull;
+	return (float)(mix64(rng->state) >> 40) * (1.0f / 16777216.0f);
+}
+
+static int rng_poisson(struct dust_rng *rng, float mean, int max)
+{
+	const float limit = expf(-mean);
+	float p = 1.0f;
+	int k = 0;
+	while (k < max) {
+		p *= rng_float(rng);
+		if (p <= limit)
+			break;
+		k++;
+	}
+	return k;
+}
+
+// 在格子里画一个半径 radius 的圆点（边缘一个像素的过渡），和已有的内容取最大值
+static void stamp(uint8_t *atlas, int shape, int variant, float x, float y, float radius, float strength)
+{
+	const int base_x = variant * ATLAS_CELL;
+	const int base_y = shape * ATLAS_CELL;
+	const int x0 = std::max((int)floorf(x - radius - 1.0f), ATLAS_MARGIN);
+	const int y0 = std::max((int)floorf(y - radius - 1.0f), ATLAS_MARGIN);
+	const int x1 = std::min((int)ceilf(x + radius + 1.0f), ATLAS_CELL - ATLAS_MARGIN - 1);
+	const int y1 = std::min((int)ceilf(y + radius + 1.0f), ATLAS_CELL - ATLAS_MARGIN - 1);
+
+	for (int py = y0; py <= y1; py++) {
+		for (int px = x0; px <= x1; px++) {
+			const float dx = (float)px + 0.5f - x;
+			const float dy = (float)py + 0.5f - y;
+			const float coverage =
+				std::clamp(radius + 0.5f - sqrtf(dx * dx + dy * dy), 0.0f, 1.0f) * strength;
+			uint8_t &texel = atlas[(size_t)(base_y + py) * ATLAS_SIZE + base_x + px];
+			texel = std::max(texel, (uint8_t)(coverage * 255.0f + 0.5f));
+		}
+	}
+}
+
+// 沿随机游走的路径连续盖点，画出纤维和毛发
+static void stamp_strand(uint8_t *atlas, int shape, int variant, struct dust_rng *rng, float x, float y, float angle,
+			 int steps, float curl, float radius)
+{
+	const float bend = (rng_float(rng) - 0.5f) * curl;
+	for (int i = 0; i < steps; i++) {
+		stamp(atlas, shape, variant, x, y, radius, 1.0f);
+		angle += bend + (rng_float(rng) - 0.5f) * curl;
+		x += cosf(angle) * 0.75f;
+		y += sinf(angle) * 0.75f;
+	}
+}
+
+// 图集和用户的种子无关，每个实例第一次绘制时生成一次
+static std::vector<uint8_t> build_atlas(void)
+{
+	std::vector<uint8_t> atlas((size_t)ATLAS_SIZE * ATLAS_SIZE, 0);
+	const float center = ATLAS_CELL * 0.5f;
+	struct dust_rng rng;
+
+	for (int v = 0; v < ATLAS_GRID; v++) {
+		rng_seed(&rng, 0, STREAM_ATLAS, v);
+
+		// 灰尘：几个大小不一的圆点挤在一起，轮廓不规则
+		const int blobs = 3 + (int)(rng_float(&rng) * 4.0f);
+		const float radius = 6.0f + rng_float(&rng) * 4.0f;
+		for (int i = 0; i < blobs; i++) {
+			const float bx = center + (rng_float(&rng) - 0.5f) * radius * 1.6f;
+			const float by = center + (rng_float(&rng) - 0.5f) * radius * 1.6f;
+			stamp(atlas.data(), SHAPE_SPECK, v, bx, by, radius * (0.4f + 0.6f * rng_float(&rng)), 1.0f);
+		}
+
+		// 纤维：短而卷曲的线头
+		stamp_strand(atlas.data(), SHAPE_FIBER, v, &rng, center - 12.0f, center, rng_float(&rng) * 0.8f - 0.4f,
+			     36, 0.35f, 0.9f + rng_float(&rng) * 0.4f);
+
+		// 毛发：横穿整个格子的细长弧线
+		stamp_strand(atlas.data(), SHAPE_HAIR, v, &rng, ATLAS_MARGIN + 1.0f,
+			     center + (rng_float(&rng) - 0.5f) * 20.0f, (rng_float(&rng) - 0.5f) * 0.6f, 76, 0.03f,
+			     0.6f + rng_float(&rng) * 0.3f);
+
+		// 划痕：格子中间的一条竖线，深浅沿长度变化，中间有断开的地方
+		const float width = 1.5f + rng_float(&rng) * 1.5f;
+		const float phase0 = rng_float(&rng) * 6.2831853f;
+		const float phase1 = rng_float(&rng) * 6.2831853f;
+		const float phase2 = rng_float(&rng) * 6.2831853f;
+		for (int y = ATLAS_MARGIN; y < ATLAS_CELL - ATLAS_MARGIN; y++) {
+			float strength =
+				0.6f + 0.4f * sinf((float)y * 0.21f + phase0) + 0.3f * sinf((float)y * 0.057f + phase1);
+			if (sinf((float)y * 0.13f + phase2) > 0.85f)
+				strength = 0.0f;
+			strength = std::clamp(strength, 0.0f, 1.0f);
+			const float wobble = sinf((float)y * 0.05f + phase1) * 0.75f;
+			for (int x = ATLAS_MARGIN; x < ATLAS_CELL - ATLAS_MARGIN; x++) {
+				const float coverage =
+					std::clamp(width + 0.5f - fabsf((float)x + 0.5f - center - wobble), 0.0f, 1.0f);
+				uint8_t &texel = atlas[(size_t)(SHAPE_SCRATCH * ATLAS_CELL + y) * ATLAS_SIZE +
+						       v * ATLAS_CELL + x];
+				texel = std::max(texel, (uint8_t)(coverage * strength * 255.0f + 0.5f));
+			}
+		}
+	}
+
+	return atlas;
+}
+
+static uint32_t pack_color(uint8_t value, float alpha)
+{
+	const uint32_t a = (uint32_t)(std::clamp(alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+	return (uint32_t)value | ((uint32_t)value << 8) | ((uint32_t)value << 16) | (a << 24);
+}
+
+struct film_look_dust *film_look_dust_create(void)
+{
+	auto *dust = static_cast<struct film_look_dust *>(bzalloc(sizeof(struct film_look_dust)));
+
+	struct gs_vb_data *vbd = gs_vbdata_create();
+	vbd->num = DUST_MAX_SPRITES * VERTS_PER_SPRITE;
+	vbd->points = static_cast<struct vec3 *>(bzalloc(sizeof(struct vec3) * vbd->num));
+	vbd->colors = static_cast<uint32_t *>(bzalloc(sizeof(uint32_t) * vbd->num));
+	vbd->num_tex = 1;
+	vbd->tvarray = static_cast<struct gs_tvertarray *>(bzalloc(sizeof(struct gs_tvertarray)));
+	vbd->tvarray[0].width = 2;
+	vbd->tvarray[0].array = bzalloc(sizeof(struct vec2) * vbd->num);
+	dust->vb = gs_vertexbuffer_create(vbd, GS_DYNAMIC);
+	return dust;
+}
+
+void film_look_dust_destroy(struct film_look_dust *dust)
+{
+	if (!dust)
+		return;
+
+	gs_texture_destroy(dust->atlas);
+	gs_vertexbuffer_destroy(dust->vb);
+	bfree(dust);
+}
+
+static void emit_sprite(struct gs_vb_data *vbd, uint32_t first, const struct dust_sprite *sprite)
+{
+	static const float corners[VERTS_PER_SPRITE][2] = {{-1, -1}, {1, -1}, {-1, 1}, {-1, 1}, {1, -1}, {1, 1}};
+
+	// 往里缩半个纹素，四边形边上的采样不会碰到相邻格子
+	const float u0 = ((float)(sprite->variant * ATLAS_CELL) + 0.5f) / ATLAS_SIZE;
+	const float u1 = ((float)((sprite->variant + 1) * ATLAS_CELL) - 0.5f) / ATLAS_SIZE;
+	const float row = (float)(sprite->shape * ATLAS_CELL) + 0.5f;
+	const float v0 = (row + sprite->v0 * (ATLAS_CELL - 1)) / ATLAS_SIZE;
+	const float v1 = (row + sprite->v1 * (ATLAS_CELL - 1)) / ATLAS_SIZE;
+
+	const float c = cosf(sprite->angle);
+	const float s = sinf(sprite->angle);
+	auto *uvs = static_cast<struct vec2 *>(vbd->tvarray[0].array);
+
+	for (int i = 0; i < VERTS_PER_SPRITE; i++) {
+		const float lx = corners[i][0] * sprite->half_width;
+		const float ly = corners[i][1] * sprite->half_height;
+		vec3_set(&vbd->points[first + i], sprite->x + lx * c - ly * s, sprite->y + lx * s + ly * c, 0.0f);
+		vec2_set(&uvs[first + i], corners[i][0] < 0.0f ? u0 : u1, corners[i][1] < 0.0f ? v0 : v1);
+		vbd->colors[first + i] = sprite->color;
+	}
+}
+
+static uint32_t generate_sprites(const struct film_look_dust_settings *settings, int64_t frame, uint32_t width,
+				 uint32_t height, struct dust_sprite *sprites)
+{
+	const float scale = (float)height / 1080.0f;
+	const float w = (float)width;
+	const float h = (float)height;
+	uint32_t count = 0;
+	struct dust_rng rng;
+	struct dust_rng jitter;
+
+	// 划痕：出现期间沿横向缓慢漂移，每帧再有一点抖动，深浅也每帧变化
+	for (int slot = 0; slot < DUST_SCRATCH_SLOTS; slot++) {
+		const int64_t shifted = frame + slot * 11;
+		const int64_t epoch = shifted / DUST_SCRATCH_FRAMES;
+		rng_seed(&rng, settings->seed, STREAM_SCRATCH + slot, epoch);
+		if (rng_float(&rng) >= settings->scratch_rate / DUST_SCRATCH_SLOTS)
+			continue;
+
+		rng_seed(&jitter, settings->seed, STREAM_SCRATCH_JITTER + slot, frame);
+		const float age = (float)(shifted - epoch * DUST_SCRATCH_FRAMES);
+		const float drift = (rng_float(&rng) - 0.5f) * 0.6f * scale;
+		struct dust_sprite &sprite = sprites[count++];
+		sprite.x = rng_float(&rng) * w + drift * age + (rng_float(&jitter) - 0.5f) * 1.5f * scale;
+		sprite.y = h * 0.5f;
+		sprite.half_width = (10.0f + 12.0f * rng_float(&rng)) * std::max(scale, 0.5f);
+		sprite.half_height = h * 0.5f;
+		sprite.angle = (rng_float(&rng) - 0.5f) * 0.004f;
+		sprite.shape = SHAPE_SCRATCH;
+		sprite.variant = (int)(rng_float(&rng) * ATLAS_GRID);
+		sprite.v0 = rng_float(&jitter) * 0.5f;
+		sprite.v1 = sprite.v0 + 0.5f;
+		sprite.color = pack_color(rng_float(&rng) < 0.7f ? 255 : 0,
+					  settings->opacity * (0.4f + 0.4f * rng_float(&jitter)));
+	}
+
+	// 片门毛发：卡在画面边上，一半露在外面，每帧轻微摆动
+	for (int slot = 0; slot < DUST_HAIR_SLOTS; slot++) {
+		const int64_t epoch = (frame + slot * 17) / DUST_HAIR_FRAMES;
+		rng_seed(&rng, settings->seed, STREAM_HAIR + slot, epoch);
+		if (rng_float(&rng) >= settings->hair_rate / DUST_HAIR_SLOTS)
+			continue;
+
+		struct dust_sprite &sprite = sprites[count++];
+		const int edge = std::min((int)(rng_float(&rng) * 4.0f), 3);
+		const float along = rng_float(&rng);
+		const float size = (60.0f + 120.0f * rng_float(&rng)) * scale;
+		const float inset = size * 0.4f;
+		const float positions[4][2] = {{inset, along * h}, {w - inset, along * h}, {along * w, inset},
+					       {along * w, h - inset}};
+		sprite.x = positions[edge][0];
+		sprite.y = positions[edge][1];
+		sprite.half_width = size;
+		sprite.half_height = size;
+		sprite.angle = (float)edge * 1.5707963f + (rng_float(&rng) - 0.5f) * 0.8f +
+			       sinf((float)frame * 0.7f + (float)slot) * 0.03f;
+		sprite.shape = SHAPE_HAIR;
+		sprite.variant = (int)(rng_float(&rng) * ATLAS_GRID);
+		sprite.v0 = 0.0f;
+		sprite.v1 = 1.0f;
+		sprite.color = pack_color(0, settings->opacity * 0.9f);
+	}
+
+	// 灰尘：每个胶片帧重新撒一遍，多数是印片上的黑点，少数是负片上的白点
+	rng_seed(&rng, settings->seed, STREAM_DUST, frame);
+	const int dust_count = rng_poisson(&rng, settings->dust_rate, DUST_MAX_SPRITES - (int)count);
+	for (int i = 0; i < dust_count; i++) {
+		struct dust_sprite &sprite = sprites[count++];
+		const float r = rng_float(&rng);
+		const bool fiber = rng_float(&rng) < 0.25f;
+		const float size = (3.0f + 14.0f * r * r) * (fiber ? 2.0f : 1.0f) * std::max(scale, 0.5f);
+		sprite.x = rng_float(&rng) * w;
+		sprite.y = rng_float(&rng) * h;
+		sprite.half_width = size;
+		sprite.half_height = size;
+		sprite.angle = rng_float(&rng) * 6.2831853f;
+		sprite.shape = fiber ? SHAPE_FIBER : SHAPE_SPECK;
+		sprite.variant = (int)(rng_float(&rng) * ATLAS_GRID);
+		sprite.v0 = 0.0f;
+		sprite.v1 = 1.0f;
+		sprite.color = pack_color(rng_float(&rng) < 0.75f ? 0 : 255,
+					  settings->opacity * (0.5f + 0.5f * rng_float(&rng)));
+	}
+
+	return count;
+}
+
+static bool ensure_atlas(struct film_look_dust *dust)
+{
+	if (dust->atlas || dust->atlas_failed)
+		return dust->atlas != nullptr;
+
+	std::vector<uint8_t> pixels = build_atlas();
+	const uint8_t *planes[] = {pixels.data()};
+	dust->atlas = gs_texture_create(ATLAS_SIZE, ATLAS_SIZE, GS_R8, 1, planes, 0);
+	dust->atlas_failed = dust->atlas == nullptr;
+	return dust->atlas != nullptr;
+}
+
+void film_look_dust_render(struct film_look_dust *dust, const struct film_look_dust_settings *settings, float time,
+			   uint32_t width, uint32_t height)
+{
+	gs_effect_t *effect = film_look_effect_get_dust();
+	if (!effect || !dust->vb || !ensure_atlas(dust))
+		return;
+
+	// 同一个胶片帧内画面不变，顶点只在换帧或改设置时重新生成上传
+	const int64_t frame = (int64_t)floorf(std::max(time, 0.0f) * DUST_FILM_FPS);
+	if (!dust->generated || frame != dust->frame || width != dust->width || height != dust->height ||
+	    memcmp(&dust->settings, settings, sizeof(*settings)) != 0) {
+		struct dust_sprite sprites[DUST_MAX_SPRITES];
+		const uint32_t count = generate_sprites(settings, frame, width, height, sprites);
+
+		struct gs_vb_data *vbd = gs_vertexbuffer_get_data(dust->vb);
+		for (uint32_t i = 0; i < count; i++)
+			emit_sprite(vbd, i * VERTS_PER_SPRITE, &sprites[i]);
+		if (count)
+			gs_vertexbuffer_flush(dust->vb);
+
+		dust->vert_count = count * VERTS_PER_SPRITE;
+		dust->generated = true;
+		dust->frame = frame;
+		dust->width = width;
+		dust->height = height;
+		dust->settings = *settings;
+	}
+
+	if (!dust->vert_count)
+		return;
+
+	gs_blend_state_push();
+	gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ZERO, GS_BLEND_ONE);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "atlas"), dust->atlas);
+	gs_load_vertexbuffer(dust->vb);
+	gs_load_indexbuffer(nullptr);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw(GS_TRIS, 0, dust->vert_count);
+	gs_load_vertexbuffer(nullptr);
+	gs_blend_state_pop();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <graphics/graphics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 胶片上的灰尘、划痕和片门毛发。不在 mainImage 里逐像素计算，而是每个胶片帧按种子
+// 随机生成几十个精灵，形状取自启动时生成的纹理图集，在主 pass 之后一次绘制叠加上去。
+// 开销随可见的瑕疵数量增长，与画面分辨率无关。
+struct film_look_dust_settings {
+	float dust_rate;    // 每个胶片帧平均的灰尘数
+	float scratch_rate; // 平均同时可见的划痕数
+	float hair_rate;    // 平均同时可见的片门毛发数
+	float opacity;
+	uint32_t seed; // 相同的种子和时间得到相同的画面
+};
+
+struct film_look_dust;
+
+// 以下函数都需要在图形上下文中调用
+struct film_look_dust *film_look_dust_create(void);
+void film_look_dust_destroy(struct film_look_dust *dust);
+
+// 把 time 秒所在胶片帧的瑕疵画到当前渲染目标上，坐标和主 pass 的 gs_draw_sprite 相同
+// （0,0 到 width,height）。只改颜色，不改目标的 alpha。
+void film_look_dust_render(struct film_look_dust *dust, const struct film_look_dust_settings *settings, float time,
+			   uint32_t width, uint32_t height);
+
+#ifdef __cplusplus
+}
+#endif
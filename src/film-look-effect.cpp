@@ -0,0 +1,889 @@
+#include "film-look-effect.h"
+#include "film-look-glow-pyramid.h"
+
+#include "plugin-support.h"
+
+#include <util/dstr.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+static const char *film_look_effect_string = R"(
+// =========================================================================
+//  Cinematic Look Shader for OBS Studio (HLSL - Native Plugin Version)
+// =========================================================================
+
+// --- Uniforms ---
+uniform float4x4 ViewProj;
+uniform texture2d image;
+
+// --- Look Block ---
+// 一个实例的全部外观标量打包成 float4 数组，设置变化时由 C 代码重建，每帧一次 gs_effect_set_val 上传：
+//   [0] = contrast, teal_amount, orange_amount, film_stock_strength
+//   [1] = bloom_intensity, bloom_threshold, halation_intensity, halation_threshold
+//   [2] = secondary_glow_intensity, secondary_glow_threshold, grain_intensity, 0
+// COMPARE 变体另外用到：
+//   [3..5] = 预设 B，布局同 [0..2]
+//   [6] = compare_line：xy 分界线上一点 (uv)，zw 指向 B 一侧的单位法线（像素空间）
+//   [7] = x compare_split：为 1 时左右各显示同一块区域，区域中心在 compare_line.x
+// 数组长度 LOOK_BLOCK_VECTORS / FRAME_BLOCK_VECTORS 由 C 代码 #define。
+uniform float4 look_block[LOOK_BLOCK_VECTORS];
+
+// --- Frame Block ---
+// 每帧变化的值，同样一次上传。抖动偏移对整帧相同，由 C 代码算好：
+//   [0] = uv_size, shake_offset
+//   [1] = grain_plate_scale（画面尺寸 / 颗粒帧尺寸）, grain_plate_offset
+//   [2] = x elapsed_time, y grain_plate_enabled
+uniform float4 frame_block[FRAME_BLOCK_VECTORS];
+
+// -- Film Stock (CPU 烘焙的 3D LUT) --
+uniform texture3d film_stock_lut;
+
+// -- Absorbed Upstream Filters (ABSORB_UPSTREAM 变体，CPU 烘焙的 33^3 LUT) --
+uniform texture3d upstream_lut;
+
+// -- Glow Source (GLOW_SOURCE 变体，否则抽头直接采样 image) --
+// C 代码用 2x2 盒式滤波缩小过一两次的画面拷贝，逐像素收集光晕的抽头从这里采样。
+// 抽头偏移仍按全分辨率的像素算，核的形状和抽头数不变，只是相邻的抽头落进同一个纹素，缓存命中高得多。
+uniform texture2d glow_source;
+
+// -- Sparse Glow (SPLAT_GLOWS 变体) --
+uniform texture2d bloom_splat;
+uniform texture2d halation_splat;
+uniform texture2d secondary_glow_splat;
+
+// -- User Glow Layers (EXTRA_GLOW_LAYERS 变体) --
+// 共用的亮部金字塔按级拼在一张纹理里，glow_level_rect 是每一级在里面的位置
+// (xy 偏移, zw 缩放，都是 uv)，各级之间没有空隙，采样坐标限制在向内缩 glow_pyramid_half_texel 的范围里。每层：color = rgb 颜色 * 强度, a 相对共用阈值多出的阈值；
+// shape = x 金字塔级（可以是小数）, y 混合方式 (0 相加, 1 滤色, 2 变亮)。
+// 数组长度 MAX_GLOW_LAYERS / GLOW_PYRAMID_LEVELS 由 C 代码 #define。
+uniform texture2d glow_pyramid;
+uniform float4 glow_level_rect[GLOW_PYRAMID_LEVELS];
+uniform float2 glow_pyramid_half_texel;
+uniform float4 glow_layer_color[MAX_GLOW_LAYERS];
+uniform float4 glow_layer_shape[MAX_GLOW_LAYERS];
+
+// 光晕半径不是 uniform：每种半径组合编译一个变体，由 C 代码在前面加上
+// #define BLOOM_RADIUS / HALATION_RADIUS / SECONDARY_GLOW_RADIUS / MAX_RADIUS（没启用的层为 0），
+// 以及对应的 *_ENABLED；对比变体另有 B 侧的 COMPARE_*_RADIUS / COMPARE_MAX_RADIUS。
+// 采样循环的边界和偏移因此都是常量，可以完全展开。
+
+// -- Scanned Grain Plate (代替程序化噪声，灰度存在 DXT1 的 6 位绿色通道里) --
+uniform texture2d grain_plate;
+
+// -- A/B Compare (COMPARE 变体，预设 B 的胶片 LUT) --
+uniform texture3d compare_film_stock_lut;
+
+sampler_state textureSampler {
+    Filter = Linear;
+    AddressU = Border;
+    AddressV = Border;
+    BorderColor = 00000000;
+};
+
+sampler_state grainSampler {
+    Filter = Point;
+    AddressU = Wrap;
+    AddressV = Wrap;
+};
+
+sampler_state splatSampler {
+    Filter = Point;
+    AddressU = Border;
+    AddressV = Border;
+    BorderColor = 00000000;
+};
+
+sampler_state pyramidSampler {
+    Filter = Linear;
+    AddressU = Clamp;
+    AddressV = Clamp;
+};
+
+sampler_state lutSampler {
+    Filter = Linear;
+    AddressU = Clamp;
+    AddressV = Clamp;
+    AddressW = Clamp;
+};
+
+// --- Helper Functions ---
+#ifdef ABSORB_UPSTREAM
+// 被吸收的上游调色滤镜：画面和光晕的每个采样都先经过它，和滤镜还在时看到的一样
+// （LUT 没有 mipmap，SampleLevel 的结果和 Sample 相同，对比时的分支里也不需要导数）
+float3 upstream_grade(float3 c) {
+    return upstream_lut.SampleLevel(lutSampler, saturate(c) * (32.0 / 33.0) + (0.5 / 33.0), 0.0).rgb;
+}
+#endif
+
+#ifdef EXTRA_GLOW_LAYERS
+// 金字塔一级里的采样：超出这一级的部分取边缘的纹素，不会读到拼在旁边的另一级
+float3 sample_glow_level(float4 rect, float2 uv) {
+    float2 p = clamp(rect.xy + uv * rect.zw, rect.xy + glow_pyramid_half_texel,
+                     rect.xy + rect.zw - glow_pyramid_half_texel);
+    return glow_pyramid.Sample(pyramidSampler, p).rgb;
+}
+#endif
+
+float random(float2 st) {
+    return frac(sin(dot(st.xy, float2(12.9898, 78.233))) * 43758.5453123);
+}
+
+float3 BlendScreen(float3 base, float3 blend) {
+    return 1.0 - ((1.0 - base) * (1.0 - blend));
+}
+
+// 一个像素用到的全部外观参数。对比模式下按像素所在的一侧选 A 或 B，
+// 每个像素只计算一套外观；不对比时编译器直接折叠成 look_block 的分量。
+struct LookParams {
+    float contrast;
+    float teal_amount;
+    float orange_amount;
+    float film_stock_strength;
+    float bloom_intensity;
+    float bloom_threshold;
+    float halation_intensity;
+    float halation_threshold;
+    float secondary_glow_intensity;
+    float secondary_glow_threshold;
+    float grain_intensity;
+};
+
+// base 是这套外观在 look_block 里的起始下标（A 为 0，B 为 3）
+LookParams unpack_look(int base) {
+    float4 grade = look_block[base];
+    float4 glows = look_block[base + 1];
+    float4 rest = look_block[base + 2];
+    LookParams p;
+    p.contrast = grade.x;
+    p.teal_amount = grade.y;
+    p.orange_amount = grade.z;
+    p.film_stock_strength = grade.w;
+    p.bloom_intensity = glows.x;
+    p.bloom_threshold = glows.y;
+    p.halation_intensity = glows.z;
+    p.halation_threshold = glows.w;
+    p.secondary_glow_intensity = rest.x;
+    p.secondary_glow_threshold = rest.y;
+    p.grain_intensity = rest.z;
+    return p;
+}
+
+#ifdef GLOWS_ENABLED
+// 三层光晕的平均值，已经乘过颜色，还没乘强度
+struct GlowSums {
+    float3 bloom;
+    float3 halation;
+    float3 secondary_glow;
+};
+
+// 逐像素收集。调用处传的半径都是变体的常量，内联后循环边界和每层的范围判断在编译时确定，
+// 循环完全展开；半径为 0 的层（对比时只有另一侧启用）整个去掉。
+// 对比时在按像素所在一侧的分支里调用，用 SampleLevel 避免分支里的导数运算把分支展平
+GlowSums gather_glows(float2 uv, float2 pixel_size, LookParams look, int max_r, int bloom_r, int halation_r,
+                      int secondary_glow_r) {
+    GlowSums sums;
+    sums.bloom = float3(0,0,0);
+    sums.halation = float3(0,0,0);
+    sums.secondary_glow = float3(0,0,0);
+
+    [unroll]
+    for (int x = -max_r; x <= max_r; x++) {
+        [unroll]
+        for (int y = -max_r; y <= max_r; y++) {
+            float2 offset = float2(x, y);
+            float2 sample_uv = uv + offset * pixel_size;
+#ifdef GLOW_SOURCE
+            float3 sample_color = glow_source.SampleLevel(textureSampler, sample_uv, 0.0).rgb;
+#else
+            float3 sample_color = image.SampleLevel(textureSampler, sample_uv, 0.0).rgb;
+#endif
+#ifdef ABSORB_UPSTREAM
+            sample_color = upstream_grade(sample_color);
+#endif
+            float sample_luma = dot(sample_color, float3(0.299, 0.587, 0.114));
+
+            if (bloom_r > 0 && abs(x) <= bloom_r && abs(y) <= bloom_r) {
+                float bright_factor = smoothstep(look.bloom_threshold, 1.0, sample_luma);
+                sums.bloom += sample_color * bright_factor;
+            }
+
+            if (halation_r > 0 && abs(x) <= halation_r && abs(y) <= halation_r) {
+                float halation_bright_factor = smoothstep(look.halation_threshold, 1.0, sample_luma);
+                float3 tinted_color = sample_color * float3(1.0, 0.2, 0.1);
+                sums.halation += tinted_color * halation_bright_factor;
+            }
+
+            if (secondary_glow_r > 0 && abs(x) <= secondary_glow_r && abs(y) <= secondary_glow_r) {
+                float sg_bright_factor = smoothstep(look.secondary_glow_threshold, 1.0, sample_luma);
+                float3 sg_tint = float3(0.6, 0.8, 1.0);
+                sums.secondary_glow += (sample_color * sg_tint) * sg_bright_factor;
+            }
+        }
+    }
+
+    if (bloom_r > 0)
+        sums.bloom /= float((2 * bloom_r + 1) * (2 * bloom_r + 1));
+    if (halation_r > 0)
+        sums.halation /= float((2 * halation_r + 1) * (2 * halation_r + 1));
+    if (secondary_glow_r > 0)
+        sums.secondary_glow /= float((2 * secondary_glow_r + 1) * (2 * secondary_glow_r + 1));
+    return sums;
+}
+#endif
+
+// --- Vertex Shader ---
+struct VertData {
+	float4 pos : POSITION;
+	float2 uv  : TEXCOORD0;
+};
+
+VertData mainTransform(VertData v_in) {
+	VertData vert_out;
+	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.uv  = v_in.uv;
+	return vert_out;
+}
+
+// --- Pixel Shader ---
+float4 mainImage(VertData v_in) : TARGET {
+    float2 uv_size = frame_block[0].xy;
+    float elapsed_time = frame_block[2].x;
+    LookParams look = unpack_look(0);
+    float2 uv = v_in.uv;
+#ifdef COMPARE
+    // 分界线到这个像素的有符号距离（像素），>= 0 的一侧是 B
+    float4 compare_line = look_block[6];
+    bool split = look_block[7].x > 0.5;
+    float2 line_point = split ? float2(0.5, 0.5) : compare_line.xy;
+    float2 line_normal = split ? float2(1.0, 0.0) : compare_line.zw;
+    float line_distance = dot((v_in.uv - line_point) * uv_size, line_normal);
+    bool side_b = line_distance >= 0.0;
+    if (side_b)
+        look = unpack_look(3);
+    // 并排：两半都显示以 compare_line.x 为中心、半个画面宽的同一块区域
+    if (split)
+        uv.x += compare_line.x - (side_b ? 0.75 : 0.25);
+#endif
+
+    // === PART 0: CAMERA SHAKE ===
+    float2 shaken_uv = uv + frame_block[0].zw;
+
+    // === PART 1: CINEMATIC COLOR GRADING ===
+    float4 original_color = image.Sample(textureSampler, shaken_uv);
+#ifdef ABSORB_UPSTREAM
+    original_color.rgb = upstream_grade(original_color.rgb);
+#endif
+    float3 graded_color = original_color.rgb;
+
+    graded_color = pow(graded_color, float3(look.contrast, look.contrast, look.contrast));
+    float luma = dot(graded_color, float3(0.299, 0.587, 0.114));
+    float3 teal_color = float3(0.7, 0.85, 1.0);
+    float3 orange_color = float3(1.0, 0.9, 0.7);
+    graded_color = lerp(graded_color, teal_color, smoothstep(0.5, 1.0, luma) * look.teal_amount);
+    graded_color = lerp(graded_color, orange_color, smoothstep(0.4, 0.0, luma) * look.orange_amount);
+
+    if (look.film_stock_strength > 0.0) {
+        // 33^3 LUT：把 0~1 映射到首尾格点的中心
+        float3 lut_uv = saturate(graded_color) * (32.0 / 33.0) + (0.5 / 33.0);
+#ifdef COMPARE
+        float3 filmic = side_b ? compare_film_stock_lut.Sample(lutSampler, lut_uv).rgb
+                               : film_stock_lut.Sample(lutSampler, lut_uv).rgb;
+#else
+        float3 filmic = film_stock_lut.Sample(lutSampler, lut_uv).rgb;
+#endif
+        graded_color = lerp(graded_color, filmic, look.film_stock_strength);
+    }
+
+    // === PART 2: CALCULATE EFFECTS (BLOOM, HALATION, SECONDARY GLOW) ===
+    float3 bloom_accum = float3(0,0,0);
+    float3 halation_accum = float3(0,0,0);
+    float3 secondary_glow_accum = float3(0,0,0);
+    float2 pixel_size = 1.0 / uv_size;
+
+#ifdef SPLAT_GLOWS
+    // 光晕已经按亮点溅射进各层的缓冲里（同样是平均值，已经乘过颜色）
+#ifdef BLOOM_ENABLED
+    bloom_accum = bloom_splat.Sample(splatSampler, shaken_uv).rgb;
+#endif
+#ifdef HALATION_ENABLED
+    halation_accum = halation_splat.Sample(splatSampler, shaken_uv).rgb;
+#endif
+#ifdef SECONDARY_GLOW_ENABLED
+    secondary_glow_accum = secondary_glow_splat.Sample(splatSampler, shaken_uv).rgb;
+#endif
+#else
+#ifdef GLOWS_ENABLED
+    // 对比模式下 A、B 各展开一份收集，分界线两侧的像素各走一支，只付自己这一侧的采样
+    GlowSums glows;
+#ifdef COMPARE
+    if (side_b) {
+        glows = gather_glows(shaken_uv, pixel_size, look, COMPARE_MAX_RADIUS, COMPARE_BLOOM_RADIUS,
+                             COMPARE_HALATION_RADIUS, COMPARE_SECONDARY_GLOW_RADIUS);
+    } else {
+        glows = gather_glows(shaken_uv, pixel_size, look, MAX_RADIUS, BLOOM_RADIUS, HALATION_RADIUS,
+                             SECONDARY_GLOW_RADIUS);
+    }
+#else
+    glows = gather_glows(shaken_uv, pixel_size, look, MAX_RADIUS, BLOOM_RADIUS, HALATION_RADIUS,
+                         SECONDARY_GLOW_RADIUS);
+#endif
+    bloom_accum = glows.bloom;
+    halation_accum = glows.halation;
+    secondary_glow_accum = glows.secondary_glow;
+#endif
+#endif
+
+    // === PART 3: COMBINE EVERYTHING ===
+    float3 final_color = graded_color;
+
+#ifdef BLOOM_ENABLED
+    final_color += bloom_accum * look.bloom_intensity;
+#endif
+
+#ifdef HALATION_ENABLED
+    final_color = BlendScreen(final_color, halation_accum * look.halation_intensity);
+#endif
+
+#ifdef SECONDARY_GLOW_ENABLED
+    final_color = BlendScreen(final_color, secondary_glow_accum * look.secondary_glow_intensity);
+#endif
+
+#ifdef EXTRA_GLOW_LAYERS
+    // 每层两次采样：在相邻两级之间插值出任意半径
+    [unroll]
+    for (int i = 0; i < EXTRA_GLOW_LAYERS; i++) {
+        float level = glow_layer_shape[i].x;
+        int level0 = int(level);
+        int level1 = min(level0 + 1, GLOW_PYRAMID_LEVELS - 1);
+        float3 g0 = sample_glow_level(glow_level_rect[level0], shaken_uv);
+        float3 g1 = sample_glow_level(glow_level_rect[level1], shaken_uv);
+        float3 glow = lerp(g0, g1, level - float(level0));
+
+        // 共用的亮部按所有层中最低的阈值提取，更高的阈值在这里从亮度里再减掉
+        float glow_luma = dot(glow, float3(0.299, 0.587, 0.114));
+        glow *= saturate(1.0 - glow_layer_color[i].a / max(glow_luma, 1e-4));
+        glow *= glow_layer_color[i].rgb;
+
+        float mode = glow_layer_shape[i].y;
+        if (mode < 0.5)
+            final_color += glow;
+        else if (mode < 1.5)
+            final_color = BlendScreen(final_color, glow);
+        else
+            final_color = max(final_color, glow);
+    }
+#endif
+
+    float grain;
+    if (frame_block[2].y > 0.0) {
+        float2 plate_uv = shaken_uv * frame_block[1].xy + frame_block[1].zw;
+        grain = (grain_plate.Sample(grainSampler, plate_uv).g - 0.5) * 2.0;
+    } else {
+        float2 grain_seed_uv = shaken_uv + frac(elapsed_time);
+        grain = (random(grain_seed_uv) - 0.5) * 2.0;
+    }
+    final_color += grain * look.grain_intensity;
+
+#ifdef COMPARE
+    // 两个像素宽的分界线
+    if (abs(line_distance) < 1.0)
+        final_color = lerp(final_color, float3(1.0, 1.0, 1.0), 0.75);
+#endif
+
+    return float4(clamp(final_color, 0.0, 1.0), original_color.a);
+}
+
+technique Draw {
+	pass {
+		vertex_shader = mainTransform(v_in);
+		pixel_shader  = mainImage(v_in);
+	}
+}
+)";
+
+// 亮度最大值的归约：每个输出像素取上一级 8x8 块的最大值。
+// 第一级从画面算亮度 (Luma)，之后的级直接取 R32F 的值 (Max)。
+static const char *film_look_reduce_effect_string = R"(
+uniform float4x4 ViewProj;
+uniform texture2d image;
+
+uniform float2 source_size; // 上一级的像素尺寸
+uniform float2 target_size; // 这一级的像素尺寸
+
+struct VertData {
+	float4 pos : POSITION;
+	float2 uv  : TEXCOORD0;
+};
+
+VertData VSDefault(VertData v_in) {
+	VertData vert_out;
+	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.uv  = v_in.uv;
+	return vert_out;
+}
+
+float reduce_block(float2 uv, float3 weights) {
+    int2 base = int2(floor(uv * target_size)) * 8;
+    int2 last = int2(source_size) - 1;
+    float result = 0.0;
+
+    [unroll]
+    for (int y = 0; y < 8; y++) {
+        [unroll]
+        for (int x = 0; x < 8; x++) {
+            int2 p = min(base + int2(x, y), last);
+            result = max(result, dot(image.Load(int3(p, 0)).rgb, weights));
+        }
+    }
+    return result;
+}
+
+float4 PSLuma(VertData v_in) : TARGET {
+    return float4(reduce_block(v_in.uv, float3(0.299, 0.587, 0.114)), 0.0, 0.0, 1.0);
+}
+
+float4 PSMax(VertData v_in) : TARGET {
+    return float4(reduce_block(v_in.uv, float3(1.0, 0.0, 0.0)), 0.0, 0.0, 1.0);
+}
+
+technique Luma {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSLuma(v_in);
+	}
+}
+
+technique Max {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSMax(v_in);
+	}
+}
+)";
+
+// 稀疏光晕：
+// CellSum 把画面缩成每 4x4 像素一个格子，存这一层亮部（已着色）的和；
+// Splat 给每个亮格子画一个 (2R+4) 见方的四边形，按盒式滤波和格子的重叠面积
+// 把格子的贡献加到光晕缓冲里，结果等价于在 1/4 分辨率上做 gather。
+static const char *film_look_splat_effect_string = R"(
+uniform float4x4 ViewProj;
+uniform texture2d image;
+
+uniform float2 source_size;
+uniform float2 target_size;
+uniform float threshold;
+uniform float3 tint;
+
+uniform texture2d cell_sums;
+uniform float glow_radius;
+uniform float inv_tap_count; // 1 / (2R+1)^2
+
+struct VertData {
+	float4 pos : POSITION;
+	float2 uv  : TEXCOORD0;
+};
+
+VertData VSDefault(VertData v_in) {
+	VertData vert_out;
+	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.uv  = v_in.uv;
+	return vert_out;
+}
+
+float4 PSCellSum(VertData v_in) : TARGET {
+    int2 base = int2(floor(v_in.uv * target_size)) * 4;
+    int2 size = int2(source_size);
+    float3 sum = float3(0.0, 0.0, 0.0);
+
+    [unroll]
+    for (int y = 0; y < 4; y++) {
+        [unroll]
+        for (int x = 0; x < 4; x++) {
+            int2 p = base + int2(x, y);
+            // 画面外按 Border 处理，贡献为 0
+            if (p.x < size.x && p.y < size.y) {
+                float3 c = image.Load(int3(p, 0)).rgb;
+                sum += c * smoothstep(threshold, 1.0, dot(c, float3(0.299, 0.587, 0.114)));
+            }
+        }
+    }
+    return float4(sum * tint, 1.0);
+}
+
+// 每个顶点带上格子的左上角像素坐标 (xy) 和格子坐标 (zw)，四个顶点相同
+struct SplatIn {
+	float4 pos  : POSITION;
+	float4 cell : TEXCOORD0;
+};
+
+struct SplatData {
+	float4 pos   : POSITION;
+	float4 cell  : TEXCOORD0;
+	float2 pixel : TEXCOORD1;
+};
+
+SplatData VSSplat(SplatIn v_in) {
+	SplatData vert_out;
+	vert_out.pos   = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.cell  = v_in.cell;
+	vert_out.pixel = v_in.pos.xy;
+	return vert_out;
+}
+
+float4 PSSplat(SplatData v_in) : TARGET {
+    float2 o = floor(v_in.pixel);
+    float2 lo = max(o - glow_radius, v_in.cell.xy);
+    float2 hi = min(o + glow_radius, v_in.cell.xy + 3.0);
+    float2 overlap = max(hi - lo + 1.0, 0.0);
+    float3 sum = cell_sums.Load(int3(int2(v_in.cell.zw), 0)).rgb;
+    return float4(sum * (overlap.x * overlap.y / 16.0) * inv_tap_count, 0.0);
+}
+
+technique CellSum {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSCellSum(v_in);
+	}
+}
+
+technique Splat {
+	pass {
+		vertex_shader = VSSplat(v_in);
+		pixel_shader  = PSSplat(v_in);
+	}
+}
+)";
+
+// 自定义光晕层的亮部金字塔：
+// BrightPass 从画面提取亮部并缩到 1/2，Downsample 每级再缩 1/2，
+// 两者都是中心 + 四角的双线性采样（每次覆盖 4x4 个源像素），级数越高越模糊；
+// Copy 把各级按原样拷进一张拼接纹理，合成时只需绑定一张纹理。
+// Box 是不带阈值的 2x2 盒式缩小，给逐像素收集光晕准备低分辨率的采样源。
+static const char *film_look_pyramid_effect_string = R"(
+uniform float4x4 ViewProj;
+uniform texture2d image;
+
+uniform float2 texel_size; // 源纹理的 1 / 尺寸
+uniform float threshold;
+
+sampler_state linearSampler {
+    Filter = Linear;
+    AddressU = Clamp;
+    AddressV = Clamp;
+};
+
+sampler_state pointSampler {
+    Filter = Point;
+    AddressU = Clamp;
+    AddressV = Clamp;
+};
+
+struct VertData {
+	float4 pos : POSITION;
+	float2 uv  : TEXCOORD0;
+};
+
+VertData VSDefault(VertData v_in) {
+	VertData vert_out;
+	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.uv  = v_in.uv;
+	return vert_out;
+}
+
+float3 bright(float3 c) {
+    return c * smoothstep(threshold, 1.0, dot(c, float3(0.299, 0.587, 0.114)));
+}
+
+float4 PSBrightPass(VertData v_in) : TARGET {
+    float3 sum = bright(image.Sample(linearSampler, v_in.uv).rgb) * 4.0;
+    sum += bright(image.Sample(linearSampler, v_in.uv + float2(-1.0, -1.0) * texel_size).rgb);
+    sum += bright(image.Sample(linearSampler, v_in.uv + float2( 1.0, -1.0) * texel_size).rgb);
+    sum += bright(image.Sample(linearSampler, v_in.uv + float2(-1.0,  1.0) * texel_size).rgb);
+    sum += bright(image.Sample(linearSampler, v_in.uv + float2( 1.0,  1.0) * texel_size).rgb);
+    return float4(sum / 8.0, 1.0);
+}
+
+float4 PSDownsample(VertData v_in) : TARGET {
+    float3 sum = image.Sample(linearSampler, v_in.uv).rgb * 4.0;
+    sum += image.Sample(linearSampler, v_in.uv + float2(-1.0, -1.0) * texel_size).rgb;
+    sum += image.Sample(linearSampler, v_in.uv + float2( 1.0, -1.0) * texel_size).rgb;
+    sum += image.Sample(linearSampler, v_in.uv + float2(-1.0,  1.0) * texel_size).rgb;
+    sum += image.Sample(linearSampler, v_in.uv + float2( 1.0,  1.0) * texel_size).rgb;
+    return float4(sum / 8.0, 1.0);
+}
+
+// 输出是源的一半大小时，线性采样正好落在 2x2 个源像素的交点上，等于盒式滤波
+float4 PSBox(VertData v_in) : TARGET {
+    return float4(image.Sample(linearSampler, v_in.uv).rgb, 1.0);
+}
+
+float4 PSCopy(VertData v_in) : TARGET {
+    return float4(image.Sample(pointSampler, v_in.uv).rgb, 1.0);
+}
+
+technique BrightPass {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSBrightPass(v_in);
+	}
+}
+
+technique Downsample {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSDownsample(v_in);
+	}
+}
+
+technique Box {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSBox(v_in);
+	}
+}
+
+technique Copy {
+	pass {
+		vertex_shader = VSDefault(v_in);
+		pixel_shader  = PSCopy(v_in);
+	}
+}
+)";
+
+// 灰尘 / 划痕 / 毛发精灵：图集只有覆盖度 (R8)，颜色和不透明度来自顶点颜色
+static const char *film_look_dust_effect_string = R"(
+uniform float4x4 ViewProj;
+uniform texture2d atlas;
+
+sampler_state atlasSampler {
+    Filter = Linear;
+    AddressU = Clamp;
+    AddressV = Clamp;
+};
+
+struct SpriteData {
+	float4 pos   : POSITION;
+	float4 color : COLOR;
+	float2 uv    : TEXCOORD0;
+};
+
+SpriteData VSSprite(SpriteData v_in) {
+	SpriteData vert_out;
+	vert_out.pos   = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
+	vert_out.color = v_in.color;
+	vert_out.uv    = v_in.uv;
+	return vert_out;
+}
+
+float4 PSSprite(SpriteData v_in) : TARGET {
+    float coverage = atlas.Sample(atlasSampler, v_in.uv).r;
+    return float4(v_in.color.rgb, v_in.color.a * coverage);
+}
+
+technique Draw {
+	pass {
+		vertex_shader = VSSprite(v_in);
+		pixel_shader  = PSSprite(v_in);
+	}
+}
+)";
+
+// 只在图形上下文中访问，图形锁已经把访问串行化了
+static std::unordered_map<uint64_t, gs_effect_t *> variants;
+static gs_effect_t *reduce_effect;
+static bool reduce_effect_failed;
+static gs_effect_t *splat_effect;
+static bool splat_effect_failed;
+static gs_effect_t *pyramid_effect;
+static bool pyramid_effect_failed;
+static gs_effect_t *dust_effect;
+static bool dust_effect_failed;
+
+// 半径决定展开多少次采样，也是 pack_key 里的一个字节。film_look_params_load 已经限制过，
+// 这里再按滑块范围限制一次，直接填 params 的调用方也不会编出巨大的循环或撞上别的变体
+static int key_radius(float intensity, int radius, int min, int max)
+{
+	return intensity > 0.0f ? std::clamp(radius, min, max) : 0;
+}
+
+void film_look_effect_key_from_params(const struct film_look_params *params, struct film_look_effect_key *key)
+{
+	key->bloom_radius = key_radius(params->bloom_intensity, params->bloom_radius, 1, 5);
+	key->halation_radius = key_radius(params->halation_intensity, params->halation_radius, 2, 8);
+	key->secondary_glow_radius = key_radius(params->secondary_glow_intensity, params->secondary_glow_radius, 1, 7);
+	key->splat = false;
+
+	key->absorb = false;
+	key->glow_source = false;
+
+	key->compare = false;
+	key->compare_bloom_radius = 0;
+	key->compare_halation_radius = 0;
+	key->compare_secondary_glow_radius = 0;
+
+	key->extra_glow_layers = 0;
+	for (int i = 0; i < params->glow_layer_count; i++)
+		key->extra_glow_layers += params->glow_layers[i].intensity > 0.0f;
+}
+
+static uint64_t pack_key(const struct film_look_effect_key *key)
+{
+	uint64_t packed = ((uint64_t)key->bloom_radius & 0xff) | (((uint64_t)key->halation_radius & 0xff) << 8) |
+			  (((uint64_t)key->secondary_glow_radius & 0xff) << 16) | ((uint64_t)key->splat << 24) |
+			  (((uint64_t)key->extra_glow_layers & 0xf) << 25) | ((uint64_t)key->absorb << 29) |
+			  ((uint64_t)key->glow_source << 31);
+
+	if (key->compare)
+		packed |= (1ull << 30) | (((uint64_t)key->compare_bloom_radius & 0xff) << 32) |
+			  (((uint64_t)key->compare_halation_radius & 0xff) << 40) |
+			  (((uint64_t)key->compare_secondary_glow_radius & 0xff) << 48);
+	return packed;
+}
+
+// 半径总是定义，没启用的层为 0，收集时整层跳过。对比时 A、B 任一边启用就编译这一层
+static void define_radius(struct dstr *text, const char *name, int radius, bool compare, int compare_radius)
+{
+	radius = std::max(radius, 0);
+	compare_radius = compare ? std::max(compare_radius, 0) : 0;
+	if (radius > 0 || compare_radius > 0)
+		dstr_catf(text, "#define %s_ENABLED\n", name);
+	dstr_catf(text, "#define %s_RADIUS %d\n", name, radius);
+	if (compare)
+		dstr_catf(text, "#define COMPARE_%s_RADIUS %d\n", name, compare_radius);
+}
+
+static gs_effect_t *compile_variant(const struct film_look_effect_key *key)
+{
+	// A、B 两侧各自的最大半径，各展开一份收集循环
+	const int max_radius = std::max({key->bloom_radius, key->halation_radius, key->secondary_glow_radius, 0});
+	const int compare_max_radius =
+		key->compare ? std::max({key->compare_bloom_radius, key->compare_halation_radius,
+					 key->compare_secondary_glow_radius, 0})
+			     : 0;
+
+	struct dstr text = {0};
+	dstr_catf(&text, "#define MAX_GLOW_LAYERS %d\n#define GLOW_PYRAMID_LEVELS %d\n", FILM_LOOK_MAX_GLOW_LAYERS,
+		  FILM_LOOK_GLOW_PYRAMID_LEVELS);
+	dstr_catf(&text, "#define LOOK_BLOCK_VECTORS %d\n#define FRAME_BLOCK_VECTORS %d\n",
+		  FILM_LOOK_LOOK_BLOCK_VECTORS, FILM_LOOK_FRAME_BLOCK_VECTORS);
+	define_radius(&text, "BLOOM", key->bloom_radius, key->compare, key->compare_bloom_radius);
+	define_radius(&text, "HALATION", key->halation_radius, key->compare, key->compare_halation_radius);
+	define_radius(&text, "SECONDARY_GLOW", key->secondary_glow_radius, key->compare,
+		      key->compare_secondary_glow_radius);
+	if (key->compare)
+		dstr_catf(&text, "#define COMPARE\n#define COMPARE_MAX_RADIUS %d\n", compare_max_radius);
+	if (max_radius > 0 || compare_max_radius > 0)
+		dstr_catf(&text, "#define GLOWS_ENABLED\n#define MAX_RADIUS %d\n", max_radius);
+	if (key->splat)
+		dstr_cat(&text, "#define SPLAT_GLOWS\n");
+	if (key->absorb)
+		dstr_cat(&text, "#define ABSORB_UPSTREAM\n");
+	if (key->glow_source)
+		dstr_cat(&text, "#define GLOW_SOURCE\n");
+	if (key->extra_glow_layers > 0)
+		dstr_catf(&text, "#define EXTRA_GLOW_LAYERS %d\n", key->extra_glow_layers);
+	dstr_cat(&text, film_look_effect_string);
+
+	// GLSL 没有 [unroll]，常量边界的循环交给驱动展开
+	if (gs_get_device_type() == GS_DEVICE_OPENGL)
+		dstr_replace(&text, "[unroll]", "");
+
+	char *errors = nullptr;
+	gs_effect_t *effect = gs_effect_create(text.array, nullptr, &errors);
+	if (!effect)
+		blog(LOG_WARNING, "[%s] failed to compile glow variant %d/%d/%d+%d%s%s: %s", PLUGIN_NAME,
+		     key->bloom_radius, key->halation_radius, key->secondary_glow_radius, key->extra_glow_layers,
+		     key->splat ? " (splat)" : "", key->compare ? " (compare)" : "", errors ? errors : "(no error text)");
+
+	bfree(errors);
+	dstr_free(&text);
+	return effect;
+}
+
+gs_effect_t *film_look_effect_get(const struct film_look_effect_key *key)
+{
+	const uint64_t packed = pack_key(key);
+	auto it = variants.find(packed);
+	if (it != variants.end())
+		return it->second;
+
+	// 失败的变体也记下来，避免每帧重新编译
+	gs_effect_t *effect = compile_variant(key);
+	variants.emplace(packed, effect);
+	return effect;
+}
+
+// 不分变体的辅助 effect：第一次用到时编译，失败后不再重试
+static gs_effect_t *get_helper_effect(gs_effect_t **effect, bool *failed, const char *source, const char *name)
+{
+	if (*effect || *failed)
+		return *effect;
+
+	struct dstr text = {0};
+	dstr_copy(&text, source);
+	if (gs_get_device_type() == GS_DEVICE_OPENGL)
+		dstr_replace(&text, "[unroll]", "");
+
+	char *errors = nullptr;
+	*effect = gs_effect_create(text.array, nullptr, &errors);
+	if (!*effect) {
+		blog(LOG_WARNING, "[%s] failed to compile %s: %s", PLUGIN_NAME, name, errors ? errors : "(no error text)");
+		*failed = true;
+	}
+
+	bfree(errors);
+	dstr_free(&text);
+	return *effect;
+}
+
+gs_effect_t *film_look_effect_get_reduce(void)
+{
+	return get_helper_effect(&reduce_effect, &reduce_effect_failed, film_look_reduce_effect_string,
+				 "luma reduction");
+}
+
+gs_effect_t *film_look_effect_get_splat(void)
+{
+	return get_helper_effect(&splat_effect, &splat_effect_failed, film_look_splat_effect_string, "sparse glow");
+}
+
+gs_effect_t *film_look_effect_get_pyramid(void)
+{
+	return get_helper_effect(&pyramid_effect, &pyramid_effect_failed, film_look_pyramid_effect_string,
+				 "glow pyramid");
+}
+
+gs_effect_t *film_look_effect_get_dust(void)
+{
+	return get_helper_effect(&dust_effect, &dust_effect_failed, film_look_dust_effect_string, "film dust");
+}
+
+void film_look_effect_free_all(void)
+{
+	for (auto &variant : variants) {
+		if (variant.second)
+			gs_effect_destroy(variant.second);
+	}
+	variants.clear();
+
+	if (reduce_effect)
+		gs_effect_destroy(reduce_effect);
+	reduce_effect = nullptr;
+	reduce_effect_failed = false;
+
+	if (splat_effect)
+		gs_effect_destroy(splat_effect);
+	splat_effect = nullptr;
+	splat_effect_failed = false;
+
+	if (pyramid_effect)
+		gs_effect_destroy(pyramid_effect);
+	pyramid_effect = nullptr;
+	pyramid_effect_failed = false;
+
+	if (dust_effect)
+		gs_effect_destroy(dust_effect);
+	dust_effect = nullptr;
+	dust_effect_failed = false;
+}
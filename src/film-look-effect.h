@@ -1 +1,58 @@
-// src/film-look-effect.h
+#pragma once
+
+#include "film-look-params.h"
+
+#include <graphics/graphics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 一个 effect 变体由三层光晕的半径决定，0 表示这一层没有启用（强度为 0）。
+// splat 为 true 时光晕不在 shader 里逐像素收集，而是读取稀疏光晕预先溅射好的缓冲。
+// extra_glow_layers 是强度大于 0 的自定义光晕层数，合成循环按它展开。
+// absorb 为 true 时每个采样先经过吸收的上游调色滤镜烘焙成的 LUT。
+// compare 为 true 时分界线 B 一侧的像素改用预设 B 的参数，compare_*_radius 是 B 的三层光晕半径。
+struct film_look_effect_key {
+	int bloom_radius;
+	int halation_radius;
+	int secondary_glow_radius;
+	bool splat;
+	int extra_glow_layers;
+	bool absorb;
+	bool glow_source; // 逐像素收集从单独的 glow_source 纹理采样，否则直接采样 image
+	bool compare;
+	int compare_bloom_radius;
+	int compare_halation_radius;
+	int compare_secondary_glow_radius;
+};
+
+// 主 effect 里 look_block / frame_block 的 float4 个数，各分量的布局见 effect 源码
+#define FILM_LOOK_LOOK_BLOCK_VECTORS 8
+#define FILM_LOOK_FRAME_BLOCK_VECTORS 3
+
+void film_look_effect_key_from_params(const struct film_look_params *params, struct film_look_effect_key *key);
+
+// 取出（必要时编译）对应半径组合的 effect。变体在整个模块内共享并缓存，
+// 调用者不拥有返回的 effect。需要在图形上下文中调用；编译失败返回 NULL。
+gs_effect_t *film_look_effect_get(const struct film_look_effect_key *key);
+
+// 亮度最大值归约用的 effect（技术 Luma / Max），同样共享缓存
+gs_effect_t *film_look_effect_get_reduce(void);
+
+// 稀疏光晕用的 effect（技术 CellSum / Splat），同样共享缓存
+gs_effect_t *film_look_effect_get_splat(void);
+
+// 自定义光晕层共用的亮部金字塔（技术 BrightPass / Downsample / Copy），以及缩小光晕采样源用的 Box，同样共享缓存
+gs_effect_t *film_look_effect_get_pyramid(void);
+
+// 灰尘 / 划痕 / 毛发精灵的 effect（技术 Draw），同样共享缓存
+gs_effect_t *film_look_effect_get_dust(void);
+
+// 销毁所有缓存的变体，需要在图形上下文中调用。
+// 由最后一个滤镜实例销毁时调用：模块卸载时图形子系统已经不在了。
+void film_look_effect_free_all(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,224 +1,147 @@
 #include "film-look-filter.h"
+#include "film-look-absorb.h"
+#include "film-look-cache.h"
+#include "film-look-dust.h"
+#include "film-look-effect.h"
+#include "film-look-glow-gate.h"
+#include "film-look-glow-pyramid.h"
+#include "film-look-grain.h"
+#include "film-look-lut.h"
+#include "film-look-params.h"
+#include "film-look-splat.h"
+#include "film-look-stock.h"
 
 #include "plugin-support.h"
 
 #include <graphics/graphics.h>
-#include <util/dstr.h>
-
-
-static const char *film_look_effect_string = R"(
-// =========================================================================
-//  Cinematic Look Shader for OBS Studio (HLSL - Native Plugin Version)
-// =========================================================================
-
-// --- Uniforms ---
-uniform float4x4 ViewProj;
-uniform texture2d image;
-
-// --- Helper Uniforms ---
-uniform float elapsed_time;
-uniform float2 uv_size;
-
-// -- Color & Contrast --
-uniform float contrast;
-uniform float teal_amount;
-uniform float orange_amount;
-
-// -- Bloom / White Glow --
-uniform float bloom_intensity;
-uniform float bloom_threshold;
-uniform int   bloom_radius;
-
-// -- Halation / Red-Orange Glow --
-uniform float halation_intensity;
-uniform float halation_threshold;
-uniform int   halation_radius;
-
-// -- Secondary Glow (Cool Tint) --
-uniform float secondary_glow_intensity;
-uniform float secondary_glow_threshold;
-uniform int   secondary_glow_radius;
-
-// -- Texture --
-uniform float grain_intensity;
-
-// -- Camera Shake --
-uniform float shake_intensity;
-uniform float shake_speed;
-
-sampler_state textureSampler {
-    Filter = Linear;
-    AddressU = Border;
-    AddressV = Border;
-    BorderColor = 00000000;
+#include <graphics/math-defs.h>
+#include <graphics/vec4.h>
+#include <util/half.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/threading.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+// 隐藏超过这么久的实例释放 effect 和烘焙好的纹理，再次显示时重新创建
+#define FILM_LOOK_RELEASE_AFTER_SEC 300.0f
+
+// 光晕的计算方式
+enum film_look_glow_mode {
+	FILM_LOOK_GLOW_GATHER = 0, // 每个像素收集邻域
+	FILM_LOOK_GLOW_SPARSE = 1, // 亮点稀疏时只溅射亮的格子，太密时自动退回收集
 };
 
-// --- Helper Functions ---
-float random(float2 st) {
-    return frac(sin(dot(st.xy, float2(12.9898, 78.233))) * 43758.5453123);
-}
+// 吸收上游调色滤镜时多久重新检查一次滤镜链
+#define FILM_LOOK_ABSORB_SCAN_SEC 0.5f
 
-float3 BlendScreen(float3 base, float3 blend) {
-    return 1.0 - ((1.0 - base) * (1.0 - blend));
-}
+// 逐像素收集光晕时采样源最多缩小几次（每次长宽各一半）
+#define FILM_LOOK_GLOW_SOURCE_MAX_LOD 2
 
-// --- Vertex Shader ---
-struct VertData {
-	float4 pos : POSITION;
-	float2 uv  : TEXCOORD0;
+// A/B 对比的分界方式
+enum film_look_compare_mode {
+	FILM_LOOK_COMPARE_WIPE = 0,  // 可移动、可旋转的分界线，两侧是画面的不同部分
+	FILM_LOOK_COMPARE_SPLIT = 1, // 左右并排显示同一块区域
 };
 
-VertData mainTransform(VertData v_in) {
-	VertData vert_out;
-	vert_out.pos = mul(float4(v_in.pos.xyz, 1.0), ViewProj);
-	vert_out.uv  = v_in.uv;
-	return vert_out;
-}
-
-// --- Pixel Shader ---
-float4 mainImage(VertData v_in) : TARGET {
-    // === PART 0: CAMERA SHAKE ===
-    float2 shake_offset = float2(0.0, 0.0);
-    if (shake_intensity > 0.0) {
-        float time = elapsed_time * shake_speed;
-        float shake_x = (sin(time * 1.3 + 0.5) + sin(time * 2.7 + 1.2)) * 0.5;
-        float shake_y = (cos(time * 1.7 - 0.8) + cos(time * 3.1 - 0.3)) * 0.5;
-        shake_offset = float2(shake_x, shake_y) * shake_intensity;
-    }
-    float2 shaken_uv = v_in.uv + shake_offset;
-
-    // === PART 1: CINEMATIC COLOR GRADING ===
-    float4 original_color = image.Sample(textureSampler, shaken_uv);
-    float3 graded_color = original_color.rgb;
-
-    graded_color = pow(graded_color, float3(contrast, contrast, contrast));
-    float luma = dot(graded_color, float3(0.299, 0.587, 0.114));
-    float3 teal_color = float3(0.7, 0.85, 1.0);
-    float3 orange_color = float3(1.0, 0.9, 0.7);
-    graded_color = lerp(graded_color, teal_color, smoothstep(0.5, 1.0, luma) * teal_amount);
-    graded_color = lerp(graded_color, orange_color, smoothstep(0.4, 0.0, luma) * orange_amount);
-
-    // === PART 2: CALCULATE EFFECTS (BLOOM, HALATION, SECONDARY GLOW) ===
-    float3 bloom_accum = float3(0,0,0);
-    float3 halation_accum = float3(0,0,0);
-    float3 secondary_glow_accum = float3(0,0,0);
-    float2 pixel_size = 1.0 / uv_size;
-
-    int max_radius_for_loop = max(bloom_radius, halation_radius);
-    max_radius_for_loop = max(max_radius_for_loop, secondary_glow_radius);
-
-    float bloom_sample_count = 0.0;
-    float halation_sample_count = 0.0;
-    float secondary_glow_sample_count = 0.0;
-
-    [loop]
-    for (int x = -max_radius_for_loop; x <= max_radius_for_loop; x++) {
-        [loop]
-        for (int y = -max_radius_for_loop; y <= max_radius_for_loop; y++) {
-            float2 offset = float2(x, y);
-            float2 sample_uv = shaken_uv + offset * pixel_size;
-            float3 sample_color = image.Sample(textureSampler, sample_uv).rgb;
-            float sample_luma = dot(sample_color, float3(0.299, 0.587, 0.114));
-
-            if (bloom_intensity > 0.0 && abs(x) <= bloom_radius && abs(y) <= bloom_radius) {
-                float bright_factor = smoothstep(bloom_threshold, 1.0, sample_luma);
-                bloom_accum += sample_color * bright_factor;
-                bloom_sample_count += 1.0;
-            }
-
-            if (halation_intensity > 0.0 && abs(x) <= halation_radius && abs(y) <= halation_radius) {
-                float halation_bright_factor = smoothstep(halation_threshold, 1.0, sample_luma);
-                float3 tinted_color = sample_color * float3(1.0, 0.2, 0.1);
-                halation_accum += tinted_color * halation_bright_factor;
-                halation_sample_count += 1.0;
-            }
-
-            if (secondary_glow_intensity > 0.0 && abs(x) <= secondary_glow_radius && abs(y) <= secondary_glow_radius) {
-                float sg_bright_factor = smoothstep(secondary_glow_threshold, 1.0, sample_luma);
-                float3 sg_tint = float3(0.6, 0.8, 1.0);
-                secondary_glow_accum += (sample_color * sg_tint) * sg_bright_factor;
-                secondary_glow_sample_count += 1.0;
-            }
-        }
-    }
-
-    if (bloom_sample_count > 0.0) { bloom_accum /= bloom_sample_count; }
-    if (halation_sample_count > 0.0) { halation_accum /= halation_sample_count; }
-    if (secondary_glow_sample_count > 0.0) { secondary_glow_accum /= secondary_glow_sample_count; }
-
-    // === PART 3: COMBINE EVERYTHING ===
-    float3 final_color = graded_color;
-
-    if (bloom_intensity > 0.0) {
-        final_color += bloom_accum * bloom_intensity;
-    }
-
-    if (halation_intensity > 0.0) {
-        final_color = BlendScreen(final_color, halation_accum * halation_intensity);
-    }
-
-    if (secondary_glow_intensity > 0.0) {
-        final_color = BlendScreen(final_color, secondary_glow_accum * secondary_glow_intensity);
-    }
-
-    float2 grain_seed_uv = shaken_uv + frac(elapsed_time);
-    float grain = (random(grain_seed_uv) - 0.5) * 2.0;
-    final_color += grain * grain_intensity;
-
-    return float4(clamp(final_color, 0.0, 1.0), original_color.a);
-}
-
-technique Draw {
-	pass {
-		vertex_shader = mainTransform(v_in);
-		pixel_shader  = mainImage(v_in);
-	}
-}
-)";
+// 存活的实例数，最后一个实例销毁时释放共享的 effect 变体
+static volatile long film_look_instances = 0;
 
 // 保存滤镜实例数据的结构体
 struct film_look_data {
 	obs_source_t *context;
 	gs_effect_t *effect;
 
+	// effect、LUT、颗粒包都延迟到第一次 render / show（或预热）时才创建。
+	// 加锁顺序：先 obs_enter_graphics 再 mutex，和渲染线程一致。
+	pthread_mutex_t mutex;
+	bool loaded;      // 已经尝试创建过资源
+	bool dirty;       // 设置变了，资源需要跟着更新
+	bool prewarm;     // 在节目 / 预览场景里时提前创建
+	bool shown;
+	float hidden_time;
+	char *grain_pack_setting;
+
+	// 亮度归约、溅射、金字塔或缩小的采样源这一帧要用到输入时，自己把目标渲染到这里，
+	// 同一张纹理供这些 pass 和主 pass 共用；都不需要时走 process_filter 的直接渲染
+	gs_texrender_t *input;
+	struct film_look_glow_gate *glow_gate;
+	struct film_look_splat *splat;
+	int glow_mode; // enum film_look_glow_mode
+	bool splat_active; // 这一帧的光晕来自 splat 缓冲
+	struct film_look_glow_pyramid *glow_pyramid;
+	int extra_glow_layers; // 当前变体展开的自定义光晕层数
+	int glow_source_lod; // 设置：逐像素收集从缩小几次的拷贝采样，0 为直接用画面
+	gs_texrender_t *glow_source_levels[FILM_LOOK_GLOW_SOURCE_MAX_LOD];
+	gs_texture_t *glow_source; // 这一帧缩小好的采样源，nullptr 时用画面本身
+
 	// 用于存储从UI设置中获取的值
-	float contrast;
-	float teal_amount;
-	float orange_amount;
-	float bloom_intensity;
-	float bloom_threshold;
-	int bloom_radius;
-	float halation_intensity;
-	float halation_threshold;
-	int halation_radius;
-	float secondary_glow_intensity;
-	float secondary_glow_threshold;
-	int secondary_glow_radius;
-	float grain_intensity;
-	float shake_intensity;
-	float shake_speed;
+	struct film_look_params params;
 
 	// 新增成员
 	float total_elapsed_time;
 
+	// 胶片模拟的 3D LUT，按预设在实例之间共享（见 acquire_stock_lut）
+	gs_texture_t *stock_lut;
+	int stock_lut_id;
+
+	// A/B 对比：分界线 B 一侧的像素用 compare_params 渲染，两套外观在同一次绘制里完成
+	bool compare_enabled;
+	int compare_mode; // enum film_look_compare_mode
+	float compare_position;
+	float compare_angle; // 度，0 为竖直分界线
+	struct film_look_params compare_params;
+	gs_texture_t *compare_stock_lut;
+	int compare_stock_lut_id;
+
+	// effect 里 look_block 的内容，设置变化后在 ensure_resources 里重建，渲染时整块上传
+	struct vec4 look_block[FILM_LOOK_LOOK_BLOCK_VECTORS];
+
+	// 吸收的上游调色滤镜，烘焙成和胶片模拟相同尺寸的 3D LUT
+	struct film_look_absorb *absorb;
+	bool absorb_enabled;
+	float absorb_scan_time;
+	gs_texture_t *upstream_lut;
+	bool upstream_lut_stale;
+
+	// 扫描颗粒包，路径为空或加载失败时使用程序化颗粒。按路径和修改时间在实例之间共享
+	struct film_look_grain_pack *grain_pack;
+	char *grain_pack_path;
+	int64_t grain_pack_mtime;
+
+	// 灰尘 / 划痕 / 毛发，主 pass 之后叠加
+	bool dust_enabled;
+	struct film_look_dust_settings dust_settings;
+	struct film_look_dust *dust;
+
 	// 指向effect文件中uniform变量的指针，用于高效更新
-	gs_eparam_t *param_contrast;
-	gs_eparam_t *param_teal_amount;
-	gs_eparam_t *param_orange_amount;
-	gs_eparam_t *param_bloom_intensity;
-	gs_eparam_t *param_bloom_threshold;
-	gs_eparam_t *param_bloom_radius;
-	gs_eparam_t *param_halation_intensity;
-	gs_eparam_t *param_halation_threshold;
-	gs_eparam_t *param_halation_radius;
-	gs_eparam_t *param_secondary_glow_intensity;
-	gs_eparam_t *param_secondary_glow_threshold;
-	gs_eparam_t *param_secondary_glow_radius;
-	gs_eparam_t *param_grain_intensity;
-	gs_eparam_t *param_shake_intensity;
-	gs_eparam_t *param_shake_speed;
-	gs_eparam_t *param_uv_size;
-	gs_eparam_t *param_elapsed_time;
+	gs_eparam_t *param_image;
+	gs_eparam_t *param_look_block;
+	gs_eparam_t *param_frame_block;
+	gs_eparam_t *param_film_stock_lut;
+	gs_eparam_t *param_compare_film_stock_lut;
+	gs_eparam_t *param_upstream_lut;
+	gs_eparam_t *param_glow_source;
+	gs_eparam_t *param_bloom_splat;
+	gs_eparam_t *param_halation_splat;
+	gs_eparam_t *param_secondary_glow_splat;
+	gs_eparam_t *param_glow_pyramid;
+	gs_eparam_t *param_glow_level_rect;
+	gs_eparam_t *param_glow_pyramid_half_texel;
+	gs_eparam_t *param_glow_layer_color;
+	gs_eparam_t *param_glow_layer_shape;
+	gs_eparam_t *param_grain_plate;
 };
 
 // 返回滤镜在UI中的显示名称
@@ -228,66 +151,402 @@ static const char *film_look_get_name(void *unused)
 	return obs_module_text("FilmLook.Filter");
 }
 
-// 加载/重载 .effect 文件
-static void update_effect(struct film_look_data *filter)
+// 把强度大于 0 的自定义光晕层按顺序打包成 shader 的 uniform 数组
+static void set_glow_layer_params(struct film_look_data *filter)
 {
-	/// 1. 创建一个 dstr 对象来处理字符串
-	dstr effect_text = {nullptr};
-	dstr_copy(&effect_text, film_look_effect_string);
+	struct vec4 color[FILM_LOOK_MAX_GLOW_LAYERS] = {};
+	struct vec4 shape[FILM_LOOK_MAX_GLOW_LAYERS] = {};
+	const float threshold = film_look_glow_pyramid_threshold(&filter->params);
+	int count = 0;
+
+	for (int i = 0; i < filter->params.glow_layer_count && count < filter->extra_glow_layers; i++) {
+		const struct film_look_glow_layer *layer = &filter->params.glow_layers[i];
+		if (layer->intensity <= 0.0f)
+			continue;
+
+		vec4_set(&color[count], layer->tint[0] * layer->intensity, layer->tint[1] * layer->intensity,
+			 layer->tint[2] * layer->intensity, layer->threshold - threshold);
+		vec4_set(&shape[count], film_look_glow_pyramid_level(layer->radius), (float)layer->blend, 0.0f, 0.0f);
+		count++;
+	}
 
-	// 2. 根据平台进行字符串替换
-	obs_enter_graphics();
-	int device_type = gs_get_device_type();
-	obs_leave_graphics();
+	gs_texture_t *atlas = film_look_glow_pyramid_texture(filter->glow_pyramid);
+	struct vec2 half_texel = {0.5f / (float)gs_texture_get_width(atlas), 0.5f / (float)gs_texture_get_height(atlas)};
+	gs_effect_set_texture(filter->param_glow_pyramid, atlas);
+	gs_effect_set_vec2(filter->param_glow_pyramid_half_texel, &half_texel);
+	gs_effect_set_val(filter->param_glow_level_rect, film_look_glow_pyramid_rects(filter->glow_pyramid),
+			  sizeof(struct vec4) * FILM_LOOK_GLOW_PYRAMID_LEVELS);
+	gs_effect_set_val(filter->param_glow_layer_color, color, sizeof(color));
+	gs_effect_set_val(filter->param_glow_layer_shape, shape, sizeof(shape));
+}
+
+// 一套外观占 look_block 的三个 float4，布局和 effect 里的 unpack_look 对应
+static void pack_look(struct vec4 *out, const struct film_look_params *p, bool has_stock_lut)
+{
+	vec4_set(&out[0], p->contrast, p->teal_amount, p->orange_amount,
+		 has_stock_lut ? p->film_stock_strength : 0.0f);
+	vec4_set(&out[1], p->bloom_intensity, p->bloom_threshold, p->halation_intensity, p->halation_threshold);
+	vec4_set(&out[2], p->secondary_glow_intensity, p->secondary_glow_threshold, p->grain_intensity, 0.0f);
+}
+
+// 设置变化后重建 look_block。胶片强度取决于 LUT 是否建好，所以放在 LUT 更新之后
+static void pack_look_block(struct film_look_data *filter)
+{
+	struct vec4 *block = filter->look_block;
+	memset(block, 0, sizeof(filter->look_block));
+	pack_look(&block[0], &filter->params, filter->stock_lut != nullptr);
 
-	if (device_type == GS_DEVICE_OPENGL) {
-		// 在 OpenGL (macOS, Linux) 上，移除 [loop]
-		dstr_replace(&effect_text, "[loop]", "");
+	if (filter->compare_enabled) {
+		pack_look(&block[3], &filter->compare_params, filter->compare_stock_lut != nullptr);
+
+		// 分界线过 (position, 0.5)，法线按角度旋转，指向 B 一侧
+		const float angle = RAD(filter->compare_angle);
+		vec4_set(&block[6], filter->compare_position, 0.5f, cosf(angle), sinf(angle));
+		block[7].x = filter->compare_mode == FILM_LOOK_COMPARE_SPLIT ? 1.0f : 0.0f;
 	}
-	// 对于 D3D11 (Windows)，[loop] 通常是支持的，所以我们不需要移除它。
-	// 这段代码现在是跨平台的。
+}
 
-	// 3. 使用处理过的字符串创建 effect
-	obs_enter_graphics();
+// 每帧变化的 frame_block：画面尺寸、抖动偏移（整帧相同，不必每个像素算一遍）、颗粒帧位置和时间
+static void set_frame_block(struct film_look_data *filter, float width, float height)
+{
+	struct vec4 block[FILM_LOOK_FRAME_BLOCK_VECTORS];
+	memset(block, 0, sizeof(block));
+
+	const struct film_look_params *p = &filter->params;
+	float shake_x = 0.0f;
+	float shake_y = 0.0f;
+	if (p->shake_intensity > 0.0f) {
+		const float time = filter->total_elapsed_time * p->shake_speed;
+		shake_x = (sinf(time * 1.3f + 0.5f) + sinf(time * 2.7f + 1.2f)) * 0.5f * p->shake_intensity;
+		shake_y = (cosf(time * 1.7f - 0.8f) + cosf(time * 3.1f - 0.3f)) * 0.5f * p->shake_intensity;
+	}
+	vec4_set(&block[0], width, height, shake_x, shake_y);
+
+	if (filter->grain_pack) {
+		float plate_offset[2];
+		uint32_t plate_width, plate_height;
+		film_look_grain_pack_size(filter->grain_pack, &plate_width, &plate_height);
+		gs_texture_t *plate =
+			film_look_grain_pack_frame(filter->grain_pack, filter->total_elapsed_time, plate_offset);
+		vec4_set(&block[1], width / (float)plate_width, height / (float)plate_height, plate_offset[0],
+			 plate_offset[1]);
+		gs_effect_set_texture(filter->param_grain_plate, plate);
+	}
+	block[2].x = filter->total_elapsed_time;
+	block[2].y = filter->grain_pack ? 1.0f : 0.0f;
 
-	if (filter->effect) {
-		gs_effect_destroy(filter->effect);
+	gs_effect_set_val(filter->param_frame_block, block, sizeof(block));
+}
+
+// 性能分析的作用域名（libobs 的分析器只保存指针）。各个 pass 分开计，基准程序按名字汇总
+static const char *capture_name = "film_look_capture";
+static const char *gate_measure_name = "film_look_glow_gate_measure";
+static const char *splat_name = "film_look_splat";
+static const char *glow_source_name = "film_look_glow_source";
+static const char *glow_pyramid_name = "film_look_glow_pyramid";
+static const char *upload_params_name = "film_look_upload_params";
+static const char *main_pass_name = "film_look_main_pass";
+static const char *dust_name = "film_look_dust";
+
+// 把画面用 2x2 盒式滤波缩小 glow_source_lod 次。第一次按 sRGB 读进线性空间（和主 pass 读 image 一致），
+// 中间结果存成 16 位浮点，主 pass 直接读到线性值
+static gs_texture_t *render_glow_source(struct film_look_data *filter, gs_texture_t *frame)
+{
+	gs_effect_t *effect = film_look_effect_get_pyramid();
+	if (!effect)
+		return nullptr;
+
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	uint32_t width = gs_texture_get_width(frame);
+	uint32_t height = gs_texture_get_height(frame);
+	gs_texture_t *level = frame;
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	for (int i = 0; i < filter->glow_source_lod && level; i++) {
+		width = std::max((width + 1) / 2, 1u);
+		height = std::max((height + 1) / 2, 1u);
+		if (!filter->glow_source_levels[i])
+			filter->glow_source_levels[i] = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+
+		gs_texrender_t *target = filter->glow_source_levels[i];
+		gs_texrender_reset(target);
+		if (!gs_texrender_begin(target, width, height)) {
+			level = nullptr;
+			break;
+		}
+
+		if (i == 0 && gs_get_linear_srgb())
+			gs_effect_set_texture_srgb(image, level);
+		else
+			gs_effect_set_texture(image, level);
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Box"))
+			gs_draw_sprite(level, 0, width, height);
+		gs_texrender_end(target);
+		level = gs_texrender_get_texture(target);
 	}
+	gs_blend_state_pop();
 
-	// 使用 effect_text.array 而不是 film_look_effect_string
-	filter->effect = gs_effect_create(effect_text.array, nullptr, nullptr);
+	return level;
+}
 
-	obs_leave_graphics();
+// 设置决定的变体，还没经过门控和各个需要画面的 pass
+static void build_effect_key(const struct film_look_data *filter, struct film_look_effect_key *key)
+{
+	film_look_effect_key_from_params(&filter->params, key);
+	key->absorb = filter->upstream_lut != nullptr;
+
+	if (filter->compare_enabled) {
+		struct film_look_effect_key compare_key;
+		film_look_effect_key_from_params(&filter->compare_params, &compare_key);
+		key->compare = true;
+		key->compare_bloom_radius = compare_key.bloom_radius;
+		key->compare_halation_radius = compare_key.halation_radius;
+		key->compare_secondary_glow_radius = compare_key.secondary_glow_radius;
+	}
+}
+
+// 这一帧有没有哪个 pass 要读输入纹理。都不需要时不截取画面，主 pass 走直接渲染
+static bool frame_wanted(struct film_look_data *filter)
+{
+	struct film_look_effect_key key;
+	build_effect_key(filter, &key);
+
+	const bool glows = key.bloom_radius || key.halation_radius || key.secondary_glow_radius;
+	const bool gathers = glows || key.compare_bloom_radius || key.compare_halation_radius ||
+			     key.compare_secondary_glow_radius;
+
+	if (key.extra_glow_layers > 0)
+		return true;
+	if (glows && filter->glow_mode == FILM_LOOK_GLOW_SPARSE && !key.compare && !key.absorb)
+		return true;
+	if (gathers && filter->glow_source_lod > 0)
+		return true;
+	// 吸收了上游调色时不门控，收集抽头本来就不需要画面
+	if (key.absorb)
+		return false;
+	return glows && (!filter->glow_gate || film_look_glow_gate_wants_frame(filter->glow_gate, &key));
+}
+
+// 按当前的光晕半径选出（必要时编译）effect 变体。变体由 film-look-effect 模块共享，
+// 切换变体时重新取一次 uniform 指针。
+// 传入画面时先做亮度归约，阈值达不到的光晕层直接用不带这一层的变体；
+// 稀疏模式下再尝试把剩下的光晕层溅射到缓冲里。没有画面时沿用上一次归约的结果。
+// 门控每次 apply 都会推进计数，只能在每帧一次的渲染调用里 apply（per_frame）；
+// 创建资源时只按完整的 key 选变体，同一帧接着的渲染调用会再按门控选一次
+static void update_effect(struct film_look_data *filter, gs_texture_t *frame, bool per_frame)
+{
+	struct film_look_effect_key key;
+	build_effect_key(filter, &key);
+	filter->splat_active = false;
+	filter->glow_source = nullptr;
+
+	// 门控和溅射都按原始画面对阈值，光晕却是对上游调色之后的颜色取阈值，吸收时两者都不用
+	if (per_frame && !frame && filter->glow_gate && !key.absorb) {
+		film_look_glow_gate_poll(filter->glow_gate);
+		film_look_glow_gate_apply(filter->glow_gate, &filter->params, &key);
+	}
 
-	// 4. 释放 dstr 对象
-	dstr_free(&effect_text);
+	if (frame) {
+		// 门控管内置的三层和自定义光晕层
+		const bool gated = !key.absorb && (key.bloom_radius || key.halation_radius ||
+						   key.secondary_glow_radius || key.extra_glow_layers > 0);
+		// 溅射缓冲是按 A 的阈值和颜色生成的，对比时两侧都逐像素收集
+		const bool sparse = filter->glow_mode == FILM_LOOK_GLOW_SPARSE && !key.compare && !key.absorb;
+		if (gated && !filter->glow_gate)
+			filter->glow_gate = film_look_glow_gate_create();
+		if (filter->glow_gate && !key.absorb) {
+			if (gated) {
+				profile_start(gate_measure_name);
+				film_look_glow_gate_measure(filter->glow_gate, frame, sparse);
+				profile_end(gate_measure_name);
+			}
+			film_look_glow_gate_apply(filter->glow_gate, &filter->params, &key);
+		}
+
+		if (sparse && (key.bloom_radius || key.halation_radius || key.secondary_glow_radius)) {
+			if (!filter->splat)
+				filter->splat = film_look_splat_create();
+			profile_start(splat_name);
+			key.splat = film_look_splat_render(filter->splat, frame, filter->glow_gate, &filter->params,
+							   &key);
+			profile_end(splat_name);
+			filter->splat_active = key.splat;
+		}
+
+		// 逐像素收集的抽头位置不变，只是改从缩小的拷贝采样
+		const bool gathers = !key.splat && (key.bloom_radius || key.halation_radius || key.secondary_glow_radius ||
+						    key.compare_bloom_radius || key.compare_halation_radius ||
+						    key.compare_secondary_glow_radius);
+		if (gathers && filter->glow_source_lod > 0) {
+			profile_start(glow_source_name);
+			filter->glow_source = render_glow_source(filter, frame);
+			profile_end(glow_source_name);
+		}
+		key.glow_source = filter->glow_source != nullptr;
+
+		if (key.extra_glow_layers > 0) {
+			if (!filter->glow_pyramid)
+				filter->glow_pyramid = film_look_glow_pyramid_create();
+			profile_start(glow_pyramid_name);
+			if (!film_look_glow_pyramid_render(filter->glow_pyramid, frame,
+							   film_look_glow_pyramid_threshold(&filter->params)))
+				key.extra_glow_layers = 0;
+			profile_end(glow_pyramid_name);
+		}
+	}
+	// 没有画面就没有金字塔
+	if (!frame)
+		key.extra_glow_layers = 0;
+	filter->extra_glow_layers = key.extra_glow_layers;
 
+	gs_effect_t *effect = film_look_effect_get(&key);
+	if (effect == filter->effect)
+		return;
 
+	filter->effect = effect;
 	if (!filter->effect) {
 		blog(LOG_WARNING, "[%s] some ugly shit happening in the shader string", PLUGIN_NAME);
 		return;
 	}
 
 	// 获取所有uniform参数的指针，以便快速访问
-	filter->param_contrast = gs_effect_get_param_by_name(filter->effect, "contrast");
-	filter->param_teal_amount = gs_effect_get_param_by_name(filter->effect, "teal_amount");
-	filter->param_orange_amount = gs_effect_get_param_by_name(filter->effect, "orange_amount");
-	filter->param_bloom_intensity = gs_effect_get_param_by_name(filter->effect, "bloom_intensity");
-	filter->param_bloom_threshold = gs_effect_get_param_by_name(filter->effect, "bloom_threshold");
-	filter->param_bloom_radius = gs_effect_get_param_by_name(filter->effect, "bloom_radius");
-	filter->param_halation_intensity = gs_effect_get_param_by_name(filter->effect, "halation_intensity");
-	filter->param_halation_threshold = gs_effect_get_param_by_name(filter->effect, "halation_threshold");
-	filter->param_halation_radius = gs_effect_get_param_by_name(filter->effect, "halation_radius");
-	filter->param_secondary_glow_intensity =
-		gs_effect_get_param_by_name(filter->effect, "secondary_glow_intensity");
-	filter->param_secondary_glow_threshold =
-		gs_effect_get_param_by_name(filter->effect, "secondary_glow_threshold");
-	filter->param_secondary_glow_radius = gs_effect_get_param_by_name(filter->effect, "secondary_glow_radius");
-	filter->param_grain_intensity = gs_effect_get_param_by_name(filter->effect, "grain_intensity");
-	filter->param_shake_intensity = gs_effect_get_param_by_name(filter->effect, "shake_intensity");
-	filter->param_shake_speed = gs_effect_get_param_by_name(filter->effect, "shake_speed");
-	filter->param_uv_size = gs_effect_get_param_by_name(filter->effect, "uv_size");
-	filter->param_elapsed_time = gs_effect_get_param_by_name(filter->effect, "elapsed_time");
+	filter->param_image = gs_effect_get_param_by_name(filter->effect, "image");
+	filter->param_look_block = gs_effect_get_param_by_name(filter->effect, "look_block");
+	filter->param_frame_block = gs_effect_get_param_by_name(filter->effect, "frame_block");
+	filter->param_film_stock_lut = gs_effect_get_param_by_name(filter->effect, "film_stock_lut");
+	filter->param_compare_film_stock_lut = gs_effect_get_param_by_name(filter->effect, "compare_film_stock_lut");
+	filter->param_upstream_lut = gs_effect_get_param_by_name(filter->effect, "upstream_lut");
+	filter->param_glow_source = gs_effect_get_param_by_name(filter->effect, "glow_source");
+	filter->param_bloom_splat = gs_effect_get_param_by_name(filter->effect, "bloom_splat");
+	filter->param_halation_splat = gs_effect_get_param_by_name(filter->effect, "halation_splat");
+	filter->param_secondary_glow_splat = gs_effect_get_param_by_name(filter->effect, "secondary_glow_splat");
+	filter->param_glow_pyramid = gs_effect_get_param_by_name(filter->effect, "glow_pyramid");
+	filter->param_glow_level_rect = gs_effect_get_param_by_name(filter->effect, "glow_level_rect");
+	filter->param_glow_pyramid_half_texel = gs_effect_get_param_by_name(filter->effect, "glow_pyramid_half_texel");
+	filter->param_glow_layer_color = gs_effect_get_param_by_name(filter->effect, "glow_layer_color");
+	filter->param_glow_layer_shape = gs_effect_get_param_by_name(filter->effect, "glow_layer_shape");
+	filter->param_grain_plate = gs_effect_get_param_by_name(filter->effect, "grain_plate");
+}
+
+// 胶片模拟 LUT 的纹理数据：33^3 个 RGBA16F 格点
+static void bake_stock_texels(int stock, std::vector<uint16_t> &texels)
+{
+	const size_t count = (size_t)FILM_LOOK_STOCK_LUT_SIZE * FILM_LOOK_STOCK_LUT_SIZE * FILM_LOOK_STOCK_LUT_SIZE;
+	std::vector<float> lut(count * 3);
+	film_look_stock_bake(stock, FILM_LOOK_STOCK_LUT_SIZE, lut.data());
+
+	texels.resize(count * 4);
+	for (size_t i = 0; i < count; i++) {
+		texels[i * 4 + 0] = half_from_float(lut[i * 3 + 0]).u;
+		texels[i * 4 + 1] = half_from_float(lut[i * 3 + 1]).u;
+		texels[i * 4 + 2] = half_from_float(lut[i * 3 + 2]).u;
+		texels[i * 4 + 3] = half_from_float(1.0f).u;
+	}
+}
+
+// 在 CPU 上计算胶片模型并烘焙成 3D 纹理，shader 里每个像素只需一次采样。
+// 烘焙结果按纹理格式存进磁盘缓存，下次启动直接映射文件上传。
+static gs_texture_t *create_stock_lut(int stock)
+{
+	const uint32_t size = FILM_LOOK_STOCK_LUT_SIZE;
+	const size_t texel_bytes = (size_t)size * size * size * 4 * sizeof(uint16_t);
+	const uint32_t key_fields[4] = {(uint32_t)stock, size, GS_RGBA16F, FILM_LOOK_STOCK_MODEL_VERSION};
+	const uint64_t key = film_look_cache_hash(key_fields, sizeof(key_fields), 0);
+
+	std::vector<uint16_t> texels;
+	size_t cached_size = 0;
+	struct film_look_cache_entry *cached = film_look_cache_open("stock", key);
+	const uint8_t *data = cached ? static_cast<const uint8_t *>(film_look_cache_data(cached, &cached_size))
+				     : nullptr;
+
+	if (!data || cached_size != texel_bytes) {
+		bake_stock_texels(stock, texels);
+		film_look_cache_store("stock", key, texels.data(), texel_bytes);
+		data = reinterpret_cast<const uint8_t *>(texels.data());
+	}
+
+	gs_texture_t *texture = gs_voltexture_create(size, size, size, GS_RGBA16F, 1, &data, 0);
+	film_look_cache_close(cached);
+
+	if (!texture)
+		blog(LOG_WARNING, "[%s] failed to create film stock LUT texture", PLUGIN_NAME);
+	return texture;
+}
+
+// 同一个预设的 LUT 在所有实例之间共享，最后一个引用放开时销毁。
+// 只在图形上下文中访问，图形锁把访问串行化了。
+struct shared_stock_lut {
+	gs_texture_t *texture;
+	long refs;
+};
+
+static struct shared_stock_lut shared_stock_luts[FILM_LOOK_STOCK_COUNT];
+
+// lut / lut_id 是实例持有的一个引用（A 的或对比用的 B 的）
+static void release_stock_lut(gs_texture_t **lut, int *lut_id)
+{
+	if (*lut) {
+		struct shared_stock_lut &shared = shared_stock_luts[*lut_id];
+		if (--shared.refs == 0) {
+			gs_voltexture_destroy(shared.texture);
+			shared.texture = nullptr;
+		}
+	}
+	*lut = nullptr;
+	*lut_id = FILM_LOOK_STOCK_NONE;
+}
+
+// 换预设时取共享的 LUT，第一个用到这个预设的实例负责烘焙（或从磁盘缓存加载）
+static void update_stock_lut(gs_texture_t **lut, int *lut_id, int stock)
+{
+	if (stock <= FILM_LOOK_STOCK_NONE || stock >= FILM_LOOK_STOCK_COUNT)
+		stock = FILM_LOOK_STOCK_NONE;
+
+	if (stock == *lut_id && (stock == FILM_LOOK_STOCK_NONE || *lut))
+		return;
+
+	obs_enter_graphics();
+	release_stock_lut(lut, lut_id);
+	if (stock != FILM_LOOK_STOCK_NONE) {
+		struct shared_stock_lut &shared = shared_stock_luts[stock];
+		if (!shared.texture)
+			shared.texture = create_stock_lut(stock);
+		if (shared.texture) {
+			shared.refs++;
+			*lut = shared.texture;
+		}
+	}
+	obs_leave_graphics();
+
+	*lut_id = stock;
+}
+
+// 颗粒包最多占 32MB 显存，同一个文件在所有实例之间共享一份，最后一个引用放开时销毁。
+// 和 LUT 一样只在图形上下文中访问
+typedef std::pair<std::string, int64_t> grain_pack_key;
+
+struct shared_grain_pack {
+	struct film_look_grain_pack *pack;
+	long refs;
+};
+
+static std::map<grain_pack_key, shared_grain_pack> shared_grain_packs;
+
+// 放开实例持有的引用，同时清掉记下的路径，下次 update_grain_pack 会重新取
+static void release_grain_pack(struct film_look_data *filter)
+{
+	if (filter->grain_pack) {
+		auto found = shared_grain_packs.find(grain_pack_key(filter->grain_pack_path, filter->grain_pack_mtime));
+		if (found != shared_grain_packs.end() && --found->second.refs == 0) {
+			film_look_grain_pack_destroy(found->second.pack);
+			shared_grain_packs.erase(found);
+		}
+	}
+	filter->grain_pack = nullptr;
+	bfree(filter->grain_pack_path);
+	filter->grain_pack_path = nullptr;
 }
 
 // 当滤镜实例被创建时调用
@@ -296,10 +555,10 @@ static void *film_look_create(obs_data_t *settings, obs_source_t *source)
 	struct film_look_data *filter = static_cast<struct film_look_data *>(bzalloc(sizeof(struct film_look_data)));
 	filter->context = source;
 	filter->total_elapsed_time = 0.0f;
+	pthread_mutex_init(&filter->mutex, nullptr);
+	os_atomic_inc_long(&film_look_instances);
 
-	// 立即加载effect
-	update_effect(filter);
-
+	// effect 不在这里创建：大多数场景在一次会话里根本不会显示
 	// 从设置加载初始值
 	obs_source_update(source, settings);
 
@@ -312,54 +571,369 @@ static void film_look_destroy(void *data)
 	auto *filter = static_cast<struct film_look_data *>(data);
 
 	obs_enter_graphics();
-	if (filter->effect) {
-		gs_effect_destroy(filter->effect);
-	}
+	release_stock_lut(&filter->stock_lut, &filter->stock_lut_id);
+	release_stock_lut(&filter->compare_stock_lut, &filter->compare_stock_lut_id);
+	gs_voltexture_destroy(filter->upstream_lut);
+	gs_texrender_destroy(filter->input);
+	film_look_glow_gate_destroy(filter->glow_gate);
+	film_look_splat_destroy(filter->splat);
+	film_look_glow_pyramid_destroy(filter->glow_pyramid);
+	film_look_dust_destroy(filter->dust);
+	for (gs_texrender_t *level : filter->glow_source_levels)
+		gs_texrender_destroy(level);
+	release_grain_pack(filter);
+	if (os_atomic_dec_long(&film_look_instances) == 0)
+		film_look_effect_free_all();
 	obs_leave_graphics();
 
+	film_look_absorb_destroy(filter->absorb);
+	bfree(filter->grain_pack_setting);
+	pthread_mutex_destroy(&filter->mutex);
 	bfree(filter);
 }
 
-// 当用户在UI中更改设置时调用
+// 吸收的滤镜链变化后重新烘焙。链很短，直接在 CPU 上逐格点计算
+static void update_upstream_lut(struct film_look_data *filter)
+{
+	if (!filter->upstream_lut_stale)
+		return;
+	filter->upstream_lut_stale = false;
+
+	const uint32_t size = FILM_LOOK_STOCK_LUT_SIZE;
+	const size_t count = (size_t)size * size * size;
+	std::vector<uint16_t> texels;
+
+	if (filter->absorb && film_look_absorb_count(filter->absorb)) {
+		std::vector<float> lut(count * 3);
+		film_look_absorb_bake(filter->absorb, size, lut.data());
+
+		texels.resize(count * 4);
+		for (size_t i = 0; i < count; i++) {
+			texels[i * 4 + 0] = half_from_float(lut[i * 3 + 0]).u;
+			texels[i * 4 + 1] = half_from_float(lut[i * 3 + 1]).u;
+			texels[i * 4 + 2] = half_from_float(lut[i * 3 + 2]).u;
+			texels[i * 4 + 3] = half_from_float(1.0f).u;
+		}
+	}
+
+	obs_enter_graphics();
+	gs_voltexture_destroy(filter->upstream_lut);
+	filter->upstream_lut = nullptr;
+	if (!texels.empty()) {
+		const uint8_t *data = reinterpret_cast<const uint8_t *>(texels.data());
+		filter->upstream_lut = gs_voltexture_create(size, size, size, GS_RGBA16F, 1, &data, 0);
+		if (!filter->upstream_lut)
+			blog(LOG_WARNING, "[%s] failed to create absorbed filter LUT texture", PLUGIN_NAME);
+	}
+	obs_leave_graphics();
+}
+
+// 颗粒包路径变化时换成共享的包，第一个用到这个文件的实例负责加载
+static void update_grain_pack(struct film_look_data *filter, const char *path)
+{
+	if (filter->grain_pack_path && strcmp(filter->grain_pack_path, path) == 0)
+		return;
+
+	release_grain_pack(filter);
+	filter->grain_pack_path = bstrdup(path);
+
+	struct stat st;
+	if (!*path || os_stat(path, &st) != 0)
+		return;
+
+	// 文件被替换后新加载的实例拿到新内容，还在用旧内容的实例继续持有旧的那份
+	const grain_pack_key key(path, (int64_t)st.st_mtime);
+	struct shared_grain_pack &shared = shared_grain_packs[key];
+	if (!shared.pack)
+		shared.pack = film_look_grain_pack_load(path);
+	if (!shared.pack) {
+		shared_grain_packs.erase(key);
+		return;
+	}
+
+	shared.refs++;
+	filter->grain_pack = shared.pack;
+	filter->grain_pack_mtime = key.second;
+}
+
+// 创建或更新所有 GPU 资源。调用前需要已经 obs_enter_graphics 并持有 mutex
+static void ensure_resources(struct film_look_data *filter)
+{
+	update_effect(filter, nullptr, false);
+
+	update_stock_lut(&filter->stock_lut, &filter->stock_lut_id, filter->params.film_stock);
+	update_stock_lut(&filter->compare_stock_lut, &filter->compare_stock_lut_id,
+			 filter->compare_enabled ? filter->compare_params.film_stock : FILM_LOOK_STOCK_NONE);
+	update_upstream_lut(filter);
+	update_grain_pack(filter, filter->grain_pack_setting ? filter->grain_pack_setting : "");
+	pack_look_block(filter);
+
+	filter->loaded = true;
+	filter->dirty = false;
+}
+
+// 同上，释放后下次 render / show 会重新创建
+static void release_resources(struct film_look_data *filter)
+{
+	// effect 变体是模块共享的，这里只放开引用
+	filter->effect = nullptr;
+	gs_texrender_destroy(filter->input);
+	filter->input = nullptr;
+	film_look_glow_gate_destroy(filter->glow_gate);
+	filter->glow_gate = nullptr;
+	film_look_splat_destroy(filter->splat);
+	filter->splat = nullptr;
+	film_look_glow_pyramid_destroy(filter->glow_pyramid);
+	filter->glow_pyramid = nullptr;
+	film_look_dust_destroy(filter->dust);
+	filter->dust = nullptr;
+	for (gs_texrender_t *&level : filter->glow_source_levels) {
+		gs_texrender_destroy(level);
+		level = nullptr;
+	}
+	filter->glow_source = nullptr;
+	release_stock_lut(&filter->stock_lut, &filter->stock_lut_id);
+	release_stock_lut(&filter->compare_stock_lut, &filter->compare_stock_lut_id);
+	gs_voltexture_destroy(filter->upstream_lut);
+	filter->upstream_lut = nullptr;
+	filter->upstream_lut_stale = true;
+	release_grain_pack(filter);
+
+	filter->loaded = false;
+}
+
+// 在渲染线程之外提前创建资源（show 回调和节目 / 预览场景预热）
+static void load_resources(struct film_look_data *filter)
+{
+	obs_enter_graphics();
+	pthread_mutex_lock(&filter->mutex);
+	if (!filter->loaded || filter->dirty)
+		ensure_resources(filter);
+	filter->hidden_time = 0.0f;
+	pthread_mutex_unlock(&filter->mutex);
+	obs_leave_graphics();
+}
+
+// 预设 B 存在设置里的 compare_look 对象中，键名和外观参数相同，缺的键取默认值
+static void load_compare_settings(struct film_look_data *filter, obs_data_t *settings)
+{
+	filter->compare_enabled = obs_data_get_bool(settings, "compare_enabled");
+	filter->compare_mode = (int)obs_data_get_int(settings, "compare_mode");
+	filter->compare_position = (float)obs_data_get_double(settings, "compare_position");
+	filter->compare_angle = (float)obs_data_get_double(settings, "compare_angle");
+
+	obs_data_t *look = obs_data_get_obj(settings, "compare_look");
+	if (!look)
+		look = obs_data_create();
+	film_look_params_defaults(look);
+	film_look_params_load(&filter->compare_params, look);
+	obs_data_release(look);
+}
+
+static void load_dust_settings(struct film_look_data *filter, obs_data_t *settings)
+{
+	struct film_look_dust_settings *dust = &filter->dust_settings;
+	dust->dust_rate = (float)obs_data_get_double(settings, "dust_amount");
+	dust->scratch_rate = (float)obs_data_get_double(settings, "scratch_amount");
+	dust->hair_rate = (float)obs_data_get_double(settings, "hair_amount");
+	dust->opacity = (float)obs_data_get_double(settings, "dust_opacity");
+	dust->seed = (uint32_t)obs_data_get_int(settings, "dust_seed");
+	filter->dust_enabled = obs_data_get_bool(settings, "dust_enabled") && dust->opacity > 0.0f &&
+			       (dust->dust_rate > 0.0f || dust->scratch_rate > 0.0f || dust->hair_rate > 0.0f);
+}
+
+// 当用户在UI中更改设置时调用。这里只记录设置，烘焙和加载留给下一次渲染
 static void film_look_update(void *data, obs_data_t *settings)
 {
 	auto *filter = static_cast<struct film_look_data *>(data);
 
-	filter->contrast = (float)obs_data_get_double(settings, "contrast");
-	filter->teal_amount = (float)obs_data_get_double(settings, "teal_amount");
-	filter->orange_amount = (float)obs_data_get_double(settings, "orange_amount");
-	filter->bloom_intensity = (float)obs_data_get_double(settings, "bloom_intensity");
-	filter->bloom_threshold = (float)obs_data_get_double(settings, "bloom_threshold");
-	filter->bloom_radius = (int)obs_data_get_int(settings, "bloom_radius");
-	filter->halation_intensity = (float)obs_data_get_double(settings, "halation_intensity");
-	filter->halation_threshold = (float)obs_data_get_double(settings, "halation_threshold");
-	filter->halation_radius = (int)obs_data_get_int(settings, "halation_radius");
-	filter->secondary_glow_intensity = (float)obs_data_get_double(settings, "secondary_glow_intensity");
-	filter->secondary_glow_threshold = (float)obs_data_get_double(settings, "secondary_glow_threshold");
-	filter->secondary_glow_radius = (int)obs_data_get_int(settings, "secondary_glow_radius");
-	filter->grain_intensity = (float)obs_data_get_double(settings, "grain_intensity");
-	filter->shake_intensity = (float)obs_data_get_double(settings, "shake_intensity");
-	filter->shake_speed = (float)obs_data_get_double(settings, "shake_speed");
+	pthread_mutex_lock(&filter->mutex);
+	film_look_params_load(&filter->params, settings);
+	bfree(filter->grain_pack_setting);
+	filter->grain_pack_setting = bstrdup(obs_data_get_string(settings, "grain_pack"));
+	filter->prewarm = obs_data_get_bool(settings, "prewarm");
+	filter->glow_mode = (int)obs_data_get_int(settings, "glow_mode");
+	filter->glow_source_lod =
+		std::clamp((int)obs_data_get_int(settings, "glow_source_lod"), 0, FILM_LOOK_GLOW_SOURCE_MAX_LOD);
+	filter->absorb_enabled = obs_data_get_bool(settings, "absorb_color_filters");
+	filter->absorb_scan_time = 0.0f;
+	load_compare_settings(filter, settings);
+	load_dust_settings(filter, settings);
+	filter->dirty = true;
+	pthread_mutex_unlock(&filter->mutex);
+}
+
+static void film_look_show(void *data)
+{
+	auto *filter = static_cast<struct film_look_data *>(data);
+	filter->shown = true;
+	load_resources(filter);
+}
+
+static void film_look_hide(void *data)
+{
+	auto *filter = static_cast<struct film_look_data *>(data);
+	filter->shown = false;
+}
+
+bool film_look_filter_is_instance(obs_source_t *source)
+{
+	const char *id = obs_source_get_unversioned_id(source);
+	return id && strcmp(id, film_look_filter.id) == 0;
+}
+
+void film_look_filter_prewarm(obs_source_t *source)
+{
+	if (!film_look_filter_is_instance(source))
+		return;
+
+	auto *filter = static_cast<struct film_look_data *>(obs_obj_get_data(source));
+	if (filter && filter->prewarm)
+		load_resources(filter);
+}
+
+void film_look_filter_publish(obs_source_t *source, const struct film_look_params *params)
+{
+	auto *filter = static_cast<struct film_look_data *>(obs_obj_get_data(source));
+	if (!filter)
+		return;
+
+	pthread_mutex_lock(&filter->mutex);
+	filter->params = *params;
+	filter->dirty = true;
+	pthread_mutex_unlock(&filter->mutex);
 }
 
 // 设置默认值
 static void film_look_defaults(obs_data_t *settings)
 {
-	obs_data_set_default_double(settings, "contrast", 1.2);
-	obs_data_set_default_double(settings, "teal_amount", 0.2);
-	obs_data_set_default_double(settings, "orange_amount", 0.15);
-	obs_data_set_default_double(settings, "bloom_intensity", 0.5);
-	obs_data_set_default_double(settings, "bloom_threshold", 0.8);
-	obs_data_set_default_int(settings, "bloom_radius", 2);
-	obs_data_set_default_double(settings, "halation_intensity", 0.4);
-	obs_data_set_default_double(settings, "halation_threshold", 0.95);
-	obs_data_set_default_int(settings, "halation_radius", 4);
-	obs_data_set_default_double(settings, "secondary_glow_intensity", 0.3);
-	obs_data_set_default_double(settings, "secondary_glow_threshold", 0.75);
-	obs_data_set_default_int(settings, "secondary_glow_radius", 3);
-	obs_data_set_default_double(settings, "grain_intensity", 0.04);
-	obs_data_set_default_double(settings, "shake_intensity", 0.002);
-	obs_data_set_default_double(settings, "shake_speed", 5.0);
+	film_look_params_defaults(settings);
+	obs_data_set_default_int(settings, "lut_export_size", 33);
+	obs_data_set_default_bool(settings, "prewarm", true);
+	obs_data_set_default_int(settings, "glow_mode", FILM_LOOK_GLOW_GATHER);
+	obs_data_set_default_int(settings, "glow_source_lod", 0);
+	obs_data_set_default_bool(settings, "absorb_color_filters", false);
+	obs_data_set_default_bool(settings, "dust_enabled", false);
+	obs_data_set_default_double(settings, "dust_amount", 4.0);
+	obs_data_set_default_double(settings, "scratch_amount", 0.5);
+	obs_data_set_default_double(settings, "hair_amount", 0.25);
+	obs_data_set_default_double(settings, "dust_opacity", 0.8);
+	obs_data_set_default_int(settings, "dust_seed", 1);
+	obs_data_set_default_bool(settings, "compare_enabled", false);
+	obs_data_set_default_int(settings, "compare_mode", FILM_LOOK_COMPARE_WIPE);
+	obs_data_set_default_double(settings, "compare_position", 0.5);
+	obs_data_set_default_double(settings, "compare_angle", 0.0);
+}
+
+// 把当前的调色部分（对比度 + 青橙 + 胶片模拟）导出为 .cube，供硬件 LUT 盒和剪辑软件使用
+static bool film_look_export_lut_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(property);
+	auto *filter = static_cast<struct film_look_data *>(data);
+
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	const char *path = obs_data_get_string(settings, "lut_export_path");
+	uint32_t size = (uint32_t)obs_data_get_int(settings, "lut_export_size");
+
+	// 烘焙要好一会儿，拷一份参数再放开锁，不挡住渲染线程
+	pthread_mutex_lock(&filter->mutex);
+	const struct film_look_params params = filter->params;
+	pthread_mutex_unlock(&filter->mutex);
+
+	if (film_look_lut_export_cube(&params, size, path))
+		blog(LOG_INFO, "[%s] exported %u^3 grade LUT to %s", PLUGIN_NAME, size, path);
+	else
+		blog(LOG_WARNING, "[%s] failed to export grade LUT to '%s'", PLUGIN_NAME, path);
+
+	obs_data_release(settings);
+	return false;
+}
+
+// 把当前的外观存成预设 B，之后调整 A 时可以和它对比
+static bool film_look_compare_capture_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(property);
+	auto *filter = static_cast<struct film_look_data *>(data);
+
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	obs_data_t *look = obs_data_create();
+	pthread_mutex_lock(&filter->mutex);
+	film_look_params_save(&filter->params, look);
+	pthread_mutex_unlock(&filter->mutex);
+	obs_data_set_obj(settings, "compare_look", look);
+	obs_data_release(look);
+	obs_data_release(settings);
+
+	obs_source_update(filter->context, nullptr);
+	return false;
+}
+
+// 交换 A 和预设 B：A 的外观参数写进 compare_look，B 的写回滤镜设置
+static bool film_look_compare_swap_clicked(obs_properties_t *props, obs_property_t *property, void *data)
+{
+	UNUSED_PARAMETER(props);
+	UNUSED_PARAMETER(property);
+	auto *filter = static_cast<struct film_look_data *>(data);
+
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	obs_data_t *look = obs_data_create();
+	struct film_look_params b;
+	pthread_mutex_lock(&filter->mutex);
+	film_look_params_save(&filter->params, look);
+	b = filter->compare_params;
+	pthread_mutex_unlock(&filter->mutex);
+
+	film_look_params_save(&b, settings);
+	obs_data_set_obj(settings, "compare_look", look);
+	obs_data_release(look);
+	obs_data_release(settings);
+
+	obs_source_update(filter->context, nullptr);
+	return true;
+}
+
+static void add_glow_layer_group(obs_properties_t *props, int index)
+{
+	obs_properties_t *group = obs_properties_create();
+	char key[64];
+	char name[64];
+
+	snprintf(key, sizeof(key), "glow_layer_%d_threshold", index + 1);
+	obs_properties_add_float_slider(group, key, obs_module_text("FilmLook.GlowLayer.Threshold"), 0.0, 1.0, 0.01);
+	snprintf(key, sizeof(key), "glow_layer_%d_tint", index + 1);
+	obs_properties_add_color(group, key, obs_module_text("FilmLook.GlowLayer.Tint"));
+	snprintf(key, sizeof(key), "glow_layer_%d_radius", index + 1);
+	obs_properties_add_float_slider(group, key, obs_module_text("FilmLook.GlowLayer.Radius"), 2.0, 128.0, 1.0);
+	snprintf(key, sizeof(key), "glow_layer_%d_intensity", index + 1);
+	obs_properties_add_float_slider(group, key, obs_module_text("FilmLook.GlowLayer.Intensity"), 0.0, 4.0, 0.05);
+	snprintf(key, sizeof(key), "glow_layer_%d_blend", index + 1);
+	obs_property_t *blend = obs_properties_add_list(group, key, obs_module_text("FilmLook.GlowLayer.Blend"),
+							OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(blend, obs_module_text("FilmLook.GlowLayer.Blend.Add"), FILM_LOOK_GLOW_BLEND_ADD);
+	obs_property_list_add_int(blend, obs_module_text("FilmLook.GlowLayer.Blend.Screen"),
+				  FILM_LOOK_GLOW_BLEND_SCREEN);
+	obs_property_list_add_int(blend, obs_module_text("FilmLook.GlowLayer.Blend.Lighten"),
+				  FILM_LOOK_GLOW_BLEND_LIGHTEN);
+
+	snprintf(key, sizeof(key), "glow_layer_%d", index + 1);
+	snprintf(name, sizeof(name), obs_module_text("FilmLook.GlowLayer"), index + 1);
+	obs_properties_add_group(props, key, name, OBS_GROUP_NORMAL, group);
+}
+
+// 只显示前 glow_layer_count 个光晕层
+static bool glow_layer_count_modified(obs_properties_t *props, obs_property_t *property, obs_data_t *settings)
+{
+	UNUSED_PARAMETER(property);
+	const int count = (int)obs_data_get_int(settings, "glow_layer_count");
+	char key[64];
+
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++) {
+		snprintf(key, sizeof(key), "glow_layer_%d", i + 1);
+		obs_property_set_visible(obs_properties_get(props, key), i < count);
+	}
+	return true;
 }
 
 // 定义用户UI
@@ -372,6 +946,13 @@ static obs_properties_t *film_look_properties(void *data)
 	obs_properties_add_float_slider(props, "orange_amount", obs_module_text("FilmLook.OrangeAmount"), 0.0, 1.0,
 					0.01);
 
+	obs_property_t *stock = obs_properties_add_list(props, "film_stock", obs_module_text("FilmLook.FilmStock"),
+							OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	for (int i = FILM_LOOK_STOCK_NONE; i < FILM_LOOK_STOCK_COUNT; i++)
+		obs_property_list_add_int(stock, obs_module_text(film_look_stock_text_key(i)), i);
+	obs_properties_add_float_slider(props, "film_stock_strength", obs_module_text("FilmLook.FilmStockStrength"),
+					0.0, 1.0, 0.01);
+
 	obs_properties_add_float_slider(props, "bloom_intensity", obs_module_text("FilmLook.BloomIntensity"), 0.0, 4.0,
 					0.05);
 	obs_properties_add_float_slider(props, "bloom_threshold", obs_module_text("FilmLook.BloomThreshold"), 0.3, 1.0,
@@ -391,22 +972,158 @@ static obs_properties_t *film_look_properties(void *data)
 	obs_properties_add_int_slider(props, "secondary_glow_radius", obs_module_text("FilmLook.SecondaryGlowRadius"),
 				      1, 7, 1);
 
+	obs_property_t *glow_mode = obs_properties_add_list(props, "glow_mode", obs_module_text("FilmLook.GlowMode"),
+							    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(glow_mode, obs_module_text("FilmLook.GlowMode.Gather"), FILM_LOOK_GLOW_GATHER);
+	obs_property_list_add_int(glow_mode, obs_module_text("FilmLook.GlowMode.Sparse"), FILM_LOOK_GLOW_SPARSE);
+	obs_property_t *glow_source = obs_properties_add_list(props, "glow_source_lod",
+							      obs_module_text("FilmLook.GlowSource"), OBS_COMBO_TYPE_LIST,
+							      OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(glow_source, obs_module_text("FilmLook.GlowSource.Full"), 0);
+	obs_property_list_add_int(glow_source, obs_module_text("FilmLook.GlowSource.Half"), 1);
+	obs_property_list_add_int(glow_source, obs_module_text("FilmLook.GlowSource.Quarter"), 2);
+
+	obs_property_t *layer_count = obs_properties_add_int_slider(
+		props, "glow_layer_count", obs_module_text("FilmLook.GlowLayerCount"), 0, FILM_LOOK_MAX_GLOW_LAYERS, 1);
+	obs_property_set_modified_callback(layer_count, glow_layer_count_modified);
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++)
+		add_glow_layer_group(props, i);
+
 	obs_properties_add_float_slider(props, "grain_intensity", obs_module_text("FilmLook.GrainIntensity"), 0.0, 0.2,
 					0.005);
+	obs_properties_add_path(props, "grain_pack", obs_module_text("FilmLook.GrainPack"), OBS_PATH_FILE,
+				"Grain pack (*.flgp)", nullptr);
 
 	obs_properties_add_float_slider(props, "shake_intensity", obs_module_text("FilmLook.ShakeIntensity"), 0.0, 0.02,
 					0.0005);
 	obs_properties_add_float_slider(props, "shake_speed", obs_module_text("FilmLook.ShakeSpeed"), 0.0, 20.0, 0.5);
 
+	obs_properties_t *dust = obs_properties_create();
+	obs_properties_add_float_slider(dust, "dust_amount", obs_module_text("FilmLook.Dust.Amount"), 0.0, 40.0, 0.5);
+	obs_properties_add_float_slider(dust, "scratch_amount", obs_module_text("FilmLook.Dust.Scratches"), 0.0, 4.0,
+					0.05);
+	obs_properties_add_float_slider(dust, "hair_amount", obs_module_text("FilmLook.Dust.Hairs"), 0.0, 2.0, 0.05);
+	obs_properties_add_float_slider(dust, "dust_opacity", obs_module_text("FilmLook.Dust.Opacity"), 0.0, 1.0, 0.01);
+	obs_properties_add_int(dust, "dust_seed", obs_module_text("FilmLook.Dust.Seed"), 0, 999999, 1);
+	obs_properties_add_group(props, "dust_enabled", obs_module_text("FilmLook.Dust"), OBS_GROUP_CHECKABLE, dust);
+
+	obs_properties_t *compare = obs_properties_create();
+	obs_property_t *compare_mode = obs_properties_add_list(compare, "compare_mode",
+							       obs_module_text("FilmLook.Compare.Mode"),
+							       OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(compare_mode, obs_module_text("FilmLook.Compare.Mode.Wipe"), FILM_LOOK_COMPARE_WIPE);
+	obs_property_list_add_int(compare_mode, obs_module_text("FilmLook.Compare.Mode.Split"),
+				  FILM_LOOK_COMPARE_SPLIT);
+	obs_properties_add_float_slider(compare, "compare_position", obs_module_text("FilmLook.Compare.Position"), 0.0,
+					1.0, 0.01);
+	obs_properties_add_float_slider(compare, "compare_angle", obs_module_text("FilmLook.Compare.Angle"), -90.0,
+					90.0, 1.0);
+	obs_properties_add_button(compare, "compare_capture", obs_module_text("FilmLook.Compare.Capture"),
+				  film_look_compare_capture_clicked);
+	obs_properties_add_button(compare, "compare_swap", obs_module_text("FilmLook.Compare.Swap"),
+				  film_look_compare_swap_clicked);
+	obs_properties_add_group(props, "compare_enabled", obs_module_text("FilmLook.Compare"), OBS_GROUP_CHECKABLE,
+				 compare);
+
+	obs_properties_add_bool(props, "prewarm", obs_module_text("FilmLook.Prewarm"));
+	obs_property_t *absorb = obs_properties_add_bool(props, "absorb_color_filters",
+							 obs_module_text("FilmLook.AbsorbColorFilters"));
+	obs_property_set_long_description(absorb, obs_module_text("FilmLook.AbsorbColorFilters.Description"));
+
+	obs_properties_add_path(props, "lut_export_path", obs_module_text("FilmLook.LutExportPath"), OBS_PATH_FILE_SAVE,
+				"Cube LUT (*.cube)", nullptr);
+	obs_property_t *lut_size = obs_properties_add_list(props, "lut_export_size",
+							   obs_module_text("FilmLook.LutExportSize"), OBS_COMBO_TYPE_LIST,
+							   OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(lut_size, "33", 33);
+	obs_property_list_add_int(lut_size, "65", 65);
+	obs_properties_add_button(props, "export_lut", obs_module_text("FilmLook.ExportLut"),
+				  film_look_export_lut_clicked);
+
 	UNUSED_PARAMETER(data);
 	return props;
 }
 
+// 定期检查前面的滤镜链。滤镜本身被关掉或者关闭吸收时把上游滤镜还回去
+static void update_absorb(struct film_look_data *filter, float seconds)
+{
+	pthread_mutex_lock(&filter->mutex);
+	if (!filter->absorb_enabled || !obs_source_enabled(filter->context)) {
+		if (filter->absorb) {
+			const bool absorbed = film_look_absorb_count(filter->absorb) > 0;
+			film_look_absorb_restore(filter->absorb);
+			if (absorbed) {
+				filter->upstream_lut_stale = true;
+				filter->dirty = true;
+			}
+		}
+	} else {
+		filter->absorb_scan_time -= seconds;
+		if (filter->absorb_scan_time <= 0.0f) {
+			filter->absorb_scan_time = FILM_LOOK_ABSORB_SCAN_SEC;
+			if (!filter->absorb)
+				filter->absorb = film_look_absorb_create();
+			if (film_look_absorb_scan(filter->absorb, filter->context)) {
+				filter->upstream_lut_stale = true;
+				filter->dirty = true;
+			}
+		}
+	}
+	pthread_mutex_unlock(&filter->mutex);
+}
+
 // 在每一视频帧更新时调用
 static void film_look_tick(void *data, float seconds)
 {
 	auto *filter = static_cast<struct film_look_data *>(data);
 	filter->total_elapsed_time += seconds;
+	update_absorb(filter, seconds);
+
+	if (!filter->loaded || filter->shown)
+		return;
+
+	filter->hidden_time += seconds;
+	if (filter->hidden_time < FILM_LOOK_RELEASE_AFTER_SEC)
+		return;
+
+	obs_enter_graphics();
+	pthread_mutex_lock(&filter->mutex);
+	release_resources(filter);
+	pthread_mutex_unlock(&filter->mutex);
+	obs_leave_graphics();
+}
+
+// 把滤镜目标渲染到 filter->input，做法和 obs_source_process_filter_begin 相同
+static gs_texture_t *capture_target(struct film_look_data *filter, obs_source_t *target, obs_source_t *parent,
+				    uint32_t width, uint32_t height)
+{
+	if (!filter->input)
+		filter->input = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+	gs_texrender_reset(filter->input);
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	if (gs_texrender_begin(filter->input, width, height)) {
+		uint32_t parent_flags = obs_source_get_output_flags(target);
+		bool custom_draw = (parent_flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
+		bool async = (parent_flags & OBS_SOURCE_ASYNC) != 0;
+		struct vec4 clear_color;
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+
+		if (target == parent && !custom_draw && !async)
+			obs_source_default_render(target);
+		else
+			obs_source_video_render(target);
+
+		gs_texrender_end(filter->input);
+	}
+
+	gs_blend_state_pop();
+	return gs_texrender_get_texture(filter->input);
 }
 
 // 渲染每一帧时调用
@@ -415,37 +1132,91 @@ static void film_look_render(void *data, gs_effect_t *effect)
 	UNUSED_PARAMETER(effect);
 	auto *filter = static_cast<struct film_look_data *>(data);
 	obs_source_t *target = obs_filter_get_target(filter->context);
+	obs_source_t *parent = obs_filter_get_parent(filter->context);
 	uint32_t width = obs_source_get_width(target);
 	uint32_t height = obs_source_get_height(target);
 	struct vec2 uv_size = {(float)width, (float)height};
 
-	if (!filter->effect || !target) {
+	if (!target || !parent || !width || !height) {
+		obs_source_skip_video_filter(filter->context);
+		return;
+	}
+
+	pthread_mutex_lock(&filter->mutex);
+	if (!filter->loaded || filter->dirty)
+		ensure_resources(filter);
+	filter->hidden_time = 0.0f;
+
+	gs_texture_t *frame = nullptr;
+	if (filter->effect) {
+		if (frame_wanted(filter)) {
+			profile_start(capture_name);
+			frame = capture_target(filter, target, parent, width, height);
+			profile_end(capture_name);
+		}
+		update_effect(filter, frame, true);
+	}
+
+	if (!filter->effect) {
+		pthread_mutex_unlock(&filter->mutex);
 		obs_source_skip_video_filter(filter->context);
 		return;
 	}
 
-	if (obs_source_process_filter_begin(filter->context, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-
-		gs_effect_set_float(filter->param_contrast, filter->contrast);
-		gs_effect_set_float(filter->param_teal_amount, filter->teal_amount);
-		gs_effect_set_float(filter->param_orange_amount, filter->orange_amount);
-		gs_effect_set_float(filter->param_bloom_intensity, filter->bloom_intensity);
-		gs_effect_set_float(filter->param_bloom_threshold, filter->bloom_threshold);
-		gs_effect_set_int(filter->param_bloom_radius, filter->bloom_radius);
-		gs_effect_set_float(filter->param_halation_intensity, filter->halation_intensity);
-		gs_effect_set_float(filter->param_halation_threshold, filter->halation_threshold);
-		gs_effect_set_int(filter->param_halation_radius, filter->halation_radius);
-		gs_effect_set_float(filter->param_secondary_glow_intensity, filter->secondary_glow_intensity);
-		gs_effect_set_float(filter->param_secondary_glow_threshold, filter->secondary_glow_threshold);
-		gs_effect_set_int(filter->param_secondary_glow_radius, filter->secondary_glow_radius);
-		gs_effect_set_float(filter->param_grain_intensity, filter->grain_intensity);
-		gs_effect_set_float(filter->param_shake_intensity, filter->shake_intensity);
-		gs_effect_set_float(filter->param_shake_speed, filter->shake_speed);
-		gs_effect_set_vec2(filter->param_uv_size, &uv_size);
-		gs_effect_set_float(filter->param_elapsed_time, filter->total_elapsed_time);
-
-		obs_source_process_filter_end(filter->context, filter->effect, 0, 0);
+	// 没有截取画面（或者截取失败）时由 OBS 直接用 effect 绘制目标，能省掉一次整帧拷贝
+	if (!frame && !obs_source_process_filter_begin(filter->context, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+		pthread_mutex_unlock(&filter->mutex);
+		return;
+	}
+
+	profile_start(upload_params_name);
+	gs_effect_set_val(filter->param_look_block, filter->look_block, sizeof(filter->look_block));
+	set_frame_block(filter, uv_size.x, uv_size.y);
+	gs_effect_set_texture(filter->param_film_stock_lut, filter->stock_lut);
+	gs_effect_set_texture(filter->param_upstream_lut, filter->upstream_lut);
+	if (filter->compare_enabled)
+		gs_effect_set_texture(filter->param_compare_film_stock_lut, filter->compare_stock_lut);
+	if (filter->splat_active) {
+		gs_effect_set_texture(filter->param_bloom_splat, film_look_splat_texture(filter->splat, 0));
+		gs_effect_set_texture(filter->param_halation_splat, film_look_splat_texture(filter->splat, 1));
+		gs_effect_set_texture(filter->param_secondary_glow_splat, film_look_splat_texture(filter->splat, 2));
 	}
+	if (filter->extra_glow_layers > 0)
+		set_glow_layer_params(filter);
+	profile_end(upload_params_name);
+
+	if (filter->glow_source)
+		gs_effect_set_texture(filter->param_glow_source, filter->glow_source);
+
+	const bool linear_srgb = gs_get_linear_srgb();
+	const bool previous = gs_framebuffer_srgb_enabled();
+	profile_start(main_pass_name);
+	if (frame) {
+		gs_enable_framebuffer_srgb(linear_srgb);
+		if (linear_srgb)
+			gs_effect_set_texture_srgb(filter->param_image, frame);
+		else
+			gs_effect_set_texture(filter->param_image, frame);
+
+		while (gs_effect_loop(filter->effect, "Draw"))
+			gs_draw_sprite(frame, 0, width, height);
+	} else {
+		// process_filter_end 自己设置 image 和帧缓冲的 sRGB 状态
+		obs_source_process_filter_end(filter->context, filter->effect, width, height);
+		gs_enable_framebuffer_srgb(linear_srgb);
+	}
+	profile_end(main_pass_name);
+
+	if (filter->dust_enabled) {
+		if (!filter->dust)
+			filter->dust = film_look_dust_create();
+		profile_start(dust_name);
+		film_look_dust_render(filter->dust, &filter->dust_settings, filter->total_elapsed_time, width, height);
+		profile_end(dust_name);
+	}
+	gs_enable_framebuffer_srgb(previous);
+
+	pthread_mutex_unlock(&filter->mutex);
 }
 
 // 滤镜定义结构体
@@ -461,4 +1232,6 @@ struct obs_source_info film_look_filter = {
 	.get_properties = film_look_properties,
 	.video_render = film_look_render,
 	.video_tick = film_look_tick,
+	.show = film_look_show,
+	.hide = film_look_hide,
 };
@@ -6,8 +6,19 @@
 extern "C" {
 #endif
 
+	struct film_look_params;
+
 	extern struct obs_source_info film_look_filter;
 
+	bool film_look_filter_is_instance(obs_source_t *source);
+
+	// 如果 source 是开启了预热的胶片外观滤镜，提前创建它的 effect 和纹理
+	void film_look_filter_prewarm(obs_source_t *source);
+
+	// 把已经解析好的外观参数直接换给实例，不经过 obs_source_update。
+	// 批量应用外观时在同一个图形任务里对所有目标调用，新外观在同一帧生效。
+	void film_look_filter_publish(obs_source_t *source, const struct film_look_params *params);
+
 #ifdef __cplusplus
 }
 #endif
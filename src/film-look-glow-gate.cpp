@@ -0,0 +1,277 @@
+#include "film-look-glow-gate.h"
+#include "film-look-glow-pyramid.h"
+
+#include <graphics/vec2.h>
+#include <graphics/vec4.h>
+
+#include <algorithm>
+#include <cstring>
+
+// 归约到不超过这个尺寸就停下来，剩下的在 CPU 上取最大值
+#define GATE_READBACK_SIZE 32
+#define GATE_MAX_LEVELS 4
+
+// 阈值减去余量后仍然达不到才算“不可能出光晕”：归约晚一帧，画面可能在变亮
+#define GATE_MARGIN 0.02f
+// 连续这么多帧达不到阈值才关掉，避免在阈值附近来回切换变体
+#define GATE_HOLD_FRAMES 8
+// 内置的三层加上共用一个阈值（最低的那个）的自定义光晕层
+#define GATE_LAYERS 4
+
+// 所有层都亮着时隔这么多帧才重新测量一次（这期间滤镜可以不截取画面）；
+// 超过这个间隔没有测量，旧的结果就不再可信
+#define GATE_RECHECK_FRAMES 15
+
+struct film_look_glow_gate {
+	gs_texrender_t *levels[GATE_MAX_LEVELS];
+
+	// 两个读回缓冲交替使用：这一帧写一个，读上一帧写的另一个，不会等 GPU
+	gs_stagesurf_t *stage[2];
+	bool staged[2];
+	int current;
+
+	// 第一级（8x8 格子）的读回，同样两个交替
+	gs_stagesurf_t *cell_stage[2];
+	bool cell_staged[2];
+	float *cells;
+	size_t cells_capacity;
+	uint32_t cells_width;
+	uint32_t cells_height;
+	bool cells_valid;
+
+	int unmeasured_frames; // 上次 measure 之后 apply 了几次
+	bool valid;
+	float max_luma;
+	int quiet_frames[GATE_LAYERS];
+};
+
+struct film_look_glow_gate *film_look_glow_gate_create(void)
+{
+	auto *gate = static_cast<struct film_look_glow_gate *>(bzalloc(sizeof(struct film_look_glow_gate)));
+	for (int i = 0; i < GATE_MAX_LEVELS; i++)
+		gate->levels[i] = gs_texrender_create(GS_R32F, GS_ZS_NONE);
+	return gate;
+}
+
+void film_look_glow_gate_destroy(struct film_look_glow_gate *gate)
+{
+	if (!gate)
+		return;
+
+	for (int i = 0; i < GATE_MAX_LEVELS; i++)
+		gs_texrender_destroy(gate->levels[i]);
+	gs_stagesurface_destroy(gate->stage[0]);
+	gs_stagesurface_destroy(gate->stage[1]);
+	gs_stagesurface_destroy(gate->cell_stage[0]);
+	gs_stagesurface_destroy(gate->cell_stage[1]);
+	bfree(gate->cells);
+	bfree(gate);
+}
+
+static gs_texture_t *reduce_level(gs_effect_t *effect, const char *technique, gs_texrender_t *level,
+				  gs_texture_t *source, uint32_t *width, uint32_t *height)
+{
+	const uint32_t out_width = (*width + 7) / 8;
+	const uint32_t out_height = (*height + 7) / 8;
+
+	gs_texrender_reset(level);
+	if (!gs_texrender_begin(level, out_width, out_height))
+		return nullptr;
+
+	struct vec2 source_size = {(float)*width, (float)*height};
+	struct vec2 target_size = {(float)out_width, (float)out_height};
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), source);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "source_size"), &source_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "target_size"), &target_size);
+
+	gs_ortho(0.0f, (float)out_width, 0.0f, (float)out_height, -100.0f, 100.0f);
+	while (gs_effect_loop(effect, technique))
+		gs_draw_sprite(source, 0, out_width, out_height);
+	gs_texrender_end(level);
+
+	*width = out_width;
+	*height = out_height;
+	return gs_texrender_get_texture(level);
+}
+
+static void read_back(struct film_look_glow_gate *gate, int index)
+{
+	gs_stagesurf_t *stage = gate->stage[index];
+	uint8_t *data;
+	uint32_t linesize;
+
+	if (!gate->staged[index] || !gs_stagesurface_map(stage, &data, &linesize))
+		return;
+
+	const uint32_t width = gs_stagesurface_get_width(stage);
+	const uint32_t height = gs_stagesurface_get_height(stage);
+	float max_luma = 0.0f;
+	for (uint32_t y = 0; y < height; y++) {
+		const float *row = reinterpret_cast<const float *>(data + (size_t)y * linesize);
+		max_luma = std::max(max_luma, *std::max_element(row, row + width));
+	}
+	gs_stagesurface_unmap(stage);
+
+	gate->staged[index] = false;
+	gate->max_luma = max_luma;
+	gate->valid = true;
+}
+
+static void read_back_cells(struct film_look_glow_gate *gate, int index)
+{
+	gs_stagesurf_t *stage = gate->cell_stage[index];
+	uint8_t *data;
+	uint32_t linesize;
+
+	if (!gate->cell_staged[index] || !gs_stagesurface_map(stage, &data, &linesize))
+		return;
+
+	const uint32_t width = gs_stagesurface_get_width(stage);
+	const uint32_t height = gs_stagesurface_get_height(stage);
+	const size_t count = (size_t)width * height;
+	if (count > gate->cells_capacity) {
+		bfree(gate->cells);
+		gate->cells = static_cast<float *>(bmalloc(count * sizeof(float)));
+		gate->cells_capacity = count;
+	}
+
+	for (uint32_t y = 0; y < height; y++)
+		memcpy(gate->cells + (size_t)y * width, data + (size_t)y * linesize, width * sizeof(float));
+	gs_stagesurface_unmap(stage);
+
+	gate->cell_staged[index] = false;
+	gate->cells_width = width;
+	gate->cells_height = height;
+	gate->cells_valid = true;
+}
+
+static void stage_cells(struct film_look_glow_gate *gate, int index, gs_texture_t *cells)
+{
+	const uint32_t width = gs_texture_get_width(cells);
+	const uint32_t height = gs_texture_get_height(cells);
+	gs_stagesurf_t *stage = gate->cell_stage[index];
+
+	if (!stage || gs_stagesurface_get_width(stage) != width || gs_stagesurface_get_height(stage) != height) {
+		gs_stagesurface_destroy(stage);
+		gate->cell_stage[index] = stage = gs_stagesurface_create(width, height, GS_R32F);
+	}
+
+	if (stage) {
+		gs_stage_texture(stage, cells);
+		gate->cell_staged[index] = true;
+	}
+}
+
+void film_look_glow_gate_measure(struct film_look_glow_gate *gate, gs_texture_t *frame, bool want_cells)
+{
+	gs_effect_t *effect = film_look_effect_get_reduce();
+	if (!effect || !frame)
+		return;
+
+	uint32_t width = gs_texture_get_width(frame);
+	uint32_t height = gs_texture_get_height(frame);
+	gs_texture_t *level = frame;
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	for (int i = 0; i < GATE_MAX_LEVELS && level; i++) {
+		level = reduce_level(effect, i == 0 ? "Luma" : "Max", gate->levels[i], level, &width, &height);
+		if (width <= GATE_READBACK_SIZE && height <= GATE_READBACK_SIZE)
+			break;
+	}
+	gs_blend_state_pop();
+
+	if (!level)
+		return;
+
+	const int cur = gate->current;
+	if (want_cells) {
+		stage_cells(gate, cur, gs_texrender_get_texture(gate->levels[0]));
+		read_back_cells(gate, cur ^ 1);
+	} else {
+		gate->cell_staged[0] = gate->cell_staged[1] = false;
+		gate->cells_valid = false;
+	}
+
+	gs_stagesurf_t *stage = gate->stage[cur];
+	if (!stage || gs_stagesurface_get_width(stage) != width || gs_stagesurface_get_height(stage) != height) {
+		gs_stagesurface_destroy(stage);
+		gate->stage[cur] = stage = gs_stagesurface_create(width, height, GS_R32F);
+	}
+
+	if (stage) {
+		gs_stage_texture(stage, level);
+		gate->staged[cur] = true;
+	}
+
+	read_back(gate, cur ^ 1);
+	gate->current = cur ^ 1;
+	gate->unmeasured_frames = 0;
+}
+
+void film_look_glow_gate_poll(struct film_look_glow_gate *gate)
+{
+	// measure 之后 current 已经翻转，最近一次提交的是 current ^ 1
+	read_back(gate, gate->current ^ 1);
+}
+
+bool film_look_glow_gate_wants_frame(const struct film_look_glow_gate *gate, const struct film_look_effect_key *key)
+{
+	if (!gate->valid || gate->unmeasured_frames >= GATE_RECHECK_FRAMES)
+		return true;
+
+	// 有层接近阈值或者已经关掉了：每帧测量，画面一变亮就能重新打开
+	const int active[GATE_LAYERS] = {key->bloom_radius, key->halation_radius, key->secondary_glow_radius,
+					 key->extra_glow_layers};
+	for (int i = 0; i < GATE_LAYERS; i++) {
+		if (active[i] > 0 && gate->quiet_frames[i] > 0)
+			return true;
+	}
+	return false;
+}
+
+static void gate_layer(struct film_look_glow_gate *gate, int index, float threshold, int *radius)
+{
+	int &quiet = gate->quiet_frames[index];
+
+	if (*radius == 0) {
+		quiet = GATE_HOLD_FRAMES;
+		return;
+	}
+
+	if (!gate->valid || gate->max_luma >= threshold - GATE_MARGIN)
+		quiet = 0;
+	else if (quiet < GATE_HOLD_FRAMES)
+		quiet++;
+
+	if (quiet >= GATE_HOLD_FRAMES)
+		*radius = 0;
+}
+
+const float *film_look_glow_gate_cells(const struct film_look_glow_gate *gate, uint32_t *width, uint32_t *height)
+{
+	if (!gate->cells_valid)
+		return nullptr;
+
+	*width = gate->cells_width;
+	*height = gate->cells_height;
+	return gate->cells;
+}
+
+void film_look_glow_gate_apply(struct film_look_glow_gate *gate, const struct film_look_params *params,
+			       struct film_look_effect_key *key)
+{
+	// 太久没测量（比如光晕关了一阵），旧的结果不能再用
+	if (++gate->unmeasured_frames > GATE_RECHECK_FRAMES) {
+		gate->valid = false;
+		gate->staged[0] = gate->staged[1] = false;
+		gate->cells_valid = false;
+		gate->cell_staged[0] = gate->cell_staged[1] = false;
+	}
+
+	gate_layer(gate, 0, params->bloom_threshold, &key->bloom_radius);
+	gate_layer(gate, 1, params->halation_threshold, &key->halation_radius);
+	gate_layer(gate, 2, params->secondary_glow_threshold, &key->secondary_glow_radius);
+	// 自定义层的亮部按最低的阈值提取，这个阈值都达不到时整个金字塔都是黑的
+	gate_layer(gate, 3, film_look_glow_pyramid_threshold(params), &key->extra_glow_layers);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "film-look-effect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 根据画面的最大亮度关掉不可能出光晕的层。
+// 在 GPU 上把画面归约成几个像素的最大亮度，异步读回，晚一帧使用。
+struct film_look_glow_gate;
+
+// 以下函数都需要在图形上下文中调用
+struct film_look_glow_gate *film_look_glow_gate_create(void);
+void film_look_glow_gate_destroy(struct film_look_glow_gate *gate);
+
+// 提交这一帧的归约，并读取上一帧提交的结果。
+// want_cells 时同时读回第一级（每 8x8 像素一个格子的最大亮度），供稀疏光晕使用。
+void film_look_glow_gate_measure(struct film_look_glow_gate *gate, gs_texture_t *frame, bool want_cells);
+
+// 这一帧没有 measure 时调用：取回上一次提交的归约结果
+void film_look_glow_gate_poll(struct film_look_glow_gate *gate);
+
+// 这一帧需不需要 measure。所有层都稳定地亮着时只隔一段时间测量一次，
+// 返回 false 时滤镜可以不截取画面，直接渲染
+bool film_look_glow_gate_wants_frame(const struct film_look_glow_gate *gate, const struct film_look_effect_key *key);
+
+// 上一帧的格子亮度，没有时返回 NULL
+const float *film_look_glow_gate_cells(const struct film_look_glow_gate *gate, uint32_t *width, uint32_t *height);
+
+// 把阈值达不到的层在 key 里的半径置 0（留一点余量，熄灭前等几帧）。
+// 自定义光晕层按其中最低的阈值整体处理，达不到时 extra_glow_layers 置 0
+void film_look_glow_gate_apply(struct film_look_glow_gate *gate, const struct film_look_params *params,
+			       struct film_look_effect_key *key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,132 @@
+#include "film-look-glow-pyramid.h"
+#include "film-look-effect.h"
+
+#include <graphics/vec2.h>
+
+#include <algorithm>
+
+struct film_look_glow_pyramid {
+	gs_texrender_t *levels[FILM_LOOK_GLOW_PYRAMID_LEVELS];
+	gs_texrender_t *atlas;
+	struct vec4 rects[FILM_LOOK_GLOW_PYRAMID_LEVELS];
+};
+
+struct film_look_glow_pyramid *film_look_glow_pyramid_create(void)
+{
+	auto *pyramid = static_cast<struct film_look_glow_pyramid *>(bzalloc(sizeof(struct film_look_glow_pyramid)));
+	for (int i = 0; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++)
+		pyramid->levels[i] = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+	pyramid->atlas = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+	return pyramid;
+}
+
+void film_look_glow_pyramid_destroy(struct film_look_glow_pyramid *pyramid)
+{
+	if (!pyramid)
+		return;
+
+	for (int i = 0; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++)
+		gs_texrender_destroy(pyramid->levels[i]);
+	gs_texrender_destroy(pyramid->atlas);
+	bfree(pyramid);
+}
+
+gs_texture_t *film_look_glow_pyramid_texture(const struct film_look_glow_pyramid *pyramid)
+{
+	return gs_texrender_get_texture(pyramid->atlas);
+}
+
+const struct vec4 *film_look_glow_pyramid_rects(const struct film_look_glow_pyramid *pyramid)
+{
+	return pyramid->rects;
+}
+
+static gs_texture_t *render_level(gs_effect_t *effect, const char *technique, gs_texrender_t *level,
+				  gs_texture_t *source, bool srgb, uint32_t width, uint32_t height)
+{
+	gs_texrender_reset(level);
+	if (!gs_texrender_begin(level, width, height))
+		return nullptr;
+
+	struct vec2 texel_size = {1.0f / (float)gs_texture_get_width(source),
+				  1.0f / (float)gs_texture_get_height(source)};
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	if (srgb)
+		gs_effect_set_texture_srgb(image, source);
+	else
+		gs_effect_set_texture(image, source);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "texel_size"), &texel_size);
+
+	gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+	while (gs_effect_loop(effect, technique))
+		gs_draw_sprite(source, 0, width, height);
+	gs_texrender_end(level);
+
+	return gs_texrender_get_texture(level);
+}
+
+bool film_look_glow_pyramid_render(struct film_look_glow_pyramid *pyramid, gs_texture_t *frame, float threshold)
+{
+	gs_effect_t *effect = film_look_effect_get_pyramid();
+	if (!effect || !frame)
+		return false;
+
+	uint32_t widths[FILM_LOOK_GLOW_PYRAMID_LEVELS];
+	uint32_t heights[FILM_LOOK_GLOW_PYRAMID_LEVELS];
+	uint32_t width = gs_texture_get_width(frame);
+	uint32_t height = gs_texture_get_height(frame);
+	for (int i = 0; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++) {
+		width = std::max((width + 1) / 2, 1u);
+		height = std::max((height + 1) / 2, 1u);
+		widths[i] = width;
+		heights[i] = height;
+	}
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "threshold"), threshold);
+	gs_texture_t *level = render_level(effect, "BrightPass", pyramid->levels[0], frame, gs_get_linear_srgb(),
+					   widths[0], heights[0]);
+	for (int i = 1; i < FILM_LOOK_GLOW_PYRAMID_LEVELS && level; i++)
+		level = render_level(effect, "Downsample", pyramid->levels[i], level, false, widths[i], heights[i]);
+
+	// 第 0 级放在左边，其余各级在右边从上往下排
+	const uint32_t atlas_width = widths[0] + widths[1];
+	uint32_t column_height = 0;
+	for (int i = 1; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++)
+		column_height += heights[i];
+	const uint32_t atlas_height = std::max(heights[0], column_height);
+
+	gs_texrender_reset(pyramid->atlas);
+	bool ok = level && gs_texrender_begin(pyramid->atlas, atlas_width, atlas_height);
+	if (ok) {
+		struct vec4 clear_color;
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)atlas_width, 0.0f, (float)atlas_height, -100.0f, 100.0f);
+
+		uint32_t y = 0;
+		for (int i = 0; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++) {
+			const uint32_t x = i == 0 ? 0 : widths[0];
+			const uint32_t top = i == 0 ? 0 : y;
+			if (i > 0)
+				y += heights[i];
+
+			vec4_set(&pyramid->rects[i], (float)x / (float)atlas_width, (float)top / (float)atlas_height,
+				 (float)widths[i] / (float)atlas_width, (float)heights[i] / (float)atlas_height);
+
+			gs_texture_t *tex = gs_texrender_get_texture(pyramid->levels[i]);
+			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex);
+			gs_matrix_push();
+			gs_matrix_translate3f((float)x, (float)top, 0.0f);
+			while (gs_effect_loop(effect, "Copy"))
+				gs_draw_sprite(tex, 0, widths[i], heights[i]);
+			gs_matrix_pop();
+		}
+		gs_texrender_end(pyramid->atlas);
+	}
+
+	gs_blend_state_pop();
+	return ok;
+}
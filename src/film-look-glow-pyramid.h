@@ -0,0 +1,58 @@
+#pragma once
+
+#include "film-look-params.h"
+
+#include <graphics/graphics.h>
+#include <graphics/vec4.h>
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 金字塔级数：第 i 级是画面的 1 / 2^(i+1)，最高一级对应约 128 像素的光晕半径
+#define FILM_LOOK_GLOW_PYRAMID_LEVELS 6
+
+// 自定义光晕层共用的亮部金字塔。所有层只做一次亮部提取和缩小，
+// 各级紧挨着拼在一张纹理里，每层在合成时按半径在相邻两级之间插值。
+// 采样时把坐标限制在这一级向内缩半个纹素的范围里，双线性不会读到相邻的一级。
+struct film_look_glow_pyramid;
+
+// 以下函数都需要在图形上下文中调用
+struct film_look_glow_pyramid *film_look_glow_pyramid_create(void);
+void film_look_glow_pyramid_destroy(struct film_look_glow_pyramid *pyramid);
+
+// 用 threshold（通常是所有层里最低的阈值）提取亮部并生成各级
+bool film_look_glow_pyramid_render(struct film_look_glow_pyramid *pyramid, gs_texture_t *frame, float threshold);
+
+gs_texture_t *film_look_glow_pyramid_texture(const struct film_look_glow_pyramid *pyramid);
+
+// 每一级在拼接纹理里的位置：xy 偏移, zw 缩放（uv），共 FILM_LOOK_GLOW_PYRAMID_LEVELS 个
+const struct vec4 *film_look_glow_pyramid_rects(const struct film_look_glow_pyramid *pyramid);
+
+// 以下两个不需要图形上下文，离线工具按同样的规则模拟金字塔
+
+// 像素半径对应的（小数）级。第 i 级每个像素覆盖 2^(i+1) 个画面像素，模糊半径大致相同
+static inline float film_look_glow_pyramid_level(float radius)
+{
+	const float level = log2f(radius > 1.0f ? radius : 1.0f) - 1.0f;
+	const float top = (float)(FILM_LOOK_GLOW_PYRAMID_LEVELS - 1);
+	return level < 0.0f ? 0.0f : level > top ? top : level;
+}
+
+// 强度大于 0 的自定义光晕层里最低的阈值，共用的亮部按它提取；没有这样的层时为 1
+static inline float film_look_glow_pyramid_threshold(const struct film_look_params *params)
+{
+	float threshold = 1.0f;
+	for (int i = 0; i < params->glow_layer_count; i++) {
+		const struct film_look_glow_layer *layer = &params->glow_layers[i];
+		if (layer->intensity > 0.0f && layer->threshold < threshold)
+			threshold = layer->threshold;
+	}
+	return threshold;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+#include "film-look-grain.h"
+#include "film-look-mmap.h"
+
+#include "plugin-support.h"
+
+#include <obs.h>
+#include <graphics/graphics.h>
+#include <util/bmem.h>
+
+#include <algorithm>
+#include <cstring>
+
+struct film_look_grain_pack {
+	gs_texture_t *frames[FILM_LOOK_GRAIN_MAX_FRAMES];
+	uint32_t frame_count;
+	uint32_t width;
+	uint32_t height;
+	float fps;
+};
+
+static bool header_valid(const struct film_look_grain_header *header, size_t file_size)
+{
+	if (header->magic != FILM_LOOK_GRAIN_MAGIC || header->version != FILM_LOOK_GRAIN_VERSION ||
+	    header->format != FILM_LOOK_GRAIN_FORMAT_DXT1)
+		return false;
+	if (header->width < 4 || header->height < 4 || header->width % 4 != 0 || header->height % 4 != 0 ||
+	    header->width > FILM_LOOK_GRAIN_MAX_SIZE || header->height > FILM_LOOK_GRAIN_MAX_SIZE)
+		return false;
+	if (header->frame_count == 0 || header->frame_count > FILM_LOOK_GRAIN_MAX_FRAMES)
+		return false;
+	if (!(header->fps > 0.0f && header->fps <= 240.0f))
+		return false;
+
+	const uint64_t frames = film_look_grain_frame_bytes(header->width, header->height) * header->frame_count;
+	return sizeof(struct film_look_grain_header) + frames <= file_size;
+}
+
+struct film_look_grain_pack *film_look_grain_pack_load(const char *path)
+{
+	struct film_look_mapped_file *file = film_look_mapped_file_open(path);
+	if (!file)
+		return nullptr;
+
+	size_t size = 0;
+	auto *base = static_cast<const uint8_t *>(film_look_mapped_file_data(file, &size));
+	auto *header = reinterpret_cast<const struct film_look_grain_header *>(base);
+
+	if (size < sizeof(*header) || !header_valid(header, size)) {
+		blog(LOG_WARNING, "[%s] '%s' is not a valid grain pack", PLUGIN_NAME, path);
+		film_look_mapped_file_close(file);
+		return nullptr;
+	}
+
+	auto *pack = static_cast<struct film_look_grain_pack *>(bzalloc(sizeof(struct film_look_grain_pack)));
+	pack->width = header->width;
+	pack->height = header->height;
+	pack->fps = header->fps;
+
+	// 映射的块数据直接作为纹理数据上传，上传完就不再需要文件
+	const size_t frame_bytes = (size_t)film_look_grain_frame_bytes(header->width, header->height);
+	const uint8_t *frame = base + sizeof(*header);
+
+	obs_enter_graphics();
+	for (uint32_t i = 0; i < header->frame_count; i++, frame += frame_bytes) {
+		const uint8_t *data = frame;
+		gs_texture_t *tex = gs_texture_create(header->width, header->height, GS_DXT1, 1, &data, 0);
+		if (!tex)
+			break;
+		pack->frames[pack->frame_count++] = tex;
+	}
+	obs_leave_graphics();
+
+	char stock[sizeof(header->stock) + 1] = {0};
+	memcpy(stock, header->stock, sizeof(header->stock));
+	const uint32_t iso = header->iso;
+	film_look_mapped_file_close(file);
+
+	if (!pack->frame_count) {
+		blog(LOG_WARNING, "[%s] failed to create grain textures from '%s'", PLUGIN_NAME, path);
+		bfree(pack);
+		return nullptr;
+	}
+
+	blog(LOG_INFO, "[%s] loaded grain pack '%s' (ISO %u): %u frames of %ux%u", PLUGIN_NAME, stock, iso,
+	     pack->frame_count, pack->width, pack->height);
+	return pack;
+}
+
+void film_look_grain_pack_destroy(struct film_look_grain_pack *pack)
+{
+	if (!pack)
+		return;
+
+	obs_enter_graphics();
+	for (uint32_t i = 0; i < pack->frame_count; i++)
+		gs_texture_destroy(pack->frames[i]);
+	obs_leave_graphics();
+
+	bfree(pack);
+}
+
+gs_texture_t *film_look_grain_pack_frame(const struct film_look_grain_pack *pack, float elapsed_time, float offset[2])
+{
+	const uint32_t tick = (uint32_t)std::max(elapsed_time * pack->fps, 0.0f);
+
+	// 每次换帧时随机移动平铺起点，同一张颗粒帧循环回来时位置也不同
+	uint32_t hash = tick * 0x9e3779b9u;
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	offset[0] = (float)(hash & 0xffff) / 65536.0f;
+	offset[1] = (float)(hash >> 16) / 65536.0f;
+
+	return pack->frames[tick % pack->frame_count];
+}
+
+void film_look_grain_pack_size(const struct film_look_grain_pack *pack, uint32_t *width, uint32_t *height)
+{
+	*width = pack->width;
+	*height = pack->height;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 扫描颗粒包 (.flgp)：同一种胶片、同一个 ISO 的一组可平铺颗粒帧。
+// 每帧是单通道灰度，以 DXT1 存储（4 bit/像素，灰度放在精度最高的 6 位绿色端点里），
+// 文件里的帧数据就是上传纹理用的块数据，映射后直接创建纹理。
+#define FILM_LOOK_GRAIN_MAGIC 0x50474c46 // "FLGP"
+#define FILM_LOOK_GRAIN_VERSION 1
+#define FILM_LOOK_GRAIN_FORMAT_DXT1 1
+
+// 限制帧数和尺寸，保证显存占用固定且很小（最多 64 x 1024^2 x 0.5 字节 = 32MB）
+#define FILM_LOOK_GRAIN_MAX_FRAMES 64
+#define FILM_LOOK_GRAIN_MAX_SIZE 1024
+
+struct film_look_grain_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width; // 4 的倍数
+	uint32_t height;
+	uint32_t frame_count;
+	uint32_t format;
+	float fps;    // 帧序列的播放速度
+	uint32_t iso; // 仅作说明
+	char stock[32];
+};
+
+static_assert(sizeof(struct film_look_grain_header) == 64, "grain pack header is 64 bytes on disk");
+
+// 帧数据从文件头之后紧接着开始，每帧 (width / 4) * (height / 4) 个 8 字节的块
+static inline uint64_t film_look_grain_frame_bytes(uint32_t width, uint32_t height)
+{
+	return (uint64_t)(width / 4) * (height / 4) * 8;
+}
+
+struct film_look_grain_pack;
+struct gs_texture;
+
+// 映射并校验颗粒包，为每一帧创建一张不可变的 DXT1 纹理。内部会进入图形上下文。
+struct film_look_grain_pack *film_look_grain_pack_load(const char *path);
+void film_look_grain_pack_destroy(struct film_look_grain_pack *pack);
+
+// 按时间选出当前帧；offset 是每帧换一个的平铺偏移（单位：颗粒纹理的 uv），
+// 避免同一帧在画面上的重复图样被看出来
+struct gs_texture *film_look_grain_pack_frame(const struct film_look_grain_pack *pack, float elapsed_time,
+					      float offset[2]);
+void film_look_grain_pack_size(const struct film_look_grain_pack *pack, uint32_t *width, uint32_t *height);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+#include "film-look-lut.h"
+
+#include "film-look-cpu.h"
+
+#include "plugin-support.h"
+
+#include <util/platform.h>
+
+#include <cstring>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+static void bake_slices(const struct film_look_params *params, uint32_t size, float *out, uint32_t first,
+			uint32_t step)
+{
+	const float scale = 1.0f / (float)(size - 1);
+
+	for (uint32_t b = first; b < size; b += step) {
+		for (uint32_t g = 0; g < size; g++) {
+			float *dst = out + ((size_t)b * size + g) * size * 3;
+			for (uint32_t r = 0; r < size; r++) {
+				float rgb[3] = {(float)r * scale, (float)g * scale, (float)b * scale};
+				film_look_cpu_grade(params, rgb);
+				dst[r * 3 + 0] = rgb[0];
+				dst[r * 3 + 1] = rgb[1];
+				dst[r * 3 + 2] = rgb[2];
+			}
+		}
+	}
+}
+
+void film_look_lut_bake(const struct film_look_params *params, uint32_t size, float *out)
+{
+	const uint32_t threads = std::clamp(std::thread::hardware_concurrency(), 1u, size);
+
+	std::vector<std::thread> pool;
+	for (uint32_t t = 1; t < threads; t++)
+		pool.emplace_back(bake_slices, params, size, out, t, threads);
+	bake_slices(params, size, out, 0, threads);
+	for (std::thread &thread : pool)
+		thread.join();
+}
+
+bool film_look_lut_export_cube(const struct film_look_params *params, uint32_t size, const char *path)
+{
+	if (size < 2 || !path || !*path)
+		return false;
+
+	std::vector<float> table((size_t)size * size * size * 3);
+	film_look_lut_bake(params, size, table.data());
+
+	FILE *file = os_fopen(path, "wb");
+	if (!file)
+		return false;
+
+	fprintf(file, "TITLE \"Film Look Creator grade\"\n");
+	fprintf(file, "LUT_3D_SIZE %u\n", size);
+	fprintf(file, "DOMAIN_MIN 0.0 0.0 0.0\n");
+	fprintf(file, "DOMAIN_MAX 1.0 1.0 1.0\n\n");
+
+	for (size_t i = 0; i < table.size(); i += 3) {
+		fprintf(file, "%.6f %.6f %.6f\n", std::clamp(table[i + 0], 0.0f, 1.0f),
+			std::clamp(table[i + 1], 0.0f, 1.0f), std::clamp(table[i + 2], 0.0f, 1.0f));
+	}
+
+	bool ok = ferror(file) == 0;
+	ok = fclose(file) == 0 && ok;
+	return ok;
+}
+
+// .cube 里的最大 3D 尺寸，再大的文件基本都是写错了
+#define CUBE_MAX_SIZE 256
+
+float *film_look_lut_load_cube(const char *path, uint32_t *size)
+{
+	FILE *file = os_fopen(path, "rb");
+	if (!file)
+		return nullptr;
+
+	char line[256];
+	uint32_t lut_size = 0;
+	size_t count = 0;
+	size_t expected = 0;
+	float *table = nullptr;
+	bool ok = true;
+
+	while (ok && fgets(line, sizeof(line), file)) {
+		const char *p = line;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '#' || *p == '\r' || *p == '\n' || *p == '\0')
+			continue;
+
+		float r, g, b;
+		if (strncmp(p, "LUT_3D_SIZE", 11) == 0) {
+			ok = !table && sscanf(p + 11, "%u", &lut_size) == 1 && lut_size >= 2 && lut_size <= CUBE_MAX_SIZE;
+			if (ok) {
+				expected = (size_t)lut_size * lut_size * lut_size;
+				table = static_cast<float *>(bmalloc(expected * 3 * sizeof(float)));
+			}
+		} else if (strncmp(p, "DOMAIN_MIN", 10) == 0) {
+			ok = sscanf(p + 10, "%f %f %f", &r, &g, &b) == 3 && r == 0.0f && g == 0.0f && b == 0.0f;
+		} else if (strncmp(p, "DOMAIN_MAX", 10) == 0) {
+			ok = sscanf(p + 10, "%f %f %f", &r, &g, &b) == 3 && r == 1.0f && g == 1.0f && b == 1.0f;
+		} else if (strncmp(p, "LUT_1D_SIZE", 11) == 0) {
+			ok = false;
+		} else if (sscanf(p, "%f %f %f", &r, &g, &b) == 3) {
+			ok = table && count < expected;
+			if (ok) {
+				table[count * 3 + 0] = r;
+				table[count * 3 + 1] = g;
+				table[count * 3 + 2] = b;
+				count++;
+			}
+		}
+		// TITLE 和其他不认识的关键字直接跳过
+	}
+	fclose(file);
+
+	if (!ok || !table || count != expected) {
+		blog(LOG_WARNING, "[%s] unsupported or malformed cube LUT '%s'", PLUGIN_NAME, path);
+		bfree(table);
+		return nullptr;
+	}
+
+	*size = lut_size;
+	return table;
+}
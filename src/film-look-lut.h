@@ -0,0 +1,22 @@
+#pragma once
+
+#include "film-look-params.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 在 size^3 的格点上计算调色阶段，结果按 .cube 的顺序（R 变化最快）写入 out，
+// 每个格点 3 个 float。按蓝色切片分给多个线程。
+void film_look_lut_bake(const struct film_look_params *params, uint32_t size, float *out);
+
+// 烘焙并写出标准 .cube 文件
+bool film_look_lut_export_cube(const struct film_look_params *params, uint32_t size, const char *path);
+
+// 读取 .cube 格式的 3D LUT（定义域必须是 0~1），布局和 film_look_lut_bake 相同。
+// 成功时返回 bmalloc 分配的 size^3 * 3 个 float，失败返回 NULL。
+float *film_look_lut_load_cube(const char *path, uint32_t *size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+#include "film-look-mmap.h"
+
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct film_look_mapped_file {
+	const uint8_t *base;
+	size_t mapped_size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+#ifdef _WIN32
+
+static bool map_file(const char *path, struct film_look_mapped_file *entry)
+{
+	wchar_t *wpath = nullptr;
+	if (!os_utf8_to_wcs_ptr(path, 0, &wpath))
+		return false;
+
+	entry->file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+				  FILE_ATTRIBUTE_NORMAL, nullptr);
+	bfree(wpath);
+	if (entry->file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(entry->file, &size) || size.QuadPart == 0) {
+		CloseHandle(entry->file);
+		return false;
+	}
+
+	entry->mapping = CreateFileMappingW(entry->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!entry->mapping) {
+		CloseHandle(entry->file);
+		return false;
+	}
+
+	entry->base = static_cast<const uint8_t *>(MapViewOfFile(entry->mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!entry->base) {
+		CloseHandle(entry->mapping);
+		CloseHandle(entry->file);
+		return false;
+	}
+
+	entry->mapped_size = (size_t)size.QuadPart;
+	return true;
+}
+
+static void unmap_file(struct film_look_mapped_file *entry)
+{
+	UnmapViewOfFile(entry->base);
+	CloseHandle(entry->mapping);
+	CloseHandle(entry->file);
+}
+
+#else
+
+static bool map_file(const char *path, struct film_look_mapped_file *entry)
+{
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	void *ptr = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+		ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (ptr == MAP_FAILED)
+		return false;
+
+	entry->base = static_cast<const uint8_t *>(ptr);
+	entry->mapped_size = (size_t)st.st_size;
+	return true;
+}
+
+static void unmap_file(struct film_look_mapped_file *entry)
+{
+	munmap(const_cast<uint8_t *>(entry->base), entry->mapped_size);
+}
+
+#endif
+
+struct film_look_mapped_file *film_look_mapped_file_open(const char *path)
+{
+	if (!path || !*path)
+		return nullptr;
+
+	auto *file = static_cast<struct film_look_mapped_file *>(bzalloc(sizeof(struct film_look_mapped_file)));
+	if (!map_file(path, file)) {
+		bfree(file);
+		return nullptr;
+	}
+	return file;
+}
+
+const void *film_look_mapped_file_data(const struct film_look_mapped_file *file, size_t *size)
+{
+	*size = file->mapped_size;
+	return file->base;
+}
+
+void film_look_mapped_file_close(struct film_look_mapped_file *file)
+{
+	if (!file)
+		return;
+
+	unmap_file(file);
+	bfree(file);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 只读映射整个文件（mmap / MapViewOfFile），用于缓存和颗粒包这类
+// 读出来就直接交给纹理上传的数据
+struct film_look_mapped_file;
+
+struct film_look_mapped_file *film_look_mapped_file_open(const char *path);
+const void *film_look_mapped_file_data(const struct film_look_mapped_file *file, size_t *size);
+void film_look_mapped_file_close(struct film_look_mapped_file *file);
+
+#ifdef __cplusplus
+}
+#endif
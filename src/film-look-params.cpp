@@ -0,0 +1,470 @@
+#include "film-look-params.h"
+#include "film-look-stock.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 标量参数表：默认值、obs_data 读写和 JSON 读取都从这里走，新增参数只需要加一行
+enum param_kind {
+	PARAM_FLOAT,
+	PARAM_INT,
+};
+
+// 整数参数（光晕半径、胶片预设）在读入时限制到属性的范围：半径决定编译哪个 shader 变体和
+// 展开多少次采样，脚本或 JSON 传进来的任意值都不能越过滑块的上限。浮点参数超出滑块范围
+// 也能正常计算，不限制
+struct param_field {
+	const char *key;
+	enum param_kind kind;
+	size_t offset;
+	double def;
+	double min;
+	double max;
+};
+
+#define FLOAT_PARAM(name, def) {#name, PARAM_FLOAT, offsetof(struct film_look_params, name), def, -HUGE_VAL, HUGE_VAL}
+#define INT_PARAM(name, def, min, max) {#name, PARAM_INT, offsetof(struct film_look_params, name), def, min, max}
+
+static const struct param_field param_fields[] = {
+	FLOAT_PARAM(contrast, 1.2),
+	FLOAT_PARAM(teal_amount, 0.2),
+	FLOAT_PARAM(orange_amount, 0.15),
+	FLOAT_PARAM(bloom_intensity, 0.5),
+	FLOAT_PARAM(bloom_threshold, 0.8),
+	INT_PARAM(bloom_radius, 2, 1, 5),
+	FLOAT_PARAM(halation_intensity, 0.4),
+	FLOAT_PARAM(halation_threshold, 0.95),
+	INT_PARAM(halation_radius, 4, 2, 8),
+	FLOAT_PARAM(secondary_glow_intensity, 0.3),
+	FLOAT_PARAM(secondary_glow_threshold, 0.75),
+	INT_PARAM(secondary_glow_radius, 3, 1, 7),
+	FLOAT_PARAM(grain_intensity, 0.04),
+	FLOAT_PARAM(shake_intensity, 0.002),
+	FLOAT_PARAM(shake_speed, 5.0),
+	INT_PARAM(film_stock, FILM_LOOK_STOCK_NONE, FILM_LOOK_STOCK_NONE, FILM_LOOK_STOCK_COUNT - 1),
+	FLOAT_PARAM(film_stock_strength, 1.0),
+};
+
+#undef FLOAT_PARAM
+#undef INT_PARAM
+
+#define PARAM_FIELD_COUNT (sizeof(param_fields) / sizeof(param_fields[0]))
+
+// 自定义光晕层用平铺的键名 glow_layer_<n>_<field>，n 从 1 开始
+enum glow_layer_field {
+	GLOW_LAYER_THRESHOLD,
+	GLOW_LAYER_TINT,
+	GLOW_LAYER_RADIUS,
+	GLOW_LAYER_INTENSITY,
+	GLOW_LAYER_BLEND,
+	GLOW_LAYER_FIELD_COUNT,
+};
+
+static const char *const glow_layer_field_names[GLOW_LAYER_FIELD_COUNT] = {
+	"threshold", "tint", "radius", "intensity", "blend",
+};
+
+static const double glow_layer_defaults[GLOW_LAYER_FIELD_COUNT] = {
+	0.8, (double)0xFFFFFFFFu, 16.0, 0.3, FILM_LOOK_GLOW_BLEND_SCREEN,
+};
+
+// 先在 double 上限制范围再转成整数，1e30 这样的值转换才有定义
+static double clamp_value(double val, double min, double max)
+{
+	return val < min ? min : val > max ? max : val;
+}
+
+// 非有限值（obs_data 里也可能出现）保留原值
+static void set_field(struct film_look_params *params, const struct param_field *field, double val)
+{
+	if (!isfinite(val))
+		return;
+
+	char *base = reinterpret_cast<char *>(params) + field->offset;
+	val = clamp_value(val, field->min, field->max);
+	if (field->kind == PARAM_FLOAT)
+		*reinterpret_cast<float *>(base) = (float)val;
+	else
+		*reinterpret_cast<int *>(base) = (int)val;
+}
+
+static int clamp_glow_layer_count(double count)
+{
+	return isfinite(count) ? (int)clamp_value(count, 0.0, FILM_LOOK_MAX_GLOW_LAYERS) : 0;
+}
+
+// 颜色属性是 0xAABBGGRR
+static void set_tint(struct film_look_glow_layer *layer, uint32_t tint)
+{
+	layer->tint[0] = (float)(tint & 0xff) / 255.0f;
+	layer->tint[1] = (float)((tint >> 8) & 0xff) / 255.0f;
+	layer->tint[2] = (float)((tint >> 16) & 0xff) / 255.0f;
+}
+
+// 半径和混合方式限制到属性的范围，和标量参数一样
+static void set_glow_layer_field(struct film_look_glow_layer *layer, int field, double val)
+{
+	if (!isfinite(val))
+		return;
+
+	switch (field) {
+	case GLOW_LAYER_THRESHOLD:
+		layer->threshold = (float)val;
+		break;
+	case GLOW_LAYER_TINT:
+		set_tint(layer, (uint32_t)clamp_value(val, 0.0, (double)UINT32_MAX));
+		break;
+	case GLOW_LAYER_RADIUS:
+		layer->radius = (float)clamp_value(val, 2.0, 128.0);
+		break;
+	case GLOW_LAYER_INTENSITY:
+		layer->intensity = (float)val;
+		break;
+	case GLOW_LAYER_BLEND:
+		layer->blend = (int)clamp_value(val, FILM_LOOK_GLOW_BLEND_ADD, FILM_LOOK_GLOW_BLEND_LIGHTEN);
+		break;
+	}
+}
+
+void film_look_params_default_values(struct film_look_params *params)
+{
+	memset(params, 0, sizeof(*params));
+	for (size_t i = 0; i < PARAM_FIELD_COUNT; i++)
+		set_field(params, &param_fields[i], param_fields[i].def);
+
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++) {
+		for (int f = 0; f < GLOW_LAYER_FIELD_COUNT; f++)
+			set_glow_layer_field(&params->glow_layers[i], f, glow_layer_defaults[f]);
+	}
+}
+
+#ifndef FILM_LOOK_NO_LIBOBS
+
+// 颜色和混合方式在 obs_data 里存成整数
+static bool glow_layer_field_is_int(int field)
+{
+	return field == GLOW_LAYER_TINT || field == GLOW_LAYER_BLEND;
+}
+
+static const char *glow_layer_key(char *buf, size_t size, int index, const char *field)
+{
+	snprintf(buf, size, "glow_layer_%d_%s", index + 1, field);
+	return buf;
+}
+
+static double get_field(const struct film_look_params *params, const struct param_field *field)
+{
+	const char *base = reinterpret_cast<const char *>(params) + field->offset;
+	if (field->kind == PARAM_FLOAT)
+		return *reinterpret_cast<const float *>(base);
+	return *reinterpret_cast<const int *>(base);
+}
+
+static uint32_t get_tint(const struct film_look_glow_layer *layer)
+{
+	return 0xFF000000u | ((uint32_t)(layer->tint[2] * 255.0f + 0.5f) << 16) |
+	       ((uint32_t)(layer->tint[1] * 255.0f + 0.5f) << 8) | (uint32_t)(layer->tint[0] * 255.0f + 0.5f);
+}
+
+// 设置默认值
+void film_look_params_defaults(obs_data_t *settings)
+{
+	for (size_t i = 0; i < PARAM_FIELD_COUNT; i++) {
+		const struct param_field *field = &param_fields[i];
+		if (field->kind == PARAM_FLOAT)
+			obs_data_set_default_double(settings, field->key, field->def);
+		else
+			obs_data_set_default_int(settings, field->key, (long long)field->def);
+	}
+
+	char key[64];
+	obs_data_set_default_int(settings, "glow_layer_count", 0);
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++) {
+		for (int f = 0; f < GLOW_LAYER_FIELD_COUNT; f++) {
+			glow_layer_key(key, sizeof(key), i, glow_layer_field_names[f]);
+			if (glow_layer_field_is_int(f))
+				obs_data_set_default_int(settings, key, (long long)glow_layer_defaults[f]);
+			else
+				obs_data_set_default_double(settings, key, glow_layer_defaults[f]);
+		}
+	}
+}
+
+// 从 obs_data 读取全部参数
+void film_look_params_load(struct film_look_params *params, obs_data_t *settings)
+{
+	for (size_t i = 0; i < PARAM_FIELD_COUNT; i++) {
+		const struct param_field *field = &param_fields[i];
+		set_field(params, field,
+			  field->kind == PARAM_FLOAT ? obs_data_get_double(settings, field->key)
+						     : (double)obs_data_get_int(settings, field->key));
+	}
+
+	char key[64];
+	params->glow_layer_count = clamp_glow_layer_count((double)obs_data_get_int(settings, "glow_layer_count"));
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++) {
+		for (int f = 0; f < GLOW_LAYER_FIELD_COUNT; f++) {
+			glow_layer_key(key, sizeof(key), i, glow_layer_field_names[f]);
+			set_glow_layer_field(&params->glow_layers[i], f,
+					     glow_layer_field_is_int(f) ? (double)obs_data_get_int(settings, key)
+									: obs_data_get_double(settings, key));
+		}
+	}
+}
+
+void film_look_params_save(const struct film_look_params *params, obs_data_t *settings)
+{
+	for (size_t i = 0; i < PARAM_FIELD_COUNT; i++) {
+		const struct param_field *field = &param_fields[i];
+		if (field->kind == PARAM_FLOAT)
+			obs_data_set_double(settings, field->key, get_field(params, field));
+		else
+			obs_data_set_int(settings, field->key, (long long)get_field(params, field));
+	}
+
+	char key[64];
+	obs_data_set_int(settings, "glow_layer_count", params->glow_layer_count);
+	for (int i = 0; i < FILM_LOOK_MAX_GLOW_LAYERS; i++) {
+		const struct film_look_glow_layer *layer = &params->glow_layers[i];
+
+		obs_data_set_double(settings, glow_layer_key(key, sizeof(key), i, "threshold"), layer->threshold);
+		obs_data_set_int(settings, glow_layer_key(key, sizeof(key), i, "tint"), get_tint(layer));
+		obs_data_set_double(settings, glow_layer_key(key, sizeof(key), i, "radius"), layer->radius);
+		obs_data_set_double(settings, glow_layer_key(key, sizeof(key), i, "intensity"), layer->intensity);
+		obs_data_set_int(settings, glow_layer_key(key, sizeof(key), i, "blend"), layer->blend);
+	}
+}
+
+#endif
+
+// 极简 JSON 读取：只认顶层对象里的数字值，其余类型（字符串、布尔、嵌套对象和数组）
+// 校验语法后跳过，这样 OBS 导出的完整滤镜设置也能直接传进来
+struct json_reader {
+	const char *p;
+};
+
+static void json_skip_ws(struct json_reader *r)
+{
+	while (*r->p == ' ' || *r->p == '\t' || *r->p == '\n' || *r->p == '\r')
+		r->p++;
+}
+
+// 读一个字符串；key 不为 NULL 时把内容写进去，含转义或超长时写成空串（不会匹配任何键）
+static bool json_read_string(struct json_reader *r, char *key, size_t size)
+{
+	if (*r->p != '"')
+		return false;
+	r->p++;
+
+	size_t len = 0;
+	bool plain = true;
+	while (*r->p != '"') {
+		if ((unsigned char)*r->p < 0x20)
+			return false;
+		if (*r->p == '\\') {
+			plain = false;
+			r->p++;
+			if (*r->p == 'u') {
+				for (int i = 1; i <= 4; i++) {
+					if (!isxdigit((unsigned char)r->p[i]))
+						return false;
+				}
+				r->p += 4;
+			} else if (!*r->p || !strchr("\"\\/bfnrt", *r->p)) {
+				return false;
+			}
+		} else if (key && len + 1 < size) {
+			key[len++] = *r->p;
+		} else {
+			plain = false;
+		}
+		r->p++;
+	}
+	r->p++;
+
+	if (key)
+		key[plain ? len : 0] = 0;
+	return true;
+}
+
+static bool json_read_number(struct json_reader *r, double *val)
+{
+	// strtod 还接受 inf、nan 和十六进制，JSON 不允许
+	const char c = *r->p;
+	if (c != '-' && (c < '0' || c > '9'))
+		return false;
+
+	// 超出 double 范围的数（1e999）strtod 返回 inf，当作错误
+	char *end;
+	*val = strtod(r->p, &end);
+	if (end == r->p || !isfinite(*val))
+		return false;
+	r->p = end;
+	return true;
+}
+
+static bool json_skip_value(struct json_reader *r, int depth);
+
+static bool json_skip_container(struct json_reader *r, int depth, char close)
+{
+	const bool object = close == '}';
+	r->p++;
+	json_skip_ws(r);
+	if (*r->p == close) {
+		r->p++;
+		return true;
+	}
+
+	for (;;) {
+		if (object) {
+			if (!json_read_string(r, nullptr, 0))
+				return false;
+			json_skip_ws(r);
+			if (*r->p++ != ':')
+				return false;
+			json_skip_ws(r);
+		}
+		if (!json_skip_value(r, depth + 1))
+			return false;
+		json_skip_ws(r);
+		if (*r->p == close) {
+			r->p++;
+			return true;
+		}
+		if (*r->p++ != ',')
+			return false;
+		json_skip_ws(r);
+	}
+}
+
+static bool json_skip_value(struct json_reader *r, int depth)
+{
+	if (depth > 32)
+		return false;
+
+	double val;
+	switch (*r->p) {
+	case '"':
+		return json_read_string(r, nullptr, 0);
+	case '{':
+		return json_skip_container(r, depth, '}');
+	case '[':
+		return json_skip_container(r, depth, ']');
+	case 't':
+		return strncmp(r->p, "true", 4) == 0 ? (r->p += 4, true) : false;
+	case 'f':
+		return strncmp(r->p, "false", 5) == 0 ? (r->p += 5, true) : false;
+	case 'n':
+		return strncmp(r->p, "null", 4) == 0 ? (r->p += 4, true) : false;
+	default:
+		return json_read_number(r, &val);
+	}
+}
+
+// 把一个数字值写到对应的参数上，未知的键忽略
+static void apply_json_number(struct film_look_params *params, const char *key, double val)
+{
+	for (size_t i = 0; i < PARAM_FIELD_COUNT; i++) {
+		if (strcmp(key, param_fields[i].key) == 0) {
+			set_field(params, &param_fields[i], val);
+			return;
+		}
+	}
+
+	if (strcmp(key, "glow_layer_count") == 0) {
+		params->glow_layer_count = clamp_glow_layer_count(val);
+		return;
+	}
+
+	int index, consumed = 0;
+	if (sscanf(key, "glow_layer_%d_%n", &index, &consumed) != 1 || !consumed || index < 1 ||
+	    index > FILM_LOOK_MAX_GLOW_LAYERS)
+		return;
+	for (int f = 0; f < GLOW_LAYER_FIELD_COUNT; f++) {
+		if (strcmp(key + consumed, glow_layer_field_names[f]) == 0) {
+			set_glow_layer_field(&params->glow_layers[index - 1], f, val);
+			return;
+		}
+	}
+}
+
+// 不依赖 libobs，libfilm-look 和独立工具都走这里
+bool film_look_params_load_json(struct film_look_params *params, const char *json)
+{
+	struct film_look_params parsed;
+	film_look_params_default_values(&parsed);
+
+	if (json && *json) {
+		struct json_reader r = {json};
+		json_skip_ws(&r);
+		if (*r.p != '{')
+			return false;
+		r.p++;
+		json_skip_ws(&r);
+
+		if (*r.p == '}') {
+			r.p++;
+		} else {
+			for (;;) {
+				char key[64];
+				if (!json_read_string(&r, key, sizeof(key)))
+					return false;
+				json_skip_ws(&r);
+				if (*r.p++ != ':')
+					return false;
+				json_skip_ws(&r);
+
+				double val;
+				const char c = *r.p;
+				if (c == '-' || (c >= '0' && c <= '9')) {
+					if (!json_read_number(&r, &val))
+						return false;
+					apply_json_number(&parsed, key, val);
+				} else if (!json_skip_value(&r, 1)) {
+					return false;
+				}
+
+				json_skip_ws(&r);
+				if (*r.p == '}') {
+					r.p++;
+					break;
+				}
+				if (*r.p++ != ',')
+					return false;
+				json_skip_ws(&r);
+			}
+		}
+
+		json_skip_ws(&r);
+		if (*r.p)
+			return false;
+	}
+
+	*params = parsed;
+	return true;
+}
+
+// 与 mainImage 里的运行时判断保持一致：某个阶段对输出没有影响时对应位为 0
+uint32_t film_look_params_stage_mask(const struct film_look_params *params)
+{
+	uint32_t mask = 0;
+
+	if (params->bloom_intensity > 0.0f || params->halation_intensity > 0.0f ||
+	    params->secondary_glow_intensity > 0.0f)
+		mask |= FILM_LOOK_STAGE_GLOWS;
+	if (params->contrast != 1.0f || params->teal_amount != 0.0f || params->orange_amount != 0.0f)
+		mask |= FILM_LOOK_STAGE_GRADE;
+	if (params->grain_intensity != 0.0f)
+		mask |= FILM_LOOK_STAGE_GRAIN;
+	if (params->shake_intensity > 0.0f)
+		mask |= FILM_LOOK_STAGE_SHAKE;
+	if (params->film_stock > FILM_LOOK_STOCK_NONE && params->film_stock < FILM_LOOK_STOCK_COUNT &&
+	    params->film_stock_strength > 0.0f)
+		mask |= FILM_LOOK_STAGE_STOCK;
+
+	return mask;
+}
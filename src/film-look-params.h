@@ -0,0 +1,87 @@
+#pragma once
+
+// libfilm-look 不链接 libobs：定义 FILM_LOOK_NO_LIBOBS 时去掉 obs_data 相关的接口
+#ifdef FILM_LOOK_NO_LIBOBS
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#else
+#include <obs-module.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 用户自定义的光晕层上限
+#define FILM_LOOK_MAX_GLOW_LAYERS 8
+
+enum film_look_glow_blend {
+	FILM_LOOK_GLOW_BLEND_ADD = 0,
+	FILM_LOOK_GLOW_BLEND_SCREEN = 1,
+	FILM_LOOK_GLOW_BLEND_LIGHTEN = 2,
+};
+
+// 一个自定义光晕层。和内置的三层不同，这些层不逐像素收集，
+// 而是共用一次亮部提取和一个多级缩小的缓冲，每层在合成时只多几次采样。
+struct film_look_glow_layer {
+	float threshold;
+	float tint[3];
+	float radius; // 像素
+	float intensity;
+	int blend; // enum film_look_glow_blend
+};
+
+// 一个滤镜实例的全部外观参数，标量部分打包成 effect 中的 look_block（见 film-look-effect.h）
+struct film_look_params {
+	float contrast;
+	float teal_amount;
+	float orange_amount;
+	float bloom_intensity;
+	float bloom_threshold;
+	int bloom_radius;
+	float halation_intensity;
+	float halation_threshold;
+	int halation_radius;
+	float secondary_glow_intensity;
+	float secondary_glow_threshold;
+	int secondary_glow_radius;
+	float grain_intensity;
+	float shake_intensity;
+	float shake_speed;
+	int film_stock; // enum film_look_stock_id
+	float film_stock_strength;
+	int glow_layer_count;
+	struct film_look_glow_layer glow_layers[FILM_LOOK_MAX_GLOW_LAYERS];
+};
+
+// mainImage 中可以整体跳过的阶段，CPU 内核按这个位掩码特化
+enum film_look_stage {
+	FILM_LOOK_STAGE_GLOWS = 1 << 0,
+	FILM_LOOK_STAGE_GRADE = 1 << 1,
+	FILM_LOOK_STAGE_GRAIN = 1 << 2,
+	FILM_LOOK_STAGE_SHAKE = 1 << 3,
+	FILM_LOOK_STAGE_STOCK = 1 << 4,
+};
+
+#define FILM_LOOK_STAGE_COUNT 5
+
+// 与 film_look_params_defaults 相同的默认值，直接写进结构体
+void film_look_params_default_values(struct film_look_params *params);
+
+#ifndef FILM_LOOK_NO_LIBOBS
+void film_look_params_defaults(obs_data_t *settings);
+void film_look_params_load(struct film_look_params *params, obs_data_t *settings);
+// film_look_params_load 的反过程：把全部参数写成显式的设置项
+void film_look_params_save(const struct film_look_params *params, obs_data_t *settings);
+#endif
+
+// 供不经过 OBS 设置系统的调用方使用，不依赖 libobs：json 为 NULL 或空串时全部取默认值，
+// 缺省的键取默认值；语法错误或数字超出 double 范围时返回 false，params 不变。
+// 和 film_look_params_load 一样，光晕半径、胶片预设和混合方式限制到属性的范围
+bool film_look_params_load_json(struct film_look_params *params, const char *json);
+uint32_t film_look_params_stage_mask(const struct film_look_params *params);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+#include "film-look-prewarm.h"
+#include "film-look-filter.h"
+
+#include <obs-frontend-api.h>
+
+static void prewarm_source(obs_source_t *source);
+
+static void prewarm_filter(obs_source_t *parent, obs_source_t *child, void *param)
+{
+	UNUSED_PARAMETER(parent);
+	UNUSED_PARAMETER(param);
+	film_look_filter_prewarm(child);
+}
+
+static bool prewarm_item(obs_scene_t *scene, obs_sceneitem_t *item, void *param)
+{
+	UNUSED_PARAMETER(scene);
+	UNUSED_PARAMETER(param);
+	prewarm_source(obs_sceneitem_get_source(item));
+	return true;
+}
+
+// 场景、分组和普通源上的滤镜都要看，嵌套的场景递归进去
+static void prewarm_source(obs_source_t *source)
+{
+	if (!source)
+		return;
+
+	obs_source_enum_filters(source, prewarm_filter, nullptr);
+
+	obs_scene_t *scene = obs_scene_from_source(source);
+	if (!scene)
+		scene = obs_group_from_source(source);
+	if (scene)
+		obs_scene_enum_items(scene, prewarm_item, nullptr);
+}
+
+static void prewarm_scenes(void)
+{
+	obs_source_t *program = obs_frontend_get_current_scene();
+	prewarm_source(program);
+	obs_source_release(program);
+
+	// 只有工作室模式下才有预览场景
+	obs_source_t *preview = obs_frontend_get_current_preview_scene();
+	prewarm_source(preview);
+	obs_source_release(preview);
+}
+
+static void frontend_event(enum obs_frontend_event event, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	switch (event) {
+	case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+	case OBS_FRONTEND_EVENT_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED:
+		prewarm_scenes();
+		break;
+	default:
+		break;
+	}
+}
+
+void film_look_prewarm_init(void)
+{
+	obs_frontend_add_event_callback(frontend_event, nullptr);
+}
+
+void film_look_prewarm_free(void)
+{
+	obs_frontend_remove_event_callback(frontend_event, nullptr);
+}
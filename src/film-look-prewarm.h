@@ -0,0 +1,13 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 跟随前端的节目 / 预览场景切换，提前为其中的胶片外观滤镜创建资源
+void film_look_prewarm_init(void);
+void film_look_prewarm_free(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,276 @@
+#include "film-look-splat.h"
+
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+#include <graphics/vec4.h>
+
+#include <algorithm>
+#include <vector>
+
+#define SPLAT_LAYERS 3
+
+// 每个 8x8 亮格子拆成四个 4x4 的子格子，每个子格子一个四边形（两个三角形）
+#define VERTS_PER_SPRITE 6
+
+struct splat_layer {
+	gs_texrender_t *sums; // 每 4x4 像素一个格子的亮部之和
+	gs_texrender_t *glow; // 全分辨率的光晕缓冲
+	uint32_t first_vert;
+	uint32_t vert_count;
+};
+
+struct film_look_splat {
+	struct splat_layer layers[SPLAT_LAYERS];
+	gs_vertbuffer_t *vb;
+	uint32_t vb_capacity; // 顶点数
+	std::vector<uint8_t> active;
+};
+
+static const float layer_tints[SPLAT_LAYERS][3] = {
+	{1.0f, 1.0f, 1.0f},
+	{1.0f, 0.2f, 0.1f},
+	{0.6f, 0.8f, 1.0f},
+};
+
+struct film_look_splat *film_look_splat_create(void)
+{
+	auto *splat = new film_look_splat();
+	for (struct splat_layer &layer : splat->layers) {
+		layer.sums = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+		layer.glow = gs_texrender_create(GS_RGBA16F, GS_ZS_NONE);
+	}
+	return splat;
+}
+
+void film_look_splat_destroy(struct film_look_splat *splat)
+{
+	if (!splat)
+		return;
+
+	for (struct splat_layer &layer : splat->layers) {
+		gs_texrender_destroy(layer.sums);
+		gs_texrender_destroy(layer.glow);
+	}
+	gs_vertexbuffer_destroy(splat->vb);
+	delete splat;
+}
+
+gs_texture_t *film_look_splat_texture(const struct film_look_splat *splat, int layer)
+{
+	return gs_texrender_get_texture(splat->layers[layer].glow);
+}
+
+static bool reserve_vertices(struct film_look_splat *splat, uint32_t count)
+{
+	if (splat->vb && count <= splat->vb_capacity)
+		return true;
+
+	gs_vertexbuffer_destroy(splat->vb);
+	splat->vb = nullptr;
+
+	const uint32_t capacity = std::max(count + count / 2, (uint32_t)VERTS_PER_SPRITE * 1024);
+	struct gs_vb_data *vbd = gs_vbdata_create();
+	vbd->num = capacity;
+	vbd->points = static_cast<struct vec3 *>(bzalloc(sizeof(struct vec3) * capacity));
+	vbd->num_tex = 1;
+	vbd->tvarray = static_cast<struct gs_tvertarray *>(bzalloc(sizeof(struct gs_tvertarray)));
+	vbd->tvarray[0].width = 4;
+	vbd->tvarray[0].array = bzalloc(sizeof(struct vec4) * capacity);
+
+	splat->vb = gs_vertexbuffer_create(vbd, GS_DYNAMIC);
+	splat->vb_capacity = splat->vb ? capacity : 0;
+	return splat->vb != nullptr;
+}
+
+static void emit_sprite(struct vec3 *points, struct vec4 *cells, uint32_t cx, uint32_t cy, int radius)
+{
+	const float x = (float)(cx * 4);
+	const float y = (float)(cy * 4);
+	const float x0 = x - (float)radius;
+	const float y0 = y - (float)radius;
+	const float x1 = x + 4.0f + (float)radius;
+	const float y1 = y + 4.0f + (float)radius;
+
+	vec3_set(&points[0], x0, y0, 0.0f);
+	vec3_set(&points[1], x1, y0, 0.0f);
+	vec3_set(&points[2], x0, y1, 0.0f);
+	vec3_set(&points[3], x0, y1, 0.0f);
+	vec3_set(&points[4], x1, y0, 0.0f);
+	vec3_set(&points[5], x1, y1, 0.0f);
+
+	for (int i = 0; i < VERTS_PER_SPRITE; i++)
+		vec4_set(&cells[i], x, y, (float)cx, (float)cy);
+}
+
+// 某一层的亮格子：上一帧的格子亮度超过阈值（减去余量），再向外扩一个格子，
+// 覆盖这一帧里亮点移动过来的位置
+static uint32_t mark_active(struct film_look_splat *splat, const float *cells, uint32_t width, uint32_t height,
+			    float threshold)
+{
+	splat->active.assign((size_t)width * height, 0);
+	uint32_t count = 0;
+
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			if (cells[(size_t)y * width + x] < threshold - FILM_LOOK_SPLAT_MARGIN)
+				continue;
+
+			const uint32_t x0 = x > 0 ? x - 1 : 0;
+			const uint32_t y0 = y > 0 ? y - 1 : 0;
+			const uint32_t x1 = std::min(x + 1, width - 1);
+			const uint32_t y1 = std::min(y + 1, height - 1);
+			for (uint32_t ny = y0; ny <= y1; ny++) {
+				for (uint32_t nx = x0; nx <= x1; nx++) {
+					uint8_t &cell = splat->active[(size_t)ny * width + nx];
+					count += cell == 0;
+					cell = 1;
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+static void render_cell_sums(gs_effect_t *effect, struct splat_layer *layer, gs_texture_t *frame, float threshold,
+			     const float tint[3])
+{
+	const uint32_t width = gs_texture_get_width(frame);
+	const uint32_t height = gs_texture_get_height(frame);
+	const uint32_t out_width = (width + 3) / 4;
+	const uint32_t out_height = (height + 3) / 4;
+
+	gs_texrender_reset(layer->sums);
+	if (!gs_texrender_begin(layer->sums, out_width, out_height))
+		return;
+
+	struct vec2 source_size = {(float)width, (float)height};
+	struct vec2 target_size = {(float)out_width, (float)out_height};
+	struct vec3 tint_color;
+	vec3_set(&tint_color, tint[0], tint[1], tint[2]);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), frame);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "source_size"), &source_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "target_size"), &target_size);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "threshold"), threshold);
+	gs_effect_set_vec3(gs_effect_get_param_by_name(effect, "tint"), &tint_color);
+
+	gs_ortho(0.0f, (float)out_width, 0.0f, (float)out_height, -100.0f, 100.0f);
+	while (gs_effect_loop(effect, "CellSum"))
+		gs_draw_sprite(frame, 0, out_width, out_height);
+	gs_texrender_end(layer->sums);
+}
+
+static void render_glow(gs_effect_t *effect, struct splat_layer *layer, gs_vertbuffer_t *vb, uint32_t width,
+			uint32_t height, int radius)
+{
+	gs_texrender_reset(layer->glow);
+	if (!gs_texrender_begin(layer->glow, width, height))
+		return;
+
+	struct vec4 clear_color;
+	vec4_zero(&clear_color);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+
+	if (layer->vert_count) {
+		const float taps = (float)((2 * radius + 1) * (2 * radius + 1));
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "cell_sums"),
+				      gs_texrender_get_texture(layer->sums));
+		gs_effect_set_float(gs_effect_get_param_by_name(effect, "glow_radius"), (float)radius);
+		gs_effect_set_float(gs_effect_get_param_by_name(effect, "inv_tap_count"), 1.0f / taps);
+
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+		gs_load_vertexbuffer(vb);
+		gs_load_indexbuffer(nullptr);
+		while (gs_effect_loop(effect, "Splat"))
+			gs_draw(GS_TRIS, layer->first_vert, layer->vert_count);
+		gs_load_vertexbuffer(nullptr);
+	}
+
+	gs_texrender_end(layer->glow);
+}
+
+bool film_look_splat_render(struct film_look_splat *splat, gs_texture_t *frame,
+			    const struct film_look_glow_gate *gate, const struct film_look_params *params,
+			    const struct film_look_effect_key *key)
+{
+	uint32_t cells_width, cells_height;
+	const float *cells = film_look_glow_gate_cells(gate, &cells_width, &cells_height);
+	gs_effect_t *effect = film_look_effect_get_splat();
+	if (!cells || !effect || !frame)
+		return false;
+
+	const uint32_t width = gs_texture_get_width(frame);
+	const uint32_t height = gs_texture_get_height(frame);
+	if (cells_width != (width + 7) / 8 || cells_height != (height + 7) / 8)
+		return false; // 画面尺寸刚变过，格子数据对不上
+
+	const int radii[SPLAT_LAYERS] = {key->bloom_radius, key->halation_radius, key->secondary_glow_radius};
+	const float thresholds[SPLAT_LAYERS] = {params->bloom_threshold, params->halation_threshold,
+						params->secondary_glow_threshold};
+	const uint32_t max_cells = (uint32_t)((float)(cells_width * cells_height) * FILM_LOOK_SPLAT_MAX_DENSITY);
+	const uint32_t sub_width = (width + 3) / 4;
+	const uint32_t sub_height = (height + 3) / 4;
+
+	// 先数一遍，太密就不用 splat
+	uint32_t sprite_count = 0;
+	for (int l = 0; l < SPLAT_LAYERS; l++) {
+		if (!radii[l])
+			continue;
+		const uint32_t count = mark_active(splat, cells, cells_width, cells_height, thresholds[l]);
+		if (count > max_cells)
+			return false;
+		sprite_count += count * 4;
+	}
+
+	if (!reserve_vertices(splat, std::max(sprite_count, 1u) * VERTS_PER_SPRITE))
+		return false;
+
+	struct gs_vb_data *vbd = gs_vertexbuffer_get_data(splat->vb);
+	auto *points = vbd->points;
+	auto *cell_data = static_cast<struct vec4 *>(vbd->tvarray[0].array);
+	uint32_t vert = 0;
+
+	for (int l = 0; l < SPLAT_LAYERS; l++) {
+		struct splat_layer &layer = splat->layers[l];
+		layer.first_vert = vert;
+		layer.vert_count = 0;
+		if (!radii[l])
+			continue;
+
+		mark_active(splat, cells, cells_width, cells_height, thresholds[l]);
+		for (uint32_t y = 0; y < cells_height; y++) {
+			for (uint32_t x = 0; x < cells_width; x++) {
+				if (!splat->active[(size_t)y * cells_width + x])
+					continue;
+
+				for (uint32_t sub = 0; sub < 4; sub++) {
+					const uint32_t cx = x * 2 + (sub & 1);
+					const uint32_t cy = y * 2 + (sub >> 1);
+					if (cx >= sub_width || cy >= sub_height)
+						continue;
+					emit_sprite(points + vert, cell_data + vert, cx, cy, radii[l]);
+					vert += VERTS_PER_SPRITE;
+				}
+			}
+		}
+		layer.vert_count = vert - layer.first_vert;
+	}
+
+	gs_vertexbuffer_flush(splat->vb);
+
+	gs_blend_state_push();
+	for (int l = 0; l < SPLAT_LAYERS; l++) {
+		if (!radii[l])
+			continue;
+
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		if (splat->layers[l].vert_count)
+			render_cell_sums(effect, &splat->layers[l], frame, thresholds[l], layer_tints[l]);
+
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ONE);
+		render_glow(effect, &splat->layers[l], splat->vb, width, height, radii[l]);
+	}
+	gs_blend_state_pop();
+
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "film-look-glow-gate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 稀疏光晕：亮点很少时，不在每个像素上收集 (2R+1)^2 个采样，而是只给亮的
+// 格子画加法混合的四边形，开销随亮点数量而不是画面面积 x 半径^2 增长。
+// 亮格子的列表来自光晕门限上一帧读回的 8x8 格子亮度（晚一帧，并向外扩一格）。
+struct film_look_splat;
+
+// 格子亮度不到阈值减去这个余量的不溅射
+#define FILM_LOOK_SPLAT_MARGIN 0.02f
+// 8x8 格子里亮格子超过这个比例就退回逐像素收集：
+// 四边形的混合写入比收集的纹理读取贵，而且顶点要每帧上传
+#define FILM_LOOK_SPLAT_MAX_DENSITY 0.04f
+
+// 以下函数都需要在图形上下文中调用
+struct film_look_splat *film_look_splat_create(void);
+void film_look_splat_destroy(struct film_look_splat *splat);
+
+// 亮格子足够稀疏时渲染各层的光晕缓冲并返回 true；太密或者还没有格子数据时
+// 返回 false，调用者退回逐像素收集
+bool film_look_splat_render(struct film_look_splat *splat, gs_texture_t *frame,
+			    const struct film_look_glow_gate *gate, const struct film_look_params *params,
+			    const struct film_look_effect_key *key);
+
+// 第 layer 层 (0 bloom, 1 halation, 2 secondary glow) 的光晕缓冲
+gs_texture_t *film_look_splat_texture(const struct film_look_splat *splat, int layer);
+
+#ifdef __cplusplus
+}
+#endif
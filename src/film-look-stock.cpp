@@ -0,0 +1,205 @@
+#include "film-look-stock.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// 一条特性曲线（H&D 曲线）：密度随 log10 曝光量呈 S 形变化
+struct dye_curve {
+	float d_min; // 片基 + 灰雾密度
+	float d_max;
+	float gamma; // 直线段斜率
+	float speed; // 曲线中点对应的 log10 曝光量
+};
+
+struct stock_def {
+	const char *text_key;
+	float exposure;            // 负片曝光补偿（档）
+	dye_curve negative[3];     // 青、品、黄三层染料，分别对应 R、G、B 曝光
+	float crosstalk[3][3];     // 层间串扰：实际密度 = crosstalk * 理想密度
+	dye_curve print[3];        // 印片的三层
+	float grey_bias[3];        // 18% 灰印出来的颜色（相对中性灰），用来决定整体冷暖
+};
+
+// clang-format off
+static const stock_def stocks[FILM_LOOK_STOCK_COUNT] = {
+	{"FilmLook.Stock.None", 0.0f, {}, {}, {}, {1.0f, 1.0f, 1.0f}},
+	{
+		"FilmLook.Stock.Tungsten500T", 0.0f,
+		{{0.25f, 2.4f, 0.58f, -1.00f}, {0.55f, 2.6f, 0.60f, -1.05f}, {0.85f, 2.8f, 0.62f, -1.10f}},
+		{{1.00f, 0.06f, 0.02f}, {0.08f, 1.00f, 0.07f}, {0.03f, 0.10f, 1.00f}},
+		{{0.06f, 3.4f, 2.3f, 0.0f}, {0.06f, 3.5f, 2.4f, 0.0f}, {0.06f, 3.6f, 2.5f, 0.0f}},
+		{1.03f, 1.00f, 0.95f},
+	},
+	{
+		"FilmLook.Stock.Daylight250D", 0.0f,
+		{{0.22f, 2.5f, 0.62f, -1.00f}, {0.52f, 2.6f, 0.62f, -1.00f}, {0.80f, 2.7f, 0.63f, -1.00f}},
+		{{1.00f, 0.04f, 0.01f}, {0.05f, 1.00f, 0.05f}, {0.02f, 0.07f, 1.00f}},
+		{{0.06f, 3.4f, 2.3f, 0.0f}, {0.06f, 3.5f, 2.4f, 0.0f}, {0.06f, 3.6f, 2.4f, 0.0f}},
+		{1.00f, 1.00f, 1.00f},
+	},
+	{
+		// 层间抑制效应（负的串扰）让颜色更浓
+		"FilmLook.Stock.FineGrain50D", -0.3f,
+		{{0.20f, 2.6f, 0.66f, -0.95f}, {0.50f, 2.7f, 0.66f, -0.95f}, {0.78f, 2.8f, 0.67f, -0.95f}},
+		{{1.00f, -0.05f, -0.02f}, {-0.04f, 1.00f, -0.05f}, {-0.02f, -0.05f, 1.00f}},
+		{{0.06f, 3.5f, 2.4f, 0.0f}, {0.06f, 3.6f, 2.5f, 0.0f}, {0.06f, 3.7f, 2.5f, 0.0f}},
+		{1.00f, 1.00f, 0.99f},
+	},
+	{
+		"FilmLook.Stock.Portrait400", 0.3f,
+		{{0.24f, 2.3f, 0.50f, -1.10f}, {0.54f, 2.4f, 0.50f, -1.10f}, {0.82f, 2.5f, 0.52f, -1.10f}},
+		{{1.00f, 0.10f, 0.04f}, {0.10f, 1.00f, 0.10f}, {0.04f, 0.12f, 1.00f}},
+		{{0.06f, 3.0f, 2.0f, 0.0f}, {0.06f, 3.0f, 2.0f, 0.0f}, {0.06f, 3.0f, 2.1f, 0.0f}},
+		{1.02f, 1.00f, 0.97f},
+	},
+	{
+		// 保留银：印片反差很高，并且银的中性密度叠加到三层上，颜色变淡
+		"FilmLook.Stock.BleachBypass", 0.0f,
+		{{0.25f, 2.5f, 0.62f, -1.00f}, {0.55f, 2.6f, 0.62f, -1.00f}, {0.85f, 2.7f, 0.62f, -1.00f}},
+		{{1.00f, 0.25f, 0.25f}, {0.25f, 1.00f, 0.25f}, {0.25f, 0.25f, 1.00f}},
+		{{0.08f, 4.0f, 3.0f, 0.0f}, {0.08f, 4.0f, 3.0f, 0.0f}, {0.08f, 4.0f, 3.0f, 0.0f}},
+		{0.98f, 1.00f, 1.02f},
+	},
+};
+// clang-format on
+
+static inline float density(const dye_curve &c, float log_e)
+{
+	const float range = c.d_max - c.d_min;
+	const float k = 4.0f * c.gamma / range;
+	return c.d_min + range / (1.0f + std::exp(-k * (log_e - c.speed)));
+}
+
+// 负片阶段：显示编码 RGB -> 三层的实际密度（含串扰）
+static void expose_negative(const stock_def &s, const float in[3], float out[3])
+{
+	const float gain = std::exp2(s.exposure);
+	float d[3];
+
+	for (int i = 0; i < 3; i++) {
+		const float lin = std::pow(std::clamp(in[i], 0.0f, 1.0f), 2.2f) * gain;
+		d[i] = density(s.negative[i], std::log10(std::max(lin, 1e-5f)));
+	}
+
+	for (int i = 0; i < 3; i++)
+		out[i] = s.crosstalk[i][0] * d[0] + s.crosstalk[i][1] * d[1] + s.crosstalk[i][2] * d[2];
+}
+
+// 印片阶段：单个通道，light 为印片机光号（log10 曝光偏移），返回线性透过率（相对片基）
+static inline float print_channel(const dye_curve &c, float light, float negative_density)
+{
+	const float d = density(c, light - negative_density);
+	return std::pow(10.0f, -(d - c.d_min));
+}
+
+struct printer_lights {
+	float light[3];
+};
+
+// 为每个预设求印片机光号，使 18% 灰印出 grey_bias 指定的颜色
+static std::array<printer_lights, FILM_LOOK_STOCK_COUNT> solve_printer_lights()
+{
+	std::array<printer_lights, FILM_LOOK_STOCK_COUNT> lights{};
+	const float grey = std::pow(0.18f, 1.0f / 2.2f);
+	const float grey_in[3] = {grey, grey, grey};
+
+	for (int s = FILM_LOOK_STOCK_NONE + 1; s < FILM_LOOK_STOCK_COUNT; s++) {
+		float neg[3];
+		expose_negative(stocks[s], grey_in, neg);
+
+		for (int i = 0; i < 3; i++) {
+			const float target = 0.18f * stocks[s].grey_bias[i];
+			// 透过率随光号单调递减，二分即可
+			float lo = -6.0f;
+			float hi = 6.0f;
+			for (int iter = 0; iter < 48; iter++) {
+				const float mid = (lo + hi) * 0.5f;
+				if (print_channel(stocks[s].print[i], mid, neg[i]) > target)
+					lo = mid;
+				else
+					hi = mid;
+			}
+			lights[s].light[i] = (lo + hi) * 0.5f;
+		}
+	}
+
+	return lights;
+}
+
+const char *film_look_stock_text_key(int stock)
+{
+	if (stock < 0 || stock >= FILM_LOOK_STOCK_COUNT)
+		stock = FILM_LOOK_STOCK_NONE;
+	return stocks[stock].text_key;
+}
+
+void film_look_stock_eval(int stock, const float in[3], float out[3])
+{
+	if (stock <= FILM_LOOK_STOCK_NONE || stock >= FILM_LOOK_STOCK_COUNT) {
+		out[0] = in[0];
+		out[1] = in[1];
+		out[2] = in[2];
+		return;
+	}
+
+	static const std::array<printer_lights, FILM_LOOK_STOCK_COUNT> lights = solve_printer_lights();
+	const stock_def &s = stocks[stock];
+
+	float neg[3];
+	expose_negative(s, in, neg);
+
+	for (int i = 0; i < 3; i++) {
+		const float t = print_channel(s.print[i], lights[stock].light[i], neg[i]);
+		out[i] = std::pow(std::clamp(t, 0.0f, 1.0f), 1.0f / 2.2f);
+	}
+}
+
+void film_look_stock_bake(int stock, uint32_t size, float *out)
+{
+	const float scale = 1.0f / (float)(size - 1);
+
+	for (uint32_t b = 0; b < size; b++) {
+		for (uint32_t g = 0; g < size; g++) {
+			for (uint32_t r = 0; r < size; r++) {
+				const float in[3] = {(float)r * scale, (float)g * scale, (float)b * scale};
+				film_look_stock_eval(stock, in, out + (((size_t)b * size + g) * size + r) * 3);
+			}
+		}
+	}
+}
+
+void film_look_stock_sample(const float *lut, uint32_t size, const float in[3], float out[3])
+{
+	int i0[3];
+	float f[3];
+
+	for (int c = 0; c < 3; c++) {
+		const float p = std::clamp(in[c], 0.0f, 1.0f) * (float)(size - 1);
+		i0[c] = std::min((int)p, (int)size - 2);
+		f[c] = p - (float)i0[c];
+	}
+
+	const size_t stride_g = size;
+	const size_t stride_b = (size_t)size * size;
+	const float *base = lut + (((size_t)i0[2] * size + i0[1]) * size + i0[0]) * 3;
+
+	for (int c = 0; c < 3; c++) {
+		const float c000 = base[c];
+		const float c100 = base[3 + c];
+		const float c010 = base[stride_g * 3 + c];
+		const float c110 = base[(stride_g + 1) * 3 + c];
+		const float c001 = base[stride_b * 3 + c];
+		const float c101 = base[(stride_b + 1) * 3 + c];
+		const float c011 = base[(stride_b + stride_g) * 3 + c];
+		const float c111 = base[(stride_b + stride_g + 1) * 3 + c];
+
+		const float c00 = c000 + (c100 - c000) * f[0];
+		const float c10 = c010 + (c110 - c010) * f[0];
+		const float c01 = c001 + (c101 - c001) * f[0];
+		const float c11 = c011 + (c111 - c011) * f[0];
+		const float c0 = c00 + (c10 - c00) * f[1];
+		const float c1 = c01 + (c11 - c01) * f[1];
+		out[c] = c0 + (c1 - c0) * f[2];
+	}
+}
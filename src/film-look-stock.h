@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 负片 + 印片的组合预设
+enum film_look_stock_id {
+	FILM_LOOK_STOCK_NONE = 0,
+	FILM_LOOK_STOCK_TUNGSTEN_500T,
+	FILM_LOOK_STOCK_DAYLIGHT_250D,
+	FILM_LOOK_STOCK_FINE_GRAIN_50D,
+	FILM_LOOK_STOCK_PORTRAIT_400,
+	FILM_LOOK_STOCK_BLEACH_BYPASS,
+	FILM_LOOK_STOCK_COUNT,
+};
+
+// shader 里的 LUT 坐标换算 (32.0 / 33.0, 0.5 / 33.0) 依赖这个尺寸
+#define FILM_LOOK_STOCK_LUT_SIZE 33
+
+// 修改预设表或模型公式时加一，让磁盘上烘焙好的 LUT 失效
+#define FILM_LOOK_STOCK_MODEL_VERSION 1
+
+const char *film_look_stock_text_key(int stock);
+
+// 直接计算胶片模型（每个像素十几次 exp/log，只用于烘焙和导出）。
+// 输入输出都是显示编码的 0~1 RGB。
+void film_look_stock_eval(int stock, const float in[3], float out[3]);
+
+// 在 size^3 格点上烘焙，R 变化最快，每个格点 3 个 float
+void film_look_stock_bake(int stock, uint32_t size, float *out);
+
+// 对烘焙好的 LUT 做三线性插值
+void film_look_stock_sample(const float *lut, uint32_t size, const float in[3], float out[3]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,18 +1,29 @@
 #include <obs-module.h>
 #include "plugin-support.h"
 #include "film-look-filter.h" // 包含我们的头文件
+#include "film-look-cache.h"
+#include "film-look-bulk.h"
+#include "film-look-prewarm.h"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
 bool obs_module_load(void)
 {
+	film_look_cache_prune(); // 清掉旧版本留下的烘焙缓存
 	obs_register_source(&film_look_filter); // 注册滤镜
+	film_look_bulk_init(); // 自动化脚本一次给多个实例换外观
+#ifdef ENABLE_FRONTEND_API
+	film_look_prewarm_init(); // 节目 / 预览场景里的滤镜提前准备好
+#endif
 	obs_log(LOG_INFO, "plugin loaded successfully (version %s)", PLUGIN_VERSION);
 	return true;
 }
 
 void obs_module_unload(void)
 {
+#ifdef ENABLE_FRONTEND_API
+	film_look_prewarm_free();
+#endif
 	obs_log(LOG_INFO, "plugin unloaded");
 }
@@ -0,0 +1,150 @@
+// 把吸收的“色彩校正”烘焙成的 LUT 和逐像素照搬 color_filter_v2 shader 的参考实现比较。
+// 参考实现按 shader 的顺序一步一步算（四元数直接旋转颜色），不拼矩阵，用来核对矩阵拼接和各项系数。
+
+#include "film-look-absorb.h"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+OBS_DECLARE_MODULE()
+
+#define LUT_SIZE 17
+#define TOLERANCE 1e-4
+
+struct color_settings {
+	double gamma;
+	double contrast;
+	double brightness;
+	double saturation;
+	double hue_shift;
+	uint32_t color_multiply;
+	uint32_t color_add;
+};
+
+static const struct color_settings cases[] = {
+	{0.0, 0.0, 0.0, 0.0, 0.0, 0xffffffff, 0xff000000},
+	{0.5, 0.0, 0.0, 0.0, 0.0, 0xffffffff, 0xff000000},
+	{-1.5, 0.0, 0.0, 0.0, 0.0, 0xffffffff, 0xff000000},
+	{0.0, 0.8, 0.2, 0.0, 0.0, 0xffffffff, 0xff000000},
+	{0.0, -0.5, -0.3, 0.0, 0.0, 0xffffffff, 0xff000000},
+	{0.0, 0.0, 0.0, 1.5, 0.0, 0xffffffff, 0xff000000},
+	{0.0, 0.0, 0.0, -1.0, 0.0, 0xffffffff, 0xff000000},
+	{0.0, 0.0, 0.0, 0.0, 90.0, 0xffffffff, 0xff000000},
+	{0.0, 0.0, 0.0, 0.0, -135.0, 0xffffffff, 0xff000000},
+	{0.0, 0.0, 0.0, 0.0, 0.0, 0xff4080c0, 0xff102030},
+	{0.7, 0.4, -0.1, 0.6, 45.0, 0xffe0f0ff, 0xff080402},
+	{-0.8, -0.2, 0.15, -0.4, 170.0, 0xffc0c0ff, 0xff000010},
+};
+
+static double channel(uint32_t color, int i)
+{
+	return (double)((color >> (8 * i)) & 0xff) / 255.0;
+}
+
+// color_correction_filter.effect：先 pow(gamma)，再依次做亮度、对比度、饱和度、色相、乘色、加色，
+// 最后写进 8 位渲染目标时截断
+static void reference(const struct color_settings *cs, const double in[3], double out[3])
+{
+	const double gamma = cs->gamma < 0.0 ? -cs->gamma + 1.0 : 1.0 / (cs->gamma + 1.0);
+	double c[3];
+	for (int i = 0; i < 3; i++)
+		c[i] = std::pow(std::max(in[i], 0.0), gamma);
+
+	const double contrast = cs->contrast + 1.0;
+	for (int i = 0; i < 3; i++)
+		c[i] = (c[i] + cs->brightness - 0.5) * contrast + 0.5;
+
+	const double saturation = cs->saturation + 1.0;
+	const double luma = 0.299 * c[0] + 0.587 * c[1] + 0.114 * c[2];
+	for (int i = 0; i < 3; i++)
+		c[i] = luma + (c[i] - luma) * saturation;
+
+	// 绕 (1,1,1) 轴旋转 hue_shift 度：q c q*
+	const double half_angle = 0.5 * cs->hue_shift * 3.14159265358979 / 180.0;
+	const double axis = 1.0 / std::sqrt(3.0);
+	const double q[3] = {axis * std::sin(half_angle), axis * std::sin(half_angle), axis * std::sin(half_angle)};
+	const double w = std::cos(half_angle);
+	const double t[3] = {2.0 * (q[1] * c[2] - q[2] * c[1]), 2.0 * (q[2] * c[0] - q[0] * c[2]),
+			     2.0 * (q[0] * c[1] - q[1] * c[0])};
+	const double rotated[3] = {c[0] + w * t[0] + (q[1] * t[2] - q[2] * t[1]),
+				   c[1] + w * t[1] + (q[2] * t[0] - q[0] * t[2]),
+				   c[2] + w * t[2] + (q[0] * t[1] - q[1] * t[0])};
+
+	for (int i = 0; i < 3; i++) {
+		const double x = rotated[i] * channel(cs->color_multiply, i) + channel(cs->color_add, i);
+		out[i] = std::clamp(x, 0.0, 1.0);
+	}
+}
+
+static bool check_case(int index, const struct color_settings *cs)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_double(settings, "gamma", cs->gamma);
+	obs_data_set_double(settings, "contrast", cs->contrast);
+	obs_data_set_double(settings, "brightness", cs->brightness);
+	obs_data_set_double(settings, "saturation", cs->saturation);
+	obs_data_set_double(settings, "hue_shift", cs->hue_shift);
+	obs_data_set_double(settings, "opacity", 1.0);
+	obs_data_set_int(settings, "color_multiply", cs->color_multiply);
+	obs_data_set_int(settings, "color_add", cs->color_add);
+
+	struct film_look_absorb *absorb = film_look_absorb_create();
+	const bool appended = film_look_absorb_append(absorb, "color_filter_v2", settings);
+	obs_data_release(settings);
+	if (!appended) {
+		fprintf(stderr, "case %d: colour correction was not absorbed\n", index);
+		film_look_absorb_destroy(absorb);
+		return false;
+	}
+
+	std::vector<float> lut((size_t)LUT_SIZE * LUT_SIZE * LUT_SIZE * 3);
+	film_look_absorb_bake(absorb, LUT_SIZE, lut.data());
+	film_look_absorb_destroy(absorb);
+
+	double worst = 0.0;
+	for (int b = 0; b < LUT_SIZE; b++) {
+		for (int g = 0; g < LUT_SIZE; g++) {
+			for (int r = 0; r < LUT_SIZE; r++) {
+				const double in[3] = {(double)r / (LUT_SIZE - 1), (double)g / (LUT_SIZE - 1),
+						      (double)b / (LUT_SIZE - 1)};
+				double expected[3];
+				reference(cs, in, expected);
+
+				const float *baked = &lut[(((size_t)b * LUT_SIZE + g) * LUT_SIZE + r) * 3];
+				for (int i = 0; i < 3; i++)
+					worst = std::max(worst, std::fabs((double)baked[i] - expected[i]));
+			}
+		}
+	}
+
+	if (worst > TOLERANCE) {
+		fprintf(stderr, "case %d: baked LUT differs from color_filter_v2 by %g\n", index, worst);
+		return false;
+	}
+	printf("case %d: max error %g\n", index, worst);
+	return true;
+}
+
+int main(void)
+{
+	bool ok = true;
+	for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+		ok = check_case(i, &cases[i]) && ok;
+
+	// 不透明度不到 1 时不能吸收
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_double(settings, "opacity", 0.5);
+	struct film_look_absorb *absorb = film_look_absorb_create();
+	if (film_look_absorb_append(absorb, "color_filter_v2", settings)) {
+		fprintf(stderr, "translucent colour correction was absorbed\n");
+		ok = false;
+	}
+	film_look_absorb_destroy(absorb);
+	obs_data_release(settings);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+// 独立于 OBS 的胶片外观帧服务：客户端通过 POSIX 共享内存环形缓冲交换帧，
+// 服务端用 CPU 路径 (film-look-cpu) 处理。协议见 film-look-shm.h。
+
+#include "film-look-shm.h"
+
+#include "film-look-cpu.h"
+#include "film-look-params.h"
+#include "plugin-support.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static std::atomic<bool> running{true};
+
+static uint32_t load_u32(const uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static uint64_t load_u64(const uint64_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_u32(uint32_t *p, uint32_t val)
+{
+	__atomic_store_n(p, val, __ATOMIC_RELEASE);
+}
+
+static void futex_wait(uint32_t *addr, uint32_t expected, int timeout_ms)
+{
+	struct timespec ts = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+	syscall(SYS_futex, addr, FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+static void futex_wake(uint32_t *addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+static void notify(uint32_t *addr)
+{
+	__atomic_add_fetch(addr, 1, __ATOMIC_RELEASE);
+	futex_wake(addr);
+}
+
+static void *map_segment(const char *name, size_t *size)
+{
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat st;
+	void *ptr = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(struct fls_ring_header)) {
+		*size = (size_t)st.st_size;
+		ptr = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+
+	return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+// 环形段的布局。头部在客户端可写的共享内存里，随时可能被改写，所以连接时只读一次，
+// 校验和之后每一帧的地址计算都只用这份拷贝
+struct ring_layout {
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;
+	uint32_t slot_count;
+	uint64_t slot_offset;
+	uint64_t slot_size;
+};
+
+static bool read_layout(const struct fls_ring_header *ring, size_t size, struct ring_layout *layout)
+{
+	if (load_u32(&ring->magic) != FLS_MAGIC || load_u32(&ring->version) != FLS_VERSION)
+		return false;
+
+	layout->width = load_u32(&ring->width);
+	layout->height = load_u32(&ring->height);
+	layout->stride = load_u32(&ring->stride);
+	layout->slot_count = load_u32(&ring->slot_count);
+	layout->slot_offset = load_u64(&ring->slot_offset);
+	layout->slot_size = load_u64(&ring->slot_size);
+
+	// 尺寸都按 64 位比较，width * 4 不会回绕
+	if (!layout->width || !layout->height || !layout->slot_count)
+		return false;
+	if (layout->width > FLS_MAX_DIMENSION || layout->height > FLS_MAX_DIMENSION)
+		return false;
+	if ((uint64_t)layout->stride < (uint64_t)layout->width * 4)
+		return false;
+	if (layout->slot_size < fls_slot_bytes(layout->height, layout->stride))
+		return false;
+	// 帧槽不能和头部重叠；先比较偏移再做除法，避免 slot_offset + slot_size * slot_count 溢出
+	if (layout->slot_offset < sizeof(struct fls_ring_header) || layout->slot_offset > size)
+		return false;
+	return layout->slot_size <= (size - layout->slot_offset) / layout->slot_count;
+}
+
+// 读取客户端的设置；正在写入（seq 为奇数）或读的过程中被改写时返回 false，下次再试
+static bool load_settings(struct fls_ring_header *ring, uint32_t *applied_seq, struct film_look_cpu *cpu)
+{
+	uint32_t seq = load_u32(&ring->settings_seq);
+	if (seq == *applied_seq || (seq & 1) != 0)
+		return false;
+
+	char json[FLS_SETTINGS_LEN];
+	memcpy(json, ring->settings_json, sizeof(json));
+	json[sizeof(json) - 1] = 0;
+	if (load_u32(&ring->settings_seq) != seq)
+		return false;
+
+	struct film_look_params params;
+	if (!film_look_params_load_json(&params, json)) {
+		obs_log(LOG_WARNING, "ignoring malformed settings json");
+		*applied_seq = seq;
+		return false;
+	}
+
+	film_look_cpu_update(cpu, &params);
+	*applied_seq = seq;
+	return true;
+}
+
+static void unpack_rgba8(const uint8_t *src, uint32_t stride, struct film_look_image *dst)
+{
+	for (uint32_t y = 0; y < dst->height; y++) {
+		const uint8_t *s = src + (size_t)y * stride;
+		float *d = dst->data + (size_t)y * dst->stride;
+		for (uint32_t i = 0; i < dst->width * 4; i++)
+			d[i] = (float)s[i] * (1.0f / 255.0f);
+	}
+}
+
+static void pack_rgba8(const struct film_look_image *src, uint8_t *dst, uint32_t stride)
+{
+	for (uint32_t y = 0; y < src->height; y++) {
+		const float *s = src->data + (size_t)y * src->stride;
+		uint8_t *d = dst + (size_t)y * stride;
+		for (uint32_t i = 0; i < src->width * 4; i++)
+			d[i] = (uint8_t)(s[i] * 255.0f + 0.5f);
+	}
+}
+
+static void client_worker(struct fls_registry *registry, int index, std::string ring_name)
+{
+	struct fls_client_slot *slot = &registry->clients[index];
+	size_t size = 0;
+	auto *ring = static_cast<struct fls_ring_header *>(map_segment(ring_name.c_str(), &size));
+	struct ring_layout layout;
+
+	if (!ring || !read_layout(ring, size, &layout)) {
+		obs_log(LOG_WARNING, "client %d: invalid ring segment '%s'", index, ring_name.c_str());
+		if (ring)
+			munmap(ring, size);
+		store_u32(&slot->state, FLS_SLOT_FREE);
+		notify(&registry->wake);
+		return;
+	}
+
+	const uint32_t width = layout.width;
+	const uint32_t height = layout.height;
+	const uint32_t stride = layout.stride;
+	const uint32_t slot_count = layout.slot_count;
+	const uint64_t slot_offset = layout.slot_offset;
+	const uint64_t slot_size = layout.slot_size;
+	const size_t frame_bytes = (size_t)height * stride;
+
+	// 分配或更新失败（内存不足）只影响这个客户端，异常不能逃出工作线程，否则整个服务端都会退出
+	std::vector<float> in_pixels, out_pixels;
+	struct film_look_cpu *cpu = nullptr;
+	uint32_t applied_seq = UINT32_MAX;
+	try {
+		in_pixels.resize((size_t)width * height * 4);
+		out_pixels.resize((size_t)width * height * 4);
+
+		// 先装入默认外观，客户端还没写过设置或第一份设置无法解析时都用它
+		cpu = film_look_cpu_create();
+		struct film_look_params defaults;
+		film_look_params_load_json(&defaults, nullptr);
+		film_look_cpu_update(cpu, &defaults);
+		load_settings(ring, &applied_seq, cpu);
+	} catch (const std::exception &e) {
+		obs_log(LOG_WARNING, "client %d: failed to set up %ux%u: %s", index, width, height, e.what());
+		if (cpu)
+			film_look_cpu_destroy(cpu);
+		munmap(ring, size);
+		store_u32(&slot->state, FLS_SLOT_FREE);
+		notify(&registry->wake);
+		return;
+	}
+
+	struct film_look_image in = {in_pixels.data(), width, height, (size_t)width * 4};
+	struct film_look_image out = {out_pixels.data(), width, height, (size_t)width * 4};
+
+	obs_log(LOG_INFO, "client %d connected: %s (%ux%u, %u slots)", index, ring_name.c_str(), width, height,
+		slot_count);
+
+	store_u32(&slot->state, FLS_SLOT_ACTIVE);
+	notify(&registry->wake);
+
+	uint32_t completed = load_u32(&ring->complete_seq);
+	while (running && !load_u32(&ring->closing)) {
+		uint32_t submitted = load_u32(&ring->submit_seq);
+		if (submitted == completed) {
+			futex_wait(&ring->submit_seq, submitted, 100);
+			continue;
+		}
+
+		const uint64_t frame_offset = slot_offset + slot_size * (completed % slot_count);
+		uint8_t *base = reinterpret_cast<uint8_t *>(ring) + frame_offset;
+		auto *frame = reinterpret_cast<struct fls_frame_slot *>(base);
+		uint8_t *frame_in = reinterpret_cast<uint8_t *>(frame + 1);
+		uint8_t *frame_out = frame_in + frame_bytes;
+
+		// 失败的帧标成 FLS_FRAME_ERROR，照常完成，后面的帧继续处理
+		uint32_t status = FLS_FRAME_DONE;
+		try {
+			load_settings(ring, &applied_seq, cpu);
+			unpack_rgba8(frame_in, stride, &in);
+			film_look_cpu_render(cpu, &in, &out, frame->elapsed_time);
+			pack_rgba8(&out, frame_out, stride);
+		} catch (const std::exception &e) {
+			obs_log(LOG_WARNING, "client %d: frame %u failed: %s", index, completed, e.what());
+			status = FLS_FRAME_ERROR;
+		}
+		store_u32(&frame->status, status);
+
+		completed++;
+		store_u32(&ring->complete_seq, completed);
+		futex_wake(&ring->complete_seq);
+	}
+
+	film_look_cpu_destroy(cpu);
+	munmap(ring, size);
+
+	obs_log(LOG_INFO, "client %d disconnected", index);
+	store_u32(&slot->state, FLS_SLOT_FREE);
+	notify(&registry->wake);
+}
+
+// 注册表段已存在：记录的服务端进程还活着就返回 true，否则是上次异常退出留下的
+static bool registry_in_use(const char *name)
+{
+	size_t size = 0;
+	auto *registry = static_cast<struct fls_registry *>(map_segment(name, &size));
+	if (!registry)
+		return false;
+
+	bool live = false;
+	if (size >= sizeof(struct fls_registry) && load_u32(&registry->magic) == FLS_MAGIC) {
+		const pid_t pid = (pid_t)registry->server_pid;
+		live = pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+	}
+	munmap(registry, size);
+	return live;
+}
+
+// 不能无条件 shm_unlink：那样会把正在运行的服务端的注册表从它的客户端下面换掉
+static int create_registry(const char *name)
+{
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+	if (fd < 0 && errno == EEXIST) {
+		if (registry_in_use(name)) {
+			obs_log(LOG_ERROR, "another frame server is already running on '%s'", name);
+			return -1;
+		}
+
+		obs_log(LOG_WARNING, "removing stale registry segment '%s'", name);
+		shm_unlink(name);
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+	}
+
+	if (fd < 0)
+		obs_log(LOG_ERROR, "failed to create registry segment '%s': %s", name, strerror(errno));
+	return fd;
+}
+
+static void handle_signal(int sig)
+{
+	UNUSED_PARAMETER(sig);
+	running = false;
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = argc > 1 ? argv[1] : FLS_DEFAULT_NAME;
+
+	int fd = create_registry(name);
+	if (fd < 0)
+		return 1;
+	if (ftruncate(fd, sizeof(struct fls_registry)) != 0) {
+		obs_log(LOG_ERROR, "failed to size registry segment '%s'", name);
+		close(fd);
+		shm_unlink(name);
+		return 1;
+	}
+
+	void *mem = mmap(nullptr, sizeof(struct fls_registry), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		shm_unlink(name);
+		return 1;
+	}
+
+	auto *registry = static_cast<struct fls_registry *>(mem);
+	memset(registry, 0, sizeof(*registry));
+	registry->version = FLS_VERSION;
+	registry->server_pid = (uint32_t)getpid();
+	store_u32(&registry->magic, FLS_MAGIC);
+
+	signal(SIGINT, handle_signal);
+	signal(SIGTERM, handle_signal);
+	obs_log(LOG_INFO, "frame server listening on %s (version %s)", name, PLUGIN_VERSION);
+
+	std::vector<std::thread> workers(FLS_MAX_CLIENTS);
+
+	while (running) {
+		uint32_t wake = load_u32(&registry->wake);
+
+		for (int i = 0; i < FLS_MAX_CLIENTS; i++) {
+			struct fls_client_slot *slot = &registry->clients[i];
+			if (load_u32(&slot->state) != FLS_SLOT_REQUESTED)
+				continue;
+
+			// 上一个占用这个槽的客户端已经退出，先回收它的线程
+			if (workers[i].joinable())
+				workers[i].join();
+
+			char ring_name[FLS_NAME_LEN];
+			memcpy(ring_name, slot->ring_name, sizeof(ring_name));
+			ring_name[FLS_NAME_LEN - 1] = 0;
+
+			store_u32(&slot->state, FLS_SLOT_CLAIMED);
+			workers[i] = std::thread(client_worker, registry, i, std::string(ring_name));
+		}
+
+		futex_wait(&registry->wake, wake, 250);
+	}
+
+	for (std::thread &worker : workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+
+	munmap(registry, sizeof(struct fls_registry));
+	shm_unlink(name);
+	obs_log(LOG_INFO, "frame server stopped");
+	return 0;
+}
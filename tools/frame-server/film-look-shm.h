@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+ * film-look-server 的共享内存协议（仅 Linux）。
+ *
+ * 服务端创建一个注册表段（默认 "/film-look-server"）。客户端：
+ *   1. 自己创建一个环形缓冲段（shm_open + ftruncate），按 fls_ring_header 填好头部，
+ *      submit_seq / complete_seq 置 0；
+ *   2. 在注册表里把某个 FLS_SLOT_FREE 的槽原子地改成 FLS_SLOT_CLAIMED，写入环形段名字，
+ *      再改成 FLS_SLOT_REQUESTED，然后对 registry->wake 加一并 futex 唤醒；
+ *   3. 服务端接手后把槽置为 FLS_SLOT_ACTIVE。
+ *
+ * 提交一帧：等待 submit_seq - complete_seq < slot_count，把像素写进
+ * slots[submit_seq % slot_count] 的输入区，然后 submit_seq 加一并唤醒。
+ * 服务端按顺序处理，写完输出区后 complete_seq 加一并唤醒，客户端可以同时
+ * 有 slot_count 帧在处理中。
+ *
+ * 设置：与滤镜相同键名的 JSON（见 film_look_params_defaults），用 seqlock 写入：
+ * settings_seq 先加一（变为奇数），写 settings_json，再加一（变回偶数）。
+ *
+ * 断开：置 closing = 1 并唤醒 submit_seq，服务端释放后把注册表槽置回 FLS_SLOT_FREE。
+ * 所有 futex 字都是进程间共享的（不要用 FUTEX_PRIVATE_FLAG）。
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLS_DEFAULT_NAME "/film-look-server"
+#define FLS_MAGIC 0x464c5331u /* "FLS1" */
+#define FLS_VERSION 1
+#define FLS_MAX_CLIENTS 16
+#define FLS_NAME_LEN 64
+#define FLS_SETTINGS_LEN 4096
+/* 宽高的上限，超过的环形段会被拒绝 */
+#define FLS_MAX_DIMENSION 8192
+
+enum fls_slot_state {
+	FLS_SLOT_FREE = 0,
+	FLS_SLOT_CLAIMED = 1,
+	FLS_SLOT_REQUESTED = 2,
+	FLS_SLOT_ACTIVE = 3,
+};
+
+struct fls_client_slot {
+	uint32_t state;
+	char ring_name[FLS_NAME_LEN];
+};
+
+struct fls_registry {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t server_pid;
+	uint32_t wake; /* futex，任一槽变化时加一 */
+	struct fls_client_slot clients[FLS_MAX_CLIENTS];
+};
+
+enum fls_frame_status {
+	FLS_FRAME_PENDING = 0,
+	FLS_FRAME_DONE = 1,
+	FLS_FRAME_ERROR = 2, /* 处理失败（比如内存不足），输出区内容未定义，complete_seq 照常加一 */
+};
+
+/* 每个帧槽的头部，后面紧跟输入像素 (height * stride 字节) 和输出像素 (同样大小)，
+ * 像素格式为 RGBA8 */
+struct fls_frame_slot {
+	uint64_t frame_id;
+	float elapsed_time; /* 秒，决定颗粒和抖动的相位 */
+	uint32_t status;
+	uint8_t reserved[48];
+};
+
+struct fls_ring_header {
+	uint32_t magic;
+	uint32_t version;
+	/* 以下布局字段服务端只在连接时读一次，之后再改不起作用 */
+	uint32_t width;  /* 不超过 FLS_MAX_DIMENSION */
+	uint32_t height; /* 不超过 FLS_MAX_DIMENSION */
+	uint32_t stride; /* 每行字节数，至少 width * 4 */
+	uint32_t slot_count;
+	uint64_t slot_offset; /* 第一个帧槽相对段起始的偏移 */
+	uint64_t slot_size;   /* 每个帧槽的字节数 */
+
+	uint32_t submit_seq;   /* futex，客户端写 */
+	uint32_t complete_seq; /* futex，服务端写 */
+	uint32_t closing;
+	uint32_t settings_seq;
+	char settings_json[FLS_SETTINGS_LEN];
+};
+
+static inline uint64_t fls_slot_bytes(uint32_t height, uint32_t stride)
+{
+	return sizeof(struct fls_frame_slot) + 2 * (uint64_t)height * stride;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1079 @@
+// 光晕质量 / 性能的 Pareto 探索：把一组参考画面用插件里能选的各种光晕模式渲染一遍
+// （逐像素收集、半分辨率 / 四分之一分辨率的采样源、稀疏溅射、换成自定义光晕层走亮部金字塔），
+// 与逐像素收集的 mainImage（film-look-cpu）对比 PSNR、SSIM、ΔE2000，输出 Pareto 前沿和
+// 每个分辨率推荐的设置。模式列表见 film-look-glow-modes.h。
+//
+// 用法: film-look-glow-explorer [--settings JSON] [--res WxH]... [--repeat N] [--gpu-times times.csv]
+//                               [--report out.md] [image.ppm]...
+// 不给图片时使用内置的合成参考画面（稀疏点光源、窗户高光、中间调纹理）。
+//
+// 画面在 CPU 上模拟，CPU 耗时和 GPU 上的快慢关系不一样（比如缩小的采样源省的是显存带宽，
+// 采样次数不变）。GPU 耗时用无界面基准在真实 effect 上测：
+//   film-look-headless --glow-modes --settings settings.json --size 1920x1080 --csv times.csv
+// 再用 --gpu-times times.csv 传进来，Pareto 前沿和推荐设置就按 GPU 耗时排；注意它用的是
+// 基准程序自己的测试画面。没有 GPU 耗时时按估算的每像素纹理读取数排。
+
+#include "film-look-cpu.h"
+#include "film-look-glow-modes.h"
+#include "film-look-glow-pyramid.h"
+#include "film-look-params.h"
+#include "film-look-splat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct rgb_image {
+	int width = 0;
+	int height = 0;
+	std::vector<float> px; // RGB，0~1
+
+	float *at(int x, int y) { return px.data() + ((size_t)y * width + x) * 3; }
+	const float *at(int x, int y) const { return px.data() + ((size_t)y * width + x) * 3; }
+	void resize(int w, int h)
+	{
+		width = w;
+		height = h;
+		px.assign((size_t)w * h * 3, 0.0f);
+	}
+};
+
+struct reference_scene {
+	std::string name;
+	rgb_image image;
+};
+
+struct glow_layer_def {
+	float threshold;
+	float radius;
+	float tint[3];
+	float intensity;
+	int blend; // enum film_look_glow_blend
+};
+
+// ---------------------------------------------------------------------------
+// 参考画面
+
+static bool load_ppm(const char *path, rgb_image &image)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	int w = 0, h = 0, maxval = 0;
+	bool ok = fscanf(file, "P6 %d %d %d", &w, &h, &maxval) == 3 && maxval == 255 && w > 0 && h > 0;
+	if (ok) {
+		fgetc(file);
+		std::vector<unsigned char> bytes((size_t)w * h * 3);
+		ok = fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		if (ok) {
+			image.resize(w, h);
+			for (size_t i = 0; i < bytes.size(); i++)
+				image.px[i] = (float)bytes[i] / 255.0f;
+		}
+	}
+
+	fclose(file);
+	return ok;
+}
+
+// 双线性缩放到目标分辨率
+static rgb_image resample(const rgb_image &src, int width, int height)
+{
+	rgb_image out;
+	out.resize(width, height);
+	for (int y = 0; y < height; y++) {
+		const float sy = std::clamp(((float)y + 0.5f) * (float)src.height / (float)height - 0.5f, 0.0f,
+					    (float)(src.height - 1));
+		const int y0 = (int)sy;
+		const int y1 = std::min(y0 + 1, src.height - 1);
+		const float fy = sy - (float)y0;
+		for (int x = 0; x < width; x++) {
+			const float sx = std::clamp(((float)x + 0.5f) * (float)src.width / (float)width - 0.5f, 0.0f,
+						    (float)(src.width - 1));
+			const int x0 = (int)sx;
+			const int x1 = std::min(x0 + 1, src.width - 1);
+			const float fx = sx - (float)x0;
+			for (int c = 0; c < 3; c++) {
+				const float top = src.at(x0, y0)[c] + (src.at(x1, y0)[c] - src.at(x0, y0)[c]) * fx;
+				const float bottom = src.at(x0, y1)[c] + (src.at(x1, y1)[c] - src.at(x0, y1)[c]) * fx;
+				out.at(x, y)[c] = top + (bottom - top) * fy;
+			}
+		}
+	}
+	return out;
+}
+
+static uint32_t hash_u32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+static float hash_float(uint32_t x)
+{
+	return (float)(hash_u32(x) >> 8) / 16777216.0f;
+}
+
+static float value_noise(float x, float y, uint32_t seed)
+{
+	const int ix = (int)std::floor(x);
+	const int iy = (int)std::floor(y);
+	const float fx = x - (float)ix;
+	const float fy = y - (float)iy;
+	auto corner = [&](int cx, int cy) {
+		return hash_float((uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u ^ seed);
+	};
+	const float sx = fx * fx * (3.0f - 2.0f * fx);
+	const float sy = fy * fy * (3.0f - 2.0f * fy);
+	const float top = corner(ix, iy) + (corner(ix + 1, iy) - corner(ix, iy)) * sx;
+	const float bottom = corner(ix, iy + 1) + (corner(ix + 1, iy + 1) - corner(ix, iy + 1)) * sx;
+	return top + (bottom - top) * sy;
+}
+
+// 三种典型画面：亮点稀疏的夜景、大块高光、几乎没有高光的中间调
+static std::vector<reference_scene> synthetic_scenes(int width, int height)
+{
+	std::vector<reference_scene> scenes(3);
+	const float scale = (float)height / 1080.0f;
+
+	scenes[0].name = "night-lights";
+	scenes[0].image.resize(width, height);
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			for (int c = 0; c < 3; c++)
+				scenes[0].image.at(x, y)[c] = 0.04f + 0.03f * value_noise(x / 90.0f, y / 90.0f, 7 + c);
+	for (uint32_t i = 0; i < 120; i++) {
+		const int cx = (int)(hash_float(i * 2 + 1) * (float)width);
+		const int cy = (int)(hash_float(i * 2 + 2) * (float)height);
+		const int r = std::max(1, (int)((1.0f + 4.0f * hash_float(i + 999)) * scale));
+		const float warm = hash_float(i + 4242);
+		for (int y = std::max(cy - r, 0); y <= std::min(cy + r, height - 1); y++) {
+			for (int x = std::max(cx - r, 0); x <= std::min(cx + r, width - 1); x++) {
+				float *p = scenes[0].image.at(x, y);
+				p[0] = 1.0f;
+				p[1] = 0.85f + 0.15f * warm;
+				p[2] = 0.6f + 0.4f * (1.0f - warm);
+			}
+		}
+	}
+
+	scenes[1].name = "window";
+	scenes[1].image.resize(width, height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const float u = (float)x / (float)width;
+			const float v = (float)y / (float)height;
+			const bool window = u > 0.55f && u < 0.8f && v > 0.15f && v < 0.6f &&
+					    std::fmod(u * 40.0f, 10.0f) > 0.6f && std::fmod(v * 30.0f, 13.5f) > 0.6f;
+			float *p = scenes[1].image.at(x, y);
+			p[0] = window ? 1.0f : 0.25f + 0.35f * v;
+			p[1] = window ? 0.98f : 0.2f + 0.3f * v;
+			p[2] = window ? 0.92f : 0.18f + 0.2f * v;
+		}
+	}
+
+	scenes[2].name = "texture";
+	scenes[2].image.resize(width, height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const float n = value_noise(x / (12.0f * scale), y / (12.0f * scale), 3) * 0.5f +
+					value_noise(x / (60.0f * scale), y / (60.0f * scale), 5) * 0.5f;
+			float *p = scenes[2].image.at(x, y);
+			p[0] = 0.3f + 0.55f * n;
+			p[1] = 0.28f + 0.5f * n;
+			p[2] = 0.25f + 0.45f * n;
+		}
+	}
+
+	return scenes;
+}
+
+// ---------------------------------------------------------------------------
+// 各光晕模式在 CPU 上的模拟，做法和 shader 相同。输出都是一层光晕的平均值
+// （和 shader 里除以采样数之后一样，还没乘颜色和强度），画面外按 Border 寻址当作黑色。
+
+static float luma(const float *c)
+{
+	return c[0] * 0.299f + c[1] * 0.587f + c[2] * 0.114f;
+}
+
+// smoothstep(threshold, 1.0, luma)
+static float bright_factor(const float *c, float threshold)
+{
+	float t = threshold < 1.0f ? std::clamp((luma(c) - threshold) / (1.0f - threshold), 0.0f, 1.0f) : 0.0f;
+	return t * t * (3.0f - 2.0f * t);
+}
+
+static void bright_pass(const rgb_image &src, float threshold, rgb_image &out)
+{
+	out.resize(src.width, src.height);
+	for (size_t i = 0; i < (size_t)src.width * src.height; i++) {
+		const float *c = src.px.data() + i * 3;
+		const float t = bright_factor(c, threshold);
+		out.px[i * 3 + 0] = c[0] * t;
+		out.px[i * 3 + 1] = c[1] * t;
+		out.px[i * 3 + 2] = c[2] * t;
+	}
+}
+
+// 可分离的盒式平均，等价于逐像素收集 (2r+1)^2 个采样
+static void box_average(const rgb_image &src, int r, rgb_image &out)
+{
+	const int w = src.width;
+	const int h = src.height;
+	rgb_image rows;
+	rows.resize(w, h);
+	for (int y = 0; y < h; y++) {
+		for (int c = 0; c < 3; c++) {
+			float sum = 0.0f;
+			for (int x = -r - 1; x < r; x++)
+				sum += x >= 0 && x < w ? src.at(x, y)[c] : 0.0f;
+			for (int x = 0; x < w; x++) {
+				const int in = x + r;
+				const int out_x = x - r - 1;
+				sum += in < w ? src.at(in, y)[c] : 0.0f;
+				sum -= out_x >= 0 ? src.at(out_x, y)[c] : 0.0f;
+				rows.at(x, y)[c] = sum;
+			}
+		}
+	}
+
+	const float norm = 1.0f / (float)((2 * r + 1) * (2 * r + 1));
+	out.resize(w, h);
+	for (int x = 0; x < w; x++) {
+		for (int c = 0; c < 3; c++) {
+			float sum = 0.0f;
+			for (int y = -r - 1; y < r; y++)
+				sum += y >= 0 && y < h ? rows.at(x, y)[c] : 0.0f;
+			for (int y = 0; y < h; y++) {
+				const int in = y + r;
+				const int out_y = y - r - 1;
+				sum += in < h ? rows.at(x, in)[c] : 0.0f;
+				sum -= out_y >= 0 ? rows.at(x, out_y)[c] : 0.0f;
+				out.at(x, y)[c] = sum * norm;
+			}
+		}
+	}
+}
+
+// uv 以像素为单位的双线性采样，越界为黑色
+static void sample_bilinear(const rgb_image &img, float x, float y, float out[3])
+{
+	x -= 0.5f;
+	y -= 0.5f;
+	const int x0 = (int)std::floor(x);
+	const int y0 = (int)std::floor(y);
+	const float fx = x - (float)x0;
+	const float fy = y - (float)y0;
+	const float weights[4] = {(1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy};
+	const int xs[4] = {x0, x0 + 1, x0, x0 + 1};
+	const int ys[4] = {y0, y0, y0 + 1, y0 + 1};
+
+	out[0] = out[1] = out[2] = 0.0f;
+	for (int i = 0; i < 4; i++) {
+		if (xs[i] < 0 || ys[i] < 0 || xs[i] >= img.width || ys[i] >= img.height)
+			continue;
+		const float *p = img.at(xs[i], ys[i]);
+		for (int c = 0; c < 3; c++)
+			out[c] += p[c] * weights[i];
+	}
+}
+
+// 同上，越界时取边缘（对应 Clamp 寻址）
+static void sample_bilinear_clamp(const rgb_image &img, float x, float y, float out[3])
+{
+	x = std::clamp(x, 0.5f, (float)img.width - 0.5f);
+	y = std::clamp(y, 0.5f, (float)img.height - 0.5f);
+	sample_bilinear(img, x, y, out);
+}
+
+// 和 shader 里 BrightPass / Downsample 相同：中心 x4 + 四角，双线性，除以 8
+static void kawase_down(const rgb_image &src, bool apply_threshold, float threshold, rgb_image &out)
+{
+	rgb_image source_bright;
+	const rgb_image *source = &src;
+	if (apply_threshold) {
+		bright_pass(src, threshold, source_bright);
+		source = &source_bright;
+	}
+
+	out.resize(std::max((src.width + 1) / 2, 1), std::max((src.height + 1) / 2, 1));
+	const float sx_scale = (float)src.width / (float)out.width;
+	const float sy_scale = (float)src.height / (float)out.height;
+	static const float offsets[5][3] = {{0, 0, 4}, {-1, -1, 1}, {1, -1, 1}, {-1, 1, 1}, {1, 1, 1}};
+
+	for (int y = 0; y < out.height; y++) {
+		for (int x = 0; x < out.width; x++) {
+			const float cx = ((float)x + 0.5f) * sx_scale;
+			const float cy = ((float)y + 0.5f) * sy_scale;
+			float *d = out.at(x, y);
+			for (const auto &o : offsets) {
+				float s[3];
+				sample_bilinear_clamp(*source, cx + o[0], cy + o[1], s);
+				for (int c = 0; c < 3; c++)
+					d[c] += s[c] * o[2] / 8.0f;
+			}
+		}
+	}
+}
+
+// 逐像素收集 (glow_mode 0)。lod 为 0 时抽头直接读画面，结果和参考相同；
+// 否则先按 Box 把画面缩小 lod 次，抽头位置不变，从小图双线性采样再取亮部
+static void glow_gather(const rgb_image &src, const glow_layer_def &layer, int lod, rgb_image &out)
+{
+	const int r = (int)layer.radius;
+	if (lod == 0) {
+		rgb_image bright;
+		bright_pass(src, layer.threshold, bright);
+		box_average(bright, r, out);
+		return;
+	}
+
+	rgb_image small = src;
+	for (int i = 0; i < lod; i++) {
+		rgb_image next;
+		next.resize(std::max((small.width + 1) / 2, 1), std::max((small.height + 1) / 2, 1));
+		for (int y = 0; y < next.height; y++)
+			for (int x = 0; x < next.width; x++)
+				sample_bilinear_clamp(small, ((float)x + 0.5f) * (float)small.width / (float)next.width,
+						      ((float)y + 0.5f) * (float)small.height / (float)next.height,
+						      next.at(x, y));
+		small = std::move(next);
+	}
+
+	// 每个全分辨率抽头位置上的采样值，向外多算 r 个像素（画面外的抽头也会读到小图边缘的一部分）
+	rgb_image taps;
+	taps.resize(src.width + 2 * r, src.height + 2 * r);
+	const float sx = (float)small.width / (float)src.width;
+	const float sy = (float)small.height / (float)src.height;
+	for (int y = 0; y < taps.height; y++)
+		for (int x = 0; x < taps.width; x++)
+			sample_bilinear(small, ((float)(x - r) + 0.5f) * sx, ((float)(y - r) + 0.5f) * sy,
+					taps.at(x, y));
+
+	rgb_image bright, blurred;
+	bright_pass(taps, layer.threshold, bright);
+	box_average(bright, r, blurred);
+
+	out.resize(src.width, src.height);
+	for (int y = 0; y < src.height; y++)
+		memcpy(out.at(0, y), blurred.at(r, y + r), sizeof(float) * 3 * (size_t)src.width);
+}
+
+// 光晕门控的第一级：每 8x8 像素一个格子的最大亮度
+static std::vector<float> cell_max_luma(const rgb_image &src, int &width, int &height)
+{
+	width = (src.width + 7) / 8;
+	height = (src.height + 7) / 8;
+	std::vector<float> cells((size_t)width * height, 0.0f);
+	for (int y = 0; y < src.height; y++)
+		for (int x = 0; x < src.width; x++) {
+			float &cell = cells[(size_t)(y / 8) * width + x / 8];
+			cell = std::max(cell, luma(src.at(x, y)));
+		}
+	return cells;
+}
+
+// 和 film-look-splat 的 mark_active 相同：超过阈值（减去余量）的格子再向外扩一格
+static int mark_active(const std::vector<float> &cells, int width, int height, float threshold,
+		       std::vector<uint8_t> &active)
+{
+	active.assign(cells.size(), 0);
+	int count = 0;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			if (cells[(size_t)y * width + x] < threshold - FILM_LOOK_SPLAT_MARGIN)
+				continue;
+			for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ny++) {
+				for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); nx++) {
+					uint8_t &cell = active[(size_t)ny * width + nx];
+					count += cell == 0;
+					cell = 1;
+				}
+			}
+		}
+	}
+	return count;
+}
+
+// 稀疏溅射 (glow_mode 1)：CellSum 求每个 4x4 子格子的亮部之和，Splat 按盒式滤波和子格子的重叠面积
+// 加到周围的像素上。任何一层的亮格子太密时插件整体退回逐像素收集，这里返回 false。
+// sprite_pixels 累加四边形覆盖的像素数，用来估算读取数
+static bool glow_sparse(const rgb_image &src, const std::vector<glow_layer_def> &layers,
+			std::vector<rgb_image> &glows, double &sprite_pixels)
+{
+	int cells_width, cells_height;
+	const std::vector<float> cells = cell_max_luma(src, cells_width, cells_height);
+	const int max_cells = (int)((float)(cells_width * cells_height) * FILM_LOOK_SPLAT_MAX_DENSITY);
+
+	std::vector<std::vector<uint8_t>> active(layers.size());
+	for (size_t l = 0; l < layers.size(); l++)
+		if (mark_active(cells, cells_width, cells_height, layers[l].threshold, active[l]) > max_cells)
+			return false;
+
+	const int sub_width = (src.width + 3) / 4;
+	const int sub_height = (src.height + 3) / 4;
+	glows.assign(layers.size(), rgb_image());
+	sprite_pixels = 0.0;
+	for (size_t l = 0; l < layers.size(); l++) {
+		const int r = (int)layers[l].radius;
+		const float inv_taps = 1.0f / (float)((2 * r + 1) * (2 * r + 1));
+		rgb_image &out = glows[l];
+		out.resize(src.width, src.height);
+
+		for (int cy = 0; cy < sub_height; cy++) {
+			for (int cx = 0; cx < sub_width; cx++) {
+				if (!active[l][(size_t)(cy / 2) * cells_width + cx / 2])
+					continue;
+
+				const int bx = cx * 4;
+				const int by = cy * 4;
+				float sum[3] = {0.0f, 0.0f, 0.0f};
+				for (int y = by; y < std::min(by + 4, src.height); y++) {
+					for (int x = bx; x < std::min(bx + 4, src.width); x++) {
+						const float *c = src.at(x, y);
+						const float t = bright_factor(c, layers[l].threshold);
+						for (int k = 0; k < 3; k++)
+							sum[k] += c[k] * t;
+					}
+				}
+				sprite_pixels += (double)((2 * r + 4) * (2 * r + 4));
+
+				for (int y = std::max(by - r, 0); y <= std::min(by + 3 + r, src.height - 1); y++) {
+					const int oy = std::min(y + r, by + 3) - std::max(y - r, by) + 1;
+					const int x1 = std::min(bx + 3 + r, src.width - 1);
+					for (int x = std::max(bx - r, 0); x <= x1; x++) {
+						const int ox = std::min(x + r, bx + 3) - std::max(x - r, bx) + 1;
+						const float area = (float)(std::max(ox, 0) * std::max(oy, 0)) / 16.0f;
+						const float w = area * inv_taps;
+						float *d = out.at(x, y);
+						for (int k = 0; k < 3; k++)
+							d[k] += sum[k] * w;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// 内置层换成自定义光晕层：所有层共用一次亮部提取（阈值取最低的）和金字塔，
+// 每层按半径在相邻两级之间插值，更高的阈值按亮度比例扣掉
+static void glow_layers(const rgb_image &src, const film_look_params &params, std::vector<rgb_image> &glows)
+{
+	const float threshold = film_look_glow_pyramid_threshold(&params);
+	std::vector<rgb_image> levels(FILM_LOOK_GLOW_PYRAMID_LEVELS);
+	kawase_down(src, true, threshold, levels[0]);
+	for (int i = 1; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++)
+		kawase_down(levels[i - 1], false, 0.0f, levels[i]);
+
+	glows.assign(params.glow_layer_count, rgb_image());
+	for (int l = 0; l < params.glow_layer_count; l++) {
+		const film_look_glow_layer &layer = params.glow_layers[l];
+		const float level = film_look_glow_pyramid_level(layer.radius);
+		const int l0 = (int)level;
+		const int l1 = std::min(l0 + 1, FILM_LOOK_GLOW_PYRAMID_LEVELS - 1);
+		const float f = level - (float)l0;
+		const float extra = layer.threshold - threshold;
+
+		rgb_image &out = glows[l];
+		out.resize(src.width, src.height);
+		for (int y = 0; y < src.height; y++) {
+			for (int x = 0; x < src.width; x++) {
+				const float u = ((float)x + 0.5f) / (float)src.width;
+				const float v = ((float)y + 0.5f) / (float)src.height;
+				float a[3], b[3];
+				sample_bilinear_clamp(levels[l0], u * levels[l0].width, v * levels[l0].height, a);
+				sample_bilinear_clamp(levels[l1], u * levels[l1].width, v * levels[l1].height, b);
+				float *d = out.at(x, y);
+				for (int c = 0; c < 3; c++)
+					d[c] = a[c] + (b[c] - a[c]) * f;
+				const float scale = std::clamp(1.0f - extra / std::max(luma(d), 1e-4f), 0.0f, 1.0f);
+				for (int c = 0; c < 3; c++)
+					d[c] *= scale;
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// 合成与度量
+
+static void builtin_layers(const film_look_params &p, std::vector<glow_layer_def> &layers)
+{
+	layers.clear();
+	if (p.bloom_intensity > 0.0f)
+		layers.push_back({p.bloom_threshold,
+				  (float)p.bloom_radius,
+				  {1.0f, 1.0f, 1.0f},
+				  p.bloom_intensity,
+				  FILM_LOOK_GLOW_BLEND_ADD});
+	if (p.halation_intensity > 0.0f)
+		layers.push_back({p.halation_threshold,
+				  (float)p.halation_radius,
+				  {1.0f, 0.2f, 0.1f},
+				  p.halation_intensity,
+				  FILM_LOOK_GLOW_BLEND_SCREEN});
+	if (p.secondary_glow_intensity > 0.0f)
+		layers.push_back({p.secondary_glow_threshold,
+				  (float)p.secondary_glow_radius,
+				  {0.6f, 0.8f, 1.0f},
+				  p.secondary_glow_intensity,
+				  FILM_LOOK_GLOW_BLEND_SCREEN});
+}
+
+static void custom_layers(const film_look_params &p, std::vector<glow_layer_def> &layers)
+{
+	layers.clear();
+	for (int i = 0; i < p.glow_layer_count; i++) {
+		const film_look_glow_layer &l = p.glow_layers[i];
+		layers.push_back({l.threshold, l.radius, {l.tint[0], l.tint[1], l.tint[2]}, l.intensity, l.blend});
+	}
+}
+
+// 和 mainImage 的 PART 1 + PART 3 相同（颗粒和抖动在探索时关掉）
+static void compose(const film_look_params &p, const rgb_image &src, const std::vector<glow_layer_def> &layers,
+		    const std::vector<rgb_image> &glows, rgb_image &out)
+{
+	out.resize(src.width, src.height);
+	for (size_t i = 0; i < (size_t)src.width * src.height; i++) {
+		float c[3] = {src.px[i * 3 + 0], src.px[i * 3 + 1], src.px[i * 3 + 2]};
+		film_look_cpu_grade(&p, c);
+
+		for (size_t l = 0; l < layers.size(); l++) {
+			const float *g = glows[l].px.data() + i * 3;
+			for (int k = 0; k < 3; k++) {
+				const float v = g[k] * layers[l].tint[k] * layers[l].intensity;
+				if (layers[l].blend == FILM_LOOK_GLOW_BLEND_ADD)
+					c[k] += v;
+				else if (layers[l].blend == FILM_LOOK_GLOW_BLEND_SCREEN)
+					c[k] = 1.0f - (1.0f - c[k]) * (1.0f - v);
+				else
+					c[k] = std::max(c[k], v);
+			}
+		}
+
+		for (int k = 0; k < 3; k++)
+			out.px[i * 3 + k] = std::clamp(c[k], 0.0f, 1.0f);
+	}
+}
+
+static double psnr(const rgb_image &a, const rgb_image &b)
+{
+	double mse = 0.0;
+	for (size_t i = 0; i < a.px.size(); i++) {
+		const double d = (double)a.px[i] - (double)b.px[i];
+		mse += d * d;
+	}
+	mse /= (double)a.px.size();
+	return mse > 0.0 ? std::min(10.0 * std::log10(1.0 / mse), 99.0) : 99.0;
+}
+
+// 亮度通道上 8x8 窗口、步长 4 的 SSIM 平均值
+static double ssim(const rgb_image &a, const rgb_image &b)
+{
+	const double c1 = 0.01 * 0.01;
+	const double c2 = 0.03 * 0.03;
+	auto pixel_luma = [](const rgb_image &img, int x, int y) { return (double)luma(img.at(x, y)); };
+
+	double total = 0.0;
+	int windows = 0;
+	for (int y = 0; y + 8 <= a.height; y += 4) {
+		for (int x = 0; x + 8 <= a.width; x += 4) {
+			double ma = 0, mb = 0, va = 0, vb = 0, cov = 0;
+			for (int j = 0; j < 8; j++) {
+				for (int i = 0; i < 8; i++) {
+					ma += pixel_luma(a, x + i, y + j);
+					mb += pixel_luma(b, x + i, y + j);
+				}
+			}
+			ma /= 64.0;
+			mb /= 64.0;
+			for (int j = 0; j < 8; j++) {
+				for (int i = 0; i < 8; i++) {
+					const double da = pixel_luma(a, x + i, y + j) - ma;
+					const double db = pixel_luma(b, x + i, y + j) - mb;
+					va += da * da;
+					vb += db * db;
+					cov += da * db;
+				}
+			}
+			va /= 63.0;
+			vb /= 63.0;
+			cov /= 63.0;
+			total += ((2 * ma * mb + c1) * (2 * cov + c2)) / ((ma * ma + mb * mb + c1) * (va + vb + c2));
+			windows++;
+		}
+	}
+	return windows ? total / windows : 1.0;
+}
+
+static void srgb_to_lab(const float *c, double lab[3])
+{
+	double lin[3];
+	for (int i = 0; i < 3; i++) {
+		const double v = c[i];
+		lin[i] = v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+	}
+
+	// D65
+	const double x = (0.4124564 * lin[0] + 0.3575761 * lin[1] + 0.1804375 * lin[2]) / 0.95047;
+	const double y = 0.2126729 * lin[0] + 0.7151522 * lin[1] + 0.0721750 * lin[2];
+	const double z = (0.0193339 * lin[0] + 0.1191920 * lin[1] + 0.9503041 * lin[2]) / 1.08883;
+	auto f = [](double t) { return t > 216.0 / 24389.0 ? std::cbrt(t) : (24389.0 / 27.0 * t + 16.0) / 116.0; };
+
+	lab[0] = 116.0 * f(y) - 16.0;
+	lab[1] = 500.0 * (f(x) - f(y));
+	lab[2] = 200.0 * (f(y) - f(z));
+}
+
+// CIEDE2000 (Sharma, Wu, Dalal 2005)
+static double delta_e2000(const double lab1[3], const double lab2[3])
+{
+	const double pi = 3.14159265358979323846;
+	auto deg = [&](double r) { return r * 180.0 / pi; };
+	auto rad = [&](double d) { return d * pi / 180.0; };
+
+	const double c1 = std::hypot(lab1[1], lab1[2]);
+	const double c2 = std::hypot(lab2[1], lab2[2]);
+	const double c_bar = (c1 + c2) / 2.0;
+	const double c_bar7 = std::pow(c_bar, 7.0);
+	const double g = 0.5 * (1.0 - std::sqrt(c_bar7 / (c_bar7 + std::pow(25.0, 7.0))));
+
+	const double a1 = lab1[1] * (1.0 + g);
+	const double a2 = lab2[1] * (1.0 + g);
+	const double cp1 = std::hypot(a1, lab1[2]);
+	const double cp2 = std::hypot(a2, lab2[2]);
+	double hp1 = (a1 == 0.0 && lab1[2] == 0.0) ? 0.0 : deg(std::atan2(lab1[2], a1));
+	double hp2 = (a2 == 0.0 && lab2[2] == 0.0) ? 0.0 : deg(std::atan2(lab2[2], a2));
+	if (hp1 < 0.0)
+		hp1 += 360.0;
+	if (hp2 < 0.0)
+		hp2 += 360.0;
+
+	const double dl = lab2[0] - lab1[0];
+	const double dc = cp2 - cp1;
+	double dh = 0.0;
+	if (cp1 * cp2 != 0.0) {
+		dh = hp2 - hp1;
+		if (dh > 180.0)
+			dh -= 360.0;
+		else if (dh < -180.0)
+			dh += 360.0;
+	}
+	const double dH = 2.0 * std::sqrt(cp1 * cp2) * std::sin(rad(dh / 2.0));
+
+	const double l_bar = (lab1[0] + lab2[0]) / 2.0;
+	const double cp_bar = (cp1 + cp2) / 2.0;
+	double hp_bar = hp1 + hp2;
+	if (cp1 * cp2 != 0.0) {
+		if (std::fabs(hp1 - hp2) <= 180.0)
+			hp_bar /= 2.0;
+		else
+			hp_bar = hp_bar < 360.0 ? (hp_bar + 360.0) / 2.0 : (hp_bar - 360.0) / 2.0;
+	}
+
+	const double t = 1.0 - 0.17 * std::cos(rad(hp_bar - 30.0)) + 0.24 * std::cos(rad(2.0 * hp_bar)) +
+			 0.32 * std::cos(rad(3.0 * hp_bar + 6.0)) - 0.20 * std::cos(rad(4.0 * hp_bar - 63.0));
+	const double d_theta = 30.0 * std::exp(-std::pow((hp_bar - 275.0) / 25.0, 2.0));
+	const double cp_bar7 = std::pow(cp_bar, 7.0);
+	const double rc = 2.0 * std::sqrt(cp_bar7 / (cp_bar7 + std::pow(25.0, 7.0)));
+	const double sl = 1.0 + 0.015 * std::pow(l_bar - 50.0, 2.0) / std::sqrt(20.0 + std::pow(l_bar - 50.0, 2.0));
+	const double sc = 1.0 + 0.045 * cp_bar;
+	const double sh = 1.0 + 0.015 * cp_bar * t;
+	const double rt = -std::sin(rad(2.0 * d_theta)) * rc;
+
+	return std::sqrt(std::pow(dl / sl, 2.0) + std::pow(dc / sc, 2.0) + std::pow(dH / sh, 2.0) +
+			 rt * (dc / sc) * (dH / sh));
+}
+
+struct delta_e_stats {
+	double mean;
+	double p95;
+};
+
+static delta_e_stats delta_e(const rgb_image &a, const rgb_image &b)
+{
+	std::vector<double> values((size_t)a.width * a.height);
+	double sum = 0.0;
+	for (size_t i = 0; i < values.size(); i++) {
+		double la[3], lb[3];
+		srgb_to_lab(a.px.data() + i * 3, la);
+		srgb_to_lab(b.px.data() + i * 3, lb);
+		values[i] = delta_e2000(la, lb);
+		sum += values[i];
+	}
+
+	const size_t p95 = values.size() * 95 / 100;
+	std::nth_element(values.begin(), values.begin() + p95, values.end());
+	return {sum / (double)values.size(), values[p95]};
+}
+
+// ---------------------------------------------------------------------------
+
+struct result {
+	std::string mode;
+	std::string settings; // 相对 --settings 要改的设置
+	double cpu_ms = 0.0;
+	double gpu_ms = -1.0; // 没有 --gpu-times 时为负
+	double fetches = 0.0;
+	double psnr = 0.0;
+	double ssim = 0.0;
+	double de_mean = 0.0;
+	double de_p95 = 0.0;
+	int fallbacks = 0; // 稀疏溅射退回逐像素收集的画面数
+	bool pareto = false;
+};
+
+// 参考结果：完整的 CPU mainImage（逐像素收集的精确结果）
+static rgb_image render_reference(const film_look_params &p, const rgb_image &src)
+{
+	std::vector<float> in((size_t)src.width * src.height * 4);
+	std::vector<float> out(in.size());
+	for (size_t i = 0; i < (size_t)src.width * src.height; i++) {
+		in[i * 4 + 0] = src.px[i * 3 + 0];
+		in[i * 4 + 1] = src.px[i * 3 + 1];
+		in[i * 4 + 2] = src.px[i * 3 + 2];
+		in[i * 4 + 3] = 1.0f;
+	}
+
+	film_look_image src_img = {in.data(), (uint32_t)src.width, (uint32_t)src.height, (size_t)src.width * 4};
+	film_look_image dst_img = {out.data(), (uint32_t)src.width, (uint32_t)src.height, (size_t)src.width * 4};
+	struct film_look_cpu *cpu = film_look_cpu_create();
+	film_look_cpu_update(cpu, &p);
+	film_look_cpu_render(cpu, &src_img, &dst_img, 0.0f);
+	film_look_cpu_destroy(cpu);
+
+	rgb_image result;
+	result.resize(src.width, src.height);
+	for (size_t i = 0; i < (size_t)src.width * src.height; i++)
+		for (int c = 0; c < 3; c++)
+			result.px[i * 3 + c] = out[i * 4 + c];
+	return result;
+}
+
+// 每个输出像素估算的纹理读取数（含主 pass 读画面的一次），用来在没有 GPU 耗时时排序
+static double gather_fetches(const std::vector<glow_layer_def> &layers, int lod, int width, int height)
+{
+	// 各层在同一个偏移上共用一次采样，所以按最大半径算
+	int max_radius = 0;
+	for (const glow_layer_def &layer : layers)
+		max_radius = std::max(max_radius, (int)layer.radius);
+	double fetches = (double)((2 * max_radius + 1) * (2 * max_radius + 1)) + 1.0;
+
+	// 缩小采样源的 Box pass：每级每个输出像素读一次
+	int w = width, h = height;
+	for (int i = 0; i < lod; i++) {
+		w = std::max((w + 1) / 2, 1);
+		h = std::max((h + 1) / 2, 1);
+		fetches += (double)w * h / ((double)width * height);
+	}
+	return fetches;
+}
+
+static double pyramid_fetches(int layer_count, int width, int height)
+{
+	// 每级 5 次采样；合成时每层在相邻两级各读一次
+	double fetches = 2.0 * layer_count + 1.0;
+	int w = width, h = height;
+	for (int i = 0; i < FILM_LOOK_GLOW_PYRAMID_LEVELS; i++) {
+		w = std::max((w + 1) / 2, 1);
+		h = std::max((h + 1) / 2, 1);
+		fetches += 5.0 * w * h / ((double)width * height);
+	}
+	return fetches;
+}
+
+// 读 film-look-headless --csv 的输出：width,height,scene,variant,ms,filter_ms。
+// 返回 (宽, 高, 模式名) -> 各测试画面 filter ms 的平均值
+static std::map<std::tuple<int, int, std::string>, double> load_gpu_times(const char *path)
+{
+	std::map<std::tuple<int, int, std::string>, double> times;
+	std::map<std::tuple<int, int, std::string>, int> counts;
+	FILE *file = fopen(path, "r");
+	if (!file)
+		return times;
+
+	char line[512];
+	while (fgets(line, sizeof(line), file)) {
+		int w, h;
+		char scene[128], variant[128];
+		double ms, filter_ms;
+		if (sscanf(line, "%d,%d,%127[^,],%127[^,],%lf,%lf", &w, &h, scene, variant, &ms, &filter_ms) != 6)
+			continue;
+		const auto key = std::make_tuple(w, h, std::string(variant));
+		times[key] += filter_ms;
+		counts[key]++;
+	}
+	fclose(file);
+
+	for (auto &t : times)
+		t.second /= counts[t.first];
+	return times;
+}
+
+// 有 GPU 耗时就按它比较开销，否则按读取数
+static double cost(const result &r, bool use_gpu)
+{
+	return use_gpu ? r.gpu_ms : r.fetches;
+}
+
+// a 在开销（GPU 耗时或读取数，以及 CPU 耗时）和质量（PSNR、SSIM、ΔE 平均值）上都不比 b 差，且至少一项更好
+static bool dominates(const result &a, const result &b, bool use_gpu)
+{
+	const double ca = cost(a, use_gpu), cb = cost(b, use_gpu);
+	if (ca > cb || a.cpu_ms > b.cpu_ms || a.psnr < b.psnr || a.ssim < b.ssim || a.de_mean > b.de_mean)
+		return false;
+	return ca < cb || a.cpu_ms < b.cpu_ms || a.psnr > b.psnr || a.ssim > b.ssim || a.de_mean < b.de_mean;
+}
+
+static void mark_pareto(std::vector<result> &results, bool use_gpu)
+{
+	for (result &r : results) {
+		r.pareto = true;
+		for (const result &other : results) {
+			if (&other != &r && dominates(other, r, use_gpu)) {
+				r.pareto = false;
+				break;
+			}
+		}
+	}
+}
+
+// 开销最低的、p95 ΔE 不超过 limit 的结果（lod 0 的逐像素收集总满足）。大部分像素不受光晕影响，
+// 平均值拉不开差距，所以按 p95 选
+static const result *fastest_within(const std::vector<result> &results, double limit, bool use_gpu)
+{
+	const result *best = nullptr;
+	for (const result &r : results)
+		if (r.de_p95 <= limit && (!best || cost(r, use_gpu) < cost(*best, use_gpu)))
+			best = &r;
+	return best;
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: film-look-glow-explorer [--settings JSON] [--res WxH]... [--repeat N] "
+			"[--gpu-times times.csv] [--report out.md] [image.ppm]...\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *settings = nullptr;
+	const char *report_path = nullptr;
+	const char *gpu_times_path = nullptr;
+	int repeat = 1;
+	std::vector<std::pair<int, int>> resolutions;
+	std::vector<std::string> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--settings") == 0 && i + 1 < argc) {
+			settings = argv[++i];
+		} else if (strcmp(argv[i], "--res") == 0 && i + 1 < argc) {
+			int w = 0, h = 0;
+			if (sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w < 16 || h < 16) {
+				usage();
+				return 1;
+			}
+			resolutions.emplace_back(w, h);
+		} else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--gpu-times") == 0 && i + 1 < argc) {
+			gpu_times_path = argv[++i];
+		} else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+			report_path = argv[++i];
+		} else if (argv[i][0] == '-') {
+			usage();
+			return 1;
+		} else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (resolutions.empty())
+		resolutions = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+
+	film_look_params params;
+	if (!film_look_params_load_json(&params, settings)) {
+		fprintf(stderr, "invalid settings JSON\n");
+		return 1;
+	}
+	// 颗粒和抖动与光晕算法无关，关掉后结果可以逐像素比较。CPU 参考只有内置的三层，
+	// 自定义层由 layers 模式按内置层生成
+	params.grain_intensity = 0.0f;
+	params.shake_intensity = 0.0f;
+	params.glow_layer_count = 0;
+
+	std::vector<glow_layer_def> layers;
+	builtin_layers(params, layers);
+	if (layers.empty()) {
+		fprintf(stderr, "all glow layers are disabled in these settings\n");
+		return 1;
+	}
+
+	// layers 模式：内置层强度为 0，换成同样的自定义层（颜色按设置的 8 位精度）
+	film_look_params layer_params = params;
+	layer_params.glow_layer_count = glow_mode_builtin_layers(params, layer_params.glow_layers);
+	std::vector<glow_layer_def> pyramid_layers;
+	custom_layers(layer_params, pyramid_layers);
+
+	std::map<std::tuple<int, int, std::string>, double> gpu_times;
+	if (gpu_times_path) {
+		gpu_times = load_gpu_times(gpu_times_path);
+		if (gpu_times.empty()) {
+			fprintf(stderr, "no timings in %s (expected film-look-headless --csv output)\n",
+				gpu_times_path);
+			return 1;
+		}
+	}
+
+	std::vector<rgb_image> loaded;
+	for (const std::string &path : inputs) {
+		rgb_image image;
+		if (!load_ppm(path.c_str(), image)) {
+			fprintf(stderr, "failed to read %s (binary PPM, maxval 255)\n", path.c_str());
+			return 1;
+		}
+		loaded.push_back(std::move(image));
+	}
+
+	FILE *report = report_path ? fopen(report_path, "w") : stdout;
+	if (!report) {
+		fprintf(stderr, "failed to open %s\n", report_path);
+		return 1;
+	}
+
+	fprintf(report, "# Glow mode Pareto report\n\n");
+	fprintf(report, "Reference: CPU mainImage (per-pixel gather). cpu ms is the CPU emulation (best of %d); "
+			"gpu ms is the filter time measured by film-look-headless on the real effect. The Pareto "
+			"front and presets rank cost by gpu ms when it is known for every mode, otherwise by "
+			"fetches/px, the estimated texture reads per output pixel.\n\n",
+		repeat);
+
+	for (const auto &res : resolutions) {
+		std::vector<reference_scene> scenes;
+		if (loaded.empty()) {
+			scenes = synthetic_scenes(res.first, res.second);
+		} else {
+			for (size_t i = 0; i < loaded.size(); i++)
+				scenes.push_back({inputs[i], resample(loaded[i], res.first, res.second)});
+		}
+
+		std::vector<rgb_image> references;
+		for (const reference_scene &scene : scenes)
+			references.push_back(render_reference(params, scene.image));
+
+		bool use_gpu = !gpu_times.empty();
+		std::vector<result> results;
+		for (const glow_mode_def &mode : glow_modes) {
+			result r;
+			r.mode = mode.name;
+			r.settings = glow_mode_settings(mode, params);
+			const auto gpu = gpu_times.find(std::make_tuple(res.first, res.second, r.mode));
+			if (gpu != gpu_times.end())
+				r.gpu_ms = gpu->second;
+			else
+				use_gpu = false;
+
+			const bool pyramid = mode.kind == GLOW_MODE_LAYERS;
+			const std::vector<glow_layer_def> &mode_layers = pyramid ? pyramid_layers : layers;
+
+			for (size_t s = 0; s < scenes.size(); s++) {
+				rgb_image out;
+				double fetches = 0.0;
+				double best_ms = 1e30;
+				for (int rep = 0; rep < repeat; rep++) {
+					const auto start = std::chrono::steady_clock::now();
+					std::vector<rgb_image> glows;
+					double sprite_pixels = 0.0;
+					if (pyramid) {
+						glow_layers(scenes[s].image, layer_params, glows);
+						fetches = pyramid_fetches(layer_params.glow_layer_count, res.first,
+									  res.second);
+					} else if (mode.kind == GLOW_MODE_SPARSE &&
+						   glow_sparse(scenes[s].image, layers, glows, sprite_pixels)) {
+						// CellSum 每个子格子读 16 次，Splat 的四边形每个像素读一次子格子和
+						fetches = sprite_pixels / ((double)res.first * res.second) +
+							  (double)layers.size() + 1.0;
+					} else {
+						if (mode.kind == GLOW_MODE_SPARSE && rep == 0)
+							r.fallbacks++;
+						glows.assign(layers.size(), rgb_image());
+						for (size_t l = 0; l < layers.size(); l++)
+							glow_gather(scenes[s].image, layers[l], mode.lod, glows[l]);
+						fetches = gather_fetches(layers, mode.lod, res.first, res.second);
+					}
+					compose(pyramid ? layer_params : params, scenes[s].image, mode_layers, glows,
+						out);
+					best_ms = std::min(best_ms, elapsed_ms(start));
+				}
+
+				const delta_e_stats de = delta_e(references[s], out);
+				r.cpu_ms += best_ms / (double)scenes.size();
+				r.fetches += fetches / (double)scenes.size();
+				r.psnr += psnr(references[s], out) / (double)scenes.size();
+				r.ssim += ssim(references[s], out) / (double)scenes.size();
+				r.de_mean += de.mean / (double)scenes.size();
+				r.de_p95 = std::max(r.de_p95, de.p95);
+			}
+
+			results.push_back(r);
+			fprintf(stderr, "%dx%d %s: %.1f ms, dE %.3f\n", res.first, res.second, r.mode.c_str(), r.cpu_ms,
+				r.de_mean);
+		}
+
+		mark_pareto(results, use_gpu);
+
+		fprintf(report, "## %dx%d\n\n", res.first, res.second);
+		fprintf(report, "| mode | cpu ms | gpu ms | fetches/px | PSNR dB | SSIM | dE2000 mean | dE2000 p95 | "
+				"pareto | notes |\n");
+		fprintf(report, "|---|---:|---:|---:|---:|---:|---:|---:|:---:|---|\n");
+		for (const result &r : results) {
+			char gpu[32] = "-";
+			if (r.gpu_ms >= 0.0)
+				snprintf(gpu, sizeof(gpu), "%.2f", r.gpu_ms);
+			char notes[64] = "";
+			if (r.fallbacks)
+				snprintf(notes, sizeof(notes), "gather fallback on %d/%zu scenes", r.fallbacks,
+					 scenes.size());
+			fprintf(report, "| %s | %.2f | %s | %.1f | %.2f | %.4f | %.3f | %.3f | %s | %s |\n",
+				r.mode.c_str(), r.cpu_ms, gpu, r.fetches, r.psnr, r.ssim, r.de_mean, r.de_p95,
+				r.pareto ? "*" : "", notes);
+		}
+
+		// ΔE < 1 一般看不出差别，< 2 仔细对比才能看出
+		static const struct {
+			const char *name;
+			double limit;
+		} presets[] = {{"quality", 1.0}, {"balanced", 2.0}, {"performance", 1e30}};
+
+		fprintf(report, "\nRecommended presets (ranked by %s):\n\n", use_gpu ? "gpu ms" : "fetches/px");
+		for (const auto &preset : presets) {
+			const result *r = fastest_within(results, preset.limit, use_gpu);
+			if (r)
+				fprintf(report, "- %s: %s, dE p95 %.3f; settings: %s\n", preset.name, r->mode.c_str(),
+					r->de_p95, r->settings.c_str());
+		}
+		fprintf(report, "\n");
+	}
+
+	if (report != stdout)
+		fclose(report);
+	return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// 光晕探索工具和无界面基准共用的光晕模式列表。每种模式都是插件里能直接选的设置组合：
+// 探索工具在 CPU 上按 shader 的做法模拟画面并和参考比较，无界面基准（--glow-modes）
+// 用真实的 effect 测 GPU 耗时，两边按 name 对应。
+
+#include "film-look-params.h"
+
+#include <cstdio>
+#include <string>
+
+enum glow_mode_kind {
+	GLOW_MODE_GATHER, // 逐像素收集，lod > 0 时从缩小的拷贝采样
+	GLOW_MODE_SPARSE, // 只溅射亮的格子，太密时退回收集
+	GLOW_MODE_LAYERS, // 内置三层换成同样的自定义光晕层，走亮部金字塔
+};
+
+struct glow_mode_def {
+	const char *name;
+	glow_mode_kind kind;
+	int lod;              // glow_source_lod
+	const char *settings; // 这个模式要改的设置（JSON 成员），layers 的各层另外生成
+};
+
+static const glow_mode_def glow_modes[] = {
+	{"gather", GLOW_MODE_GATHER, 0, R"("glow_mode": 0, "glow_source_lod": 0)"},
+	{"gather-half", GLOW_MODE_GATHER, 1, R"("glow_mode": 0, "glow_source_lod": 1)"},
+	{"gather-quarter", GLOW_MODE_GATHER, 2, R"("glow_mode": 0, "glow_source_lod": 2)"},
+	{"sparse", GLOW_MODE_SPARSE, 0, R"("glow_mode": 1, "glow_source_lod": 0)"},
+	{"layers", GLOW_MODE_LAYERS, 0,
+	 R"("glow_mode": 0, "glow_source_lod": 0, "bloom_intensity": 0.0, "halation_intensity": 0.0, )"
+	 R"("secondary_glow_intensity": 0.0)"},
+};
+
+#define GLOW_MODE_COUNT (sizeof(glow_modes) / sizeof(glow_modes[0]))
+
+// 设置里的颜色是 8 位的，按同样的精度取整，模拟结果才和插件读到的一致
+static inline float glow_mode_tint(float value)
+{
+	return (float)(int)(value * 255.0f + 0.5f) / 255.0f;
+}
+
+// 把强度大于 0 的内置层换成阈值、半径、颜色、强度和混合方式都相同的自定义光晕层，返回层数
+static inline int glow_mode_builtin_layers(const film_look_params &p, film_look_glow_layer *layers)
+{
+	const struct {
+		float intensity;
+		float threshold;
+		int radius;
+		float tint[3];
+		int blend;
+	} builtin[] = {
+		{p.bloom_intensity, p.bloom_threshold, p.bloom_radius, {1.0f, 1.0f, 1.0f}, FILM_LOOK_GLOW_BLEND_ADD},
+		{p.halation_intensity,
+		 p.halation_threshold,
+		 p.halation_radius,
+		 {1.0f, 0.2f, 0.1f},
+		 FILM_LOOK_GLOW_BLEND_SCREEN},
+		{p.secondary_glow_intensity,
+		 p.secondary_glow_threshold,
+		 p.secondary_glow_radius,
+		 {0.6f, 0.8f, 1.0f},
+		 FILM_LOOK_GLOW_BLEND_SCREEN},
+	};
+
+	int count = 0;
+	for (const auto &b : builtin) {
+		if (b.intensity <= 0.0f)
+			continue;
+		film_look_glow_layer &layer = layers[count++];
+		layer.threshold = b.threshold;
+		for (int c = 0; c < 3; c++)
+			layer.tint[c] = glow_mode_tint(b.tint[c]);
+		layer.radius = (float)b.radius;
+		layer.intensity = b.intensity;
+		layer.blend = b.blend;
+	}
+	return count;
+}
+
+// 这个模式相对 p 要改的设置，逗号分隔的 JSON 成员，拼在原设置的后面（后出现的键覆盖前面的）
+static inline std::string glow_mode_settings(const glow_mode_def &mode, const film_look_params &p)
+{
+	std::string json = mode.settings;
+	if (mode.kind != GLOW_MODE_LAYERS)
+		return json;
+
+	film_look_glow_layer layers[3];
+	const int count = glow_mode_builtin_layers(p, layers);
+	char buf[256];
+	snprintf(buf, sizeof(buf), ", \"glow_layer_count\": %d", count);
+	json += buf;
+	for (int i = 0; i < count; i++) {
+		const film_look_glow_layer &layer = layers[i];
+		const unsigned tint = 0xff000000u | ((unsigned)(layer.tint[2] * 255.0f + 0.5f) << 16) |
+				      ((unsigned)(layer.tint[1] * 255.0f + 0.5f) << 8) |
+				      (unsigned)(layer.tint[0] * 255.0f + 0.5f);
+		snprintf(buf, sizeof(buf),
+			 ", \"glow_layer_%d_threshold\": %g, \"glow_layer_%d_tint\": %u, \"glow_layer_%d_radius\": %g"
+			 ", \"glow_layer_%d_intensity\": %g, \"glow_layer_%d_blend\": %d",
+			 i + 1, layer.threshold, i + 1, tint, i + 1, layer.radius, i + 1, layer.intensity, i + 1,
+			 layer.blend);
+		json += buf;
+	}
+	return json;
+}
@@ -0,0 +1,230 @@
+// 把扫描得到的可平铺颗粒帧（8 位灰度 PGM，P5）打包成 .flgp 颗粒包。
+// 用法: film-look-grain-pack -o out.flgp [--stock NAME] [--iso N] [--fps F] frame0.pgm frame1.pgm ...
+// 颗粒应当以 128 为均值（中性灰），所有帧尺寸相同且为 4 的倍数。
+
+#include "film-look-grain.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct grey_image {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<uint8_t> pixels;
+};
+
+static bool read_token(FILE *file, std::string &token)
+{
+	token.clear();
+	int c = fgetc(file);
+	while (c != EOF) {
+		if (c == '#') {
+			while (c != EOF && c != '\n')
+				c = fgetc(file);
+		} else if (!isspace(c)) {
+			break;
+		}
+		c = fgetc(file);
+	}
+	while (c != EOF && !isspace(c)) {
+		token.push_back((char)c);
+		c = fgetc(file);
+	}
+	return !token.empty();
+}
+
+static bool load_pgm(const char *path, grey_image &image)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	std::string magic, width, height, maxval;
+	bool ok = read_token(file, magic) && magic == "P5" && read_token(file, width) && read_token(file, height) &&
+		  read_token(file, maxval) && atoi(maxval.c_str()) == 255;
+	if (ok) {
+		image.width = (uint32_t)atoi(width.c_str());
+		image.height = (uint32_t)atoi(height.c_str());
+		image.pixels.resize((size_t)image.width * image.height);
+		ok = fread(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+	}
+
+	fclose(file);
+	return ok;
+}
+
+// 灰度存在 6 位的绿色端点里（shader 读 .g），红蓝只是为了预览时看起来是灰的
+static uint16_t pack_grey565(uint32_t g6)
+{
+	const uint32_t rb5 = g6 >> 1;
+	return (uint16_t)((rb5 << 11) | (g6 << 5) | rb5);
+}
+
+static float expand_g6(uint32_t g6)
+{
+	return (float)((g6 << 2) | (g6 >> 4));
+}
+
+static void encode_block(const uint8_t block[16], uint8_t out[8])
+{
+	const uint8_t lo = *std::min_element(block, block + 16);
+	const uint8_t hi = *std::max_element(block, block + 16);
+	uint32_t g_hi = (hi * 63 + 127) / 255;
+	uint32_t g_lo = (lo * 63 + 127) / 255;
+
+	uint32_t indices = 0;
+	if (g_hi == g_lo) {
+		// 端点相同时不能进入四色模式 (c0 > c1)，所有像素取 c0
+		g_lo = g_hi > 0 ? g_hi - 1 : 0;
+		g_hi = g_lo + 1;
+		const float v = (float)(hi + lo) * 0.5f;
+		if (std::abs(v - expand_g6(g_lo)) < std::abs(v - expand_g6(g_hi)))
+			indices = 0x55555555; // 全部取 c1
+	} else {
+		const float c0 = expand_g6(g_hi);
+		const float c1 = expand_g6(g_lo);
+		const float palette[4] = {c0, c1, (2.0f * c0 + c1) / 3.0f, (c0 + 2.0f * c1) / 3.0f};
+
+		for (int i = 0; i < 16; i++) {
+			uint32_t best = 0;
+			float best_err = 1e9f;
+			for (uint32_t p = 0; p < 4; p++) {
+				const float err = std::abs((float)block[i] - palette[p]);
+				if (err < best_err) {
+					best_err = err;
+					best = p;
+				}
+			}
+			indices |= best << (i * 2);
+		}
+	}
+
+	const uint16_t c0 = pack_grey565(g_hi);
+	const uint16_t c1 = pack_grey565(g_lo);
+	out[0] = (uint8_t)(c0 & 0xff);
+	out[1] = (uint8_t)(c0 >> 8);
+	out[2] = (uint8_t)(c1 & 0xff);
+	out[3] = (uint8_t)(c1 >> 8);
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+static void encode_frame(const grey_image &image, std::vector<uint8_t> &out)
+{
+	out.resize((size_t)film_look_grain_frame_bytes(image.width, image.height));
+	uint8_t *dst = out.data();
+
+	for (uint32_t by = 0; by < image.height; by += 4) {
+		for (uint32_t bx = 0; bx < image.width; bx += 4, dst += 8) {
+			uint8_t block[16];
+			for (int y = 0; y < 4; y++)
+				memcpy(block + y * 4, &image.pixels[(size_t)(by + y) * image.width + bx], 4);
+			encode_block(block, dst);
+		}
+	}
+}
+
+static int usage(void)
+{
+	fprintf(stderr,
+		"usage: film-look-grain-pack -o out.flgp [--stock NAME] [--iso N] [--fps F] frame.pgm...\n");
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	struct film_look_grain_header header = {};
+	header.magic = FILM_LOOK_GRAIN_MAGIC;
+	header.version = FILM_LOOK_GRAIN_VERSION;
+	header.format = FILM_LOOK_GRAIN_FORMAT_DXT1;
+	header.fps = 24.0f;
+
+	const char *output = nullptr;
+	std::vector<const char *> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else if (strcmp(argv[i], "--stock") == 0 && i + 1 < argc)
+			strncpy(header.stock, argv[++i], sizeof(header.stock) - 1);
+		else if (strcmp(argv[i], "--iso") == 0 && i + 1 < argc)
+			header.iso = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			header.fps = (float)atof(argv[++i]);
+		else if (argv[i][0] == '-')
+			return usage();
+		else
+			inputs.push_back(argv[i]);
+	}
+
+	if (!output || inputs.empty())
+		return usage();
+	if (inputs.size() > FILM_LOOK_GRAIN_MAX_FRAMES) {
+		fprintf(stderr, "too many frames (max %d)\n", FILM_LOOK_GRAIN_MAX_FRAMES);
+		return 1;
+	}
+	if (!(header.fps > 0.0f && header.fps <= 240.0f)) {
+		fprintf(stderr, "fps must be in (0, 240]\n");
+		return 1;
+	}
+
+	FILE *file = fopen(output, "wb");
+	if (!file) {
+		fprintf(stderr, "cannot create %s\n", output);
+		return 1;
+	}
+
+	header.frame_count = (uint32_t)inputs.size();
+	fwrite(&header, sizeof(header), 1, file);
+
+	grey_image image;
+	std::vector<uint8_t> blocks;
+	for (const char *input : inputs) {
+		if (!load_pgm(input, image)) {
+			fprintf(stderr, "%s: not an 8-bit binary PGM\n", input);
+			fclose(file);
+			remove(output);
+			return 1;
+		}
+
+		const bool first = input == inputs.front();
+		if (first) {
+			header.width = image.width;
+			header.height = image.height;
+		}
+		if (image.width != header.width || image.height != header.height || image.width % 4 != 0 ||
+		    image.height % 4 != 0 || image.width > FILM_LOOK_GRAIN_MAX_SIZE ||
+		    image.height > FILM_LOOK_GRAIN_MAX_SIZE) {
+			fprintf(stderr, "%s: frames must share one size, a multiple of 4 up to %d\n", input,
+				FILM_LOOK_GRAIN_MAX_SIZE);
+			fclose(file);
+			remove(output);
+			return 1;
+		}
+
+		encode_frame(image, blocks);
+		fwrite(blocks.data(), 1, blocks.size(), file);
+	}
+
+	// 尺寸在读到第一帧后才知道，回头补写文件头
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+
+	bool ok = ferror(file) == 0;
+	ok = fclose(file) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "failed to write %s\n", output);
+		remove(output);
+		return 1;
+	}
+
+	printf("%s: %u frames of %ux%u, %llu bytes per frame\n", output, header.frame_count, header.width,
+	       header.height, (unsigned long long)film_look_grain_frame_bytes(header.width, header.height));
+	return 0;
+}
@@ -0,0 +1,667 @@
+// 无界面运行真实 shader 的测试 / 基准程序：启动 libobs 的 OpenGL 后端，加载插件模块，
+// 把合成画面经过 film_look_creator 滤镜的各个变体渲染出来，保存结果并计时。
+// 去掉颗粒和抖动的变体还会和 CPU 参考实现 (film-look-cpu) 逐像素比较，超出容差时返回非 0。
+// --instances N 在同一个源上叠加 N 个相同的滤镜，配合很小的 --size 可以看出每个实例的 CPU 端开销
+// （参数上传、变体查找），此时 filter ms 是平均到每个实例的耗时，不再和 CPU 实现比较。
+// --glow-modes 改为测 film-look-glow-modes.h 里的各个光晕模式（在 --settings 的基础上修改），
+// --csv 把结果写成光晕探索工具 --gpu-times 读的格式。
+// 滤镜把每个 pass（截取画面、亮度归约、溅射、缩小的采样源、金字塔、参数上传、主 pass、灰尘）包在
+// libobs 分析器的作用域里，结果后面按作用域列出每帧的耗时。分析器计的是 CPU 时间：提交命令的开销，
+// 加上驱动在提交时同步完成的部分；GPU 异步执行的部分只体现在整帧的 ms 里。
+//
+// 用法: film-look-headless [--plugin path.so] [--data dir] [--size WxH] [--frames N] [--out dir]
+//                          [--settings file.json] [--tolerance T] [--instances N]
+//                          [--glow-modes] [--csv times.csv] [--verbose]
+//
+// libobs-opengl 在 Linux 上只支持 X11 / Wayland 的 EGL（OBS_NIX_PLATFORM_X11_EGL / WAYLAND），
+// gl_platform_create 总要一个原生显示，没有 EGL_PLATFORM_SURFACELESS_MESA 的入口，所以没有 GPU 的机器上
+// 用 Xvfb + Mesa llvmpipe 运行，例如:
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a film-look-headless --out results
+
+#include "film-look-cpu.h"
+#include "film-look-glow-modes.h"
+#include "film-look-params.h"
+
+#include <obs.h>
+#include <obs-nix-platform.h>
+#include <graphics/vec4.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+
+#include <X11/Xlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef FILM_LOOK_BENCH_PLUGIN
+#define FILM_LOOK_BENCH_PLUGIN ""
+#endif
+#ifndef FILM_LOOK_BENCH_DATA
+#define FILM_LOOK_BENCH_DATA ""
+#endif
+
+#define BENCH_SOURCE_ID "film_look_bench_source"
+#define BENCH_WARMUP_FRAMES 10
+
+struct bench_variant {
+	const char *name;
+	std::string json;
+	bool compare; // 结果是确定的，可以和 CPU 参考实现比较
+};
+
+struct bench_scene {
+	const char *name;
+	std::vector<uint8_t> rgba;
+};
+
+struct bench_source {
+	gs_texture_t *texture;
+	uint32_t width;
+	uint32_t height;
+};
+
+static bool verbose = false;
+
+// 合成画面的测试源：只画当前场景的纹理
+static bench_source current = {};
+
+static void log_handler(int lvl, const char *msg, va_list args, void *param)
+{
+	(void)param;
+	if (!verbose && lvl > LOG_WARNING)
+		return;
+
+	vfprintf(stderr, msg, args);
+	fputc('\n', stderr);
+}
+
+static const char *bench_source_get_name(void *)
+{
+	return "Film Look Bench Source";
+}
+
+static void *bench_source_create(obs_data_t *, obs_source_t *)
+{
+	return &current;
+}
+
+static void bench_source_destroy(void *) {}
+
+static uint32_t bench_source_get_width(void *)
+{
+	return current.width;
+}
+
+static uint32_t bench_source_get_height(void *)
+{
+	return current.height;
+}
+
+static void bench_source_render(void *, gs_effect_t *)
+{
+	if (!current.texture)
+		return;
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), current.texture);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite(current.texture, 0, current.width, current.height);
+}
+
+static struct obs_source_info bench_source_info = {
+	.id = BENCH_SOURCE_ID,
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW,
+	.get_name = bench_source_get_name,
+	.create = bench_source_create,
+	.destroy = bench_source_destroy,
+	.get_width = bench_source_get_width,
+	.get_height = bench_source_get_height,
+	.video_render = bench_source_render,
+};
+
+static uint32_t hash_u32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+// 暗背景上的点光源和一块窗户高光（测光晕），以及覆盖整个色彩范围的渐变（测调色）
+static std::vector<bench_scene> make_scenes(uint32_t width, uint32_t height)
+{
+	std::vector<bench_scene> scenes(2);
+
+	scenes[0].name = "lights";
+	scenes[0].rgba.assign((size_t)width * height * 4, 0);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint8_t *p = scenes[0].rgba.data() + ((size_t)y * width + x) * 4;
+			const bool window = x > width * 6 / 10 && x < width * 8 / 10 && y > height / 5 && y < height / 2;
+			p[0] = window ? 255 : (uint8_t)(12 + 10 * y / height);
+			p[1] = window ? 250 : (uint8_t)(10 + 8 * y / height);
+			p[2] = window ? 235 : (uint8_t)(16 + 6 * y / height);
+			p[3] = 255;
+		}
+	}
+	for (uint32_t i = 0; i < 80; i++) {
+		const uint32_t cx = hash_u32(i * 2 + 1) % width;
+		const uint32_t cy = hash_u32(i * 2 + 2) % height;
+		const uint32_t r = 1 + hash_u32(i + 999) % 4;
+		for (uint32_t y = cy > r ? cy - r : 0; y <= std::min(cy + r, height - 1); y++) {
+			for (uint32_t x = cx > r ? cx - r : 0; x <= std::min(cx + r, width - 1); x++) {
+				uint8_t *p = scenes[0].rgba.data() + ((size_t)y * width + x) * 4;
+				p[0] = 255;
+				p[1] = (uint8_t)(200 + hash_u32(i + 7) % 56);
+				p[2] = (uint8_t)(150 + hash_u32(i + 13) % 106);
+			}
+		}
+	}
+
+	scenes[1].name = "ramp";
+	scenes[1].rgba.assign((size_t)width * height * 4, 255);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint8_t *p = scenes[1].rgba.data() + ((size_t)y * width + x) * 4;
+			p[0] = (uint8_t)(255 * x / (width - 1));
+			p[1] = (uint8_t)(255 * y / (height - 1));
+			p[2] = (uint8_t)(255 - 255 * x / (width - 1));
+		}
+	}
+
+	return scenes;
+}
+
+static bool write_ppm(const char *path, const uint8_t *rgba, uint32_t width, uint32_t height)
+{
+	FILE *file = os_fopen(path, "wb");
+	if (!file)
+		return false;
+
+	fprintf(file, "P6\n%u %u\n255\n", width, height);
+	std::vector<uint8_t> row((size_t)width * 3);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++)
+			memcpy(row.data() + x * 3, rgba + ((size_t)y * width + x) * 4, 3);
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	return fclose(file) == 0;
+}
+
+struct render_target {
+	gs_texrender_t *texrender;
+	gs_stagesurf_t *stage;
+};
+
+// 渲染一帧并读回。map 会等 GPU 执行完，所以返回的时间包含整帧的 GPU 工作。
+static uint64_t render_frame(render_target *target, obs_source_t *source, uint32_t width, uint32_t height,
+			     std::vector<uint8_t> *pixels)
+{
+	obs_enter_graphics();
+	const uint64_t start = os_gettime_ns();
+
+	gs_texrender_reset(target->texrender);
+	if (gs_texrender_begin(target->texrender, width, height)) {
+		struct vec4 clear_color;
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+
+		gs_blend_state_push();
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+		obs_source_video_render(source);
+		gs_blend_state_pop();
+
+		gs_texrender_end(target->texrender);
+	}
+
+	gs_stage_texture(target->stage, gs_texrender_get_texture(target->texrender));
+	uint8_t *data;
+	uint32_t linesize;
+	if (gs_stagesurface_map(target->stage, &data, &linesize)) {
+		if (pixels) {
+			pixels->resize((size_t)width * height * 4);
+			for (uint32_t y = 0; y < height; y++)
+				memcpy(pixels->data() + (size_t)y * width * 4, data + (size_t)y * linesize,
+				       (size_t)width * 4);
+		}
+		gs_stagesurface_unmap(target->stage);
+	}
+
+	const uint64_t elapsed = os_gettime_ns() - start;
+	obs_leave_graphics();
+	return elapsed;
+}
+
+// 滤镜各个 pass 的分析器作用域（名字以 film_look_ 开头），按名字累计的总耗时（微秒）和调用次数
+struct scope_total {
+	uint64_t usec = 0;
+	uint64_t calls = 0;
+};
+typedef std::map<std::string, scope_total> scope_totals;
+
+static bool collect_scope(void *context, profiler_snapshot_entry_t *entry)
+{
+	scope_totals *totals = static_cast<scope_totals *>(context);
+	const char *name = profiler_snapshot_entry_name(entry);
+	if (name && strncmp(name, "film_look_", 10) == 0) {
+		scope_total &total = (*totals)[name];
+		const profiler_time_entries_t *times = profiler_snapshot_entry_times(entry);
+		for (size_t i = 0; i < times->num; i++)
+			total.usec += times->array[i].time_delta * times->array[i].count;
+		total.calls += profiler_snapshot_entry_overall_count(entry);
+	}
+	profiler_snapshot_enumerate_children(entry, collect_scope, context);
+	return true;
+}
+
+static scope_totals snapshot_scopes(void)
+{
+	scope_totals totals;
+	profiler_snapshot_t *snap = profile_snapshot_create();
+	profiler_snapshot_enumerate(snap, collect_scope, &totals);
+	profile_snapshot_free(snap);
+	return totals;
+}
+
+// 先预热（编译 effect 变体、填满光晕门控的读回），再取 frames 帧耗时的中位数，单位毫秒。
+// scopes 不为空时返回计时的这几帧里各个作用域的累计值（不含预热）
+static double time_frames(render_target *target, obs_source_t *source, uint32_t width, uint32_t height, int frames,
+			  std::vector<uint8_t> *pixels, scope_totals *scopes)
+{
+	// 中间让出时间给 OBS 的图形线程 tick 滤镜
+	for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+		render_frame(target, source, width, height, nullptr);
+		os_sleep_ms(16);
+	}
+
+	const scope_totals before = scopes ? snapshot_scopes() : scope_totals();
+	std::vector<uint64_t> times;
+	for (int i = 0; i < frames; i++)
+		times.push_back(render_frame(target, source, width, height, i == frames - 1 ? pixels : nullptr));
+
+	if (scopes) {
+		*scopes = snapshot_scopes();
+		for (auto &scope : *scopes) {
+			const auto prev = before.find(scope.first);
+			if (prev == before.end())
+				continue;
+			scope.second.usec -= prev->second.usec;
+			scope.second.calls -= prev->second.calls;
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+	return (double)times[times.size() / 2] / 1e6;
+}
+
+// 同样的输入和参数用 CPU 实现渲染，返回平均 / 最大绝对误差（0~1）
+static void compare_with_cpu(const char *json, const std::vector<uint8_t> &input, const std::vector<uint8_t> &output,
+			     uint32_t width, uint32_t height, double *mean_error, double *max_error)
+{
+	film_look_params params;
+	film_look_params_load_json(&params, json);
+
+	const size_t count = (size_t)width * height * 4;
+	std::vector<float> src(count), dst(count);
+	for (size_t i = 0; i < count; i++)
+		src[i] = (float)input[i] / 255.0f;
+
+	film_look_image src_img = {src.data(), width, height, (size_t)width * 4};
+	film_look_image dst_img = {dst.data(), width, height, (size_t)width * 4};
+	struct film_look_cpu *cpu = film_look_cpu_create();
+	film_look_cpu_update(cpu, &params);
+	film_look_cpu_render(cpu, &src_img, &dst_img, 0.0f);
+	film_look_cpu_destroy(cpu);
+
+	double sum = 0.0;
+	double max = 0.0;
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		for (int c = 0; c < 3; c++) {
+			const double diff = std::fabs((double)dst[i * 4 + c] - (double)output[i * 4 + c] / 255.0);
+			sum += diff;
+			max = std::max(max, diff);
+		}
+	}
+	*mean_error = sum / ((double)width * height * 3);
+	*max_error = max;
+}
+
+static std::vector<bench_variant> make_variants(const char *settings_path)
+{
+	static const char *still = R"("grain_intensity": 0.0, "shake_intensity": 0.0)";
+
+	std::vector<bench_variant> variants = {
+		{"reference", std::string("{") + still + "}", true},
+		{"grade-only",
+		 std::string("{") + still +
+			 R"(, "bloom_intensity": 0.0, "halation_intensity": 0.0, "secondary_glow_intensity": 0.0})",
+		 true},
+		{"stock", std::string("{") + still + R"(, "film_stock": 1})", true},
+		{"wide-glow",
+		 std::string("{") + still + R"(, "bloom_radius": 5, "halation_radius": 8, "secondary_glow_radius": 7})",
+		 true},
+		{"wide-glow-half",
+		 std::string("{") + still +
+			 R"(, "bloom_radius": 5, "halation_radius": 8, "secondary_glow_radius": 7, "glow_source_lod": 1})",
+		 false},
+		{"wide-glow-quarter",
+		 std::string("{") + still +
+			 R"(, "bloom_radius": 5, "halation_radius": 8, "secondary_glow_radius": 7, "glow_source_lod": 2})",
+		 false},
+		{"default", "{}", false},
+		{"sparse", R"({"glow_mode": 1})", false},
+		{"glow-layers", R"({"glow_layer_count": 4})", false},
+	};
+
+	if (settings_path) {
+		char *json = os_quick_read_utf8_file(settings_path);
+		if (json) {
+			variants.push_back({"custom", json, false});
+			bfree(json);
+		} else {
+			fprintf(stderr, "failed to read %s\n", settings_path);
+		}
+	}
+	return variants;
+}
+
+// 把逗号分隔的 JSON 成员拼进对象 json（后出现的键覆盖前面的）
+static std::string merge_json(const std::string &json, const std::string &members)
+{
+	const size_t end = json.find_last_of('}');
+	if (end == std::string::npos)
+		return "{" + members + "}";
+
+	std::string merged = json.substr(0, end);
+	const size_t last = merged.find_last_not_of(" \t\r\n");
+	if (last != std::string::npos && merged[last] != '{')
+		merged += ", ";
+	return merged + members + "}";
+}
+
+// 光晕探索工具模拟的各个模式，颗粒和抖动关掉，自定义层只由 layers 模式生成
+static std::vector<bench_variant> make_glow_mode_variants(const char *settings_path)
+{
+	std::string base = "{}";
+	if (settings_path) {
+		char *json = os_quick_read_utf8_file(settings_path);
+		if (!json) {
+			fprintf(stderr, "failed to read %s\n", settings_path);
+			return {};
+		}
+		base = json;
+		bfree(json);
+	}
+	base = merge_json(base, R"("grain_intensity": 0.0, "shake_intensity": 0.0, "glow_layer_count": 0)");
+
+	film_look_params params;
+	if (!film_look_params_load_json(&params, base.c_str())) {
+		fprintf(stderr, "invalid settings JSON\n");
+		return {};
+	}
+
+	std::vector<bench_variant> variants;
+	for (const glow_mode_def &mode : glow_modes)
+		variants.push_back({mode.name, merge_json(base, glow_mode_settings(mode, params)), false});
+	return variants;
+}
+
+static void remove_filters(obs_source_t *source, std::vector<obs_source_t *> &filters)
+{
+	for (obs_source_t *filter : filters) {
+		obs_source_filter_remove(source, filter);
+		obs_source_release(filter);
+	}
+	filters.clear();
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: film-look-headless [--plugin path] [--data dir] [--size WxH] [--frames N] [--out dir]\n"
+			"                          [--settings file.json] [--tolerance T] [--instances N]\n"
+			"                          [--glow-modes] [--csv times.csv] [--verbose]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *plugin_path = FILM_LOOK_BENCH_PLUGIN;
+	const char *data_path = FILM_LOOK_BENCH_DATA;
+	const char *out_dir = "headless-out";
+	const char *settings_path = nullptr;
+	const char *csv_path = nullptr;
+	bool glow_modes_only = false;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	int frames = 30;
+	int instances = 1;
+	double tolerance = 2.0 / 255.0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) {
+			plugin_path = argv[++i];
+		} else if (strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+			data_path = argv[++i];
+		} else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			if (sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width < 16 || height < 16) {
+				usage();
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frames = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_dir = argv[++i];
+		} else if (strcmp(argv[i], "--settings") == 0 && i + 1 < argc) {
+			settings_path = argv[++i];
+		} else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+			tolerance = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+			instances = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--glow-modes") == 0) {
+			glow_modes_only = true;
+		} else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+			csv_path = argv[++i];
+		} else if (strcmp(argv[i], "--verbose") == 0) {
+			verbose = true;
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+	if (!*plugin_path) {
+		usage();
+		return 1;
+	}
+
+	std::vector<bench_variant> variants = glow_modes_only ? make_glow_mode_variants(settings_path)
+							      : make_variants(settings_path);
+	if (variants.empty())
+		return 1;
+
+	Display *display = XOpenDisplay(nullptr);
+	if (!display) {
+		fprintf(stderr, "no X display; run under xvfb-run\n");
+		return 1;
+	}
+
+	base_set_log_handler(log_handler, nullptr);
+	obs_set_nix_platform(OBS_NIX_PLATFORM_X11_EGL);
+	obs_set_nix_platform_display(display);
+
+	if (!obs_startup("en-US", nullptr, nullptr)) {
+		fprintf(stderr, "obs_startup failed\n");
+		return 1;
+	}
+
+	struct obs_video_info ovi = {};
+	ovi.graphics_module = "libobs-opengl";
+	ovi.fps_num = 60;
+	ovi.fps_den = 1;
+	ovi.base_width = ovi.output_width = width;
+	ovi.base_height = ovi.output_height = height;
+	ovi.output_format = VIDEO_FORMAT_RGBA;
+	ovi.gpu_conversion = true;
+	ovi.colorspace = VIDEO_CS_SRGB;
+	ovi.range = VIDEO_RANGE_FULL;
+	ovi.scale_type = OBS_SCALE_BILINEAR;
+
+	int exit_code = 0;
+	obs_module_t *module = nullptr;
+	if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
+		fprintf(stderr, "failed to start the OpenGL backend\n");
+		exit_code = 1;
+	} else if (obs_open_module(&module, plugin_path, *data_path ? data_path : nullptr) != MODULE_SUCCESS ||
+		   !obs_init_module(module)) {
+		fprintf(stderr, "failed to load %s\n", plugin_path);
+		exit_code = 1;
+	}
+
+	if (exit_code) {
+		obs_shutdown();
+		XCloseDisplay(display);
+		return exit_code;
+	}
+
+	FILE *csv = nullptr;
+	if (csv_path) {
+		csv = os_fopen(csv_path, "w");
+		if (!csv) {
+			fprintf(stderr, "failed to open %s\n", csv_path);
+			obs_shutdown();
+			XCloseDisplay(display);
+			return 1;
+		}
+		fprintf(csv, "width,height,scene,variant,ms,filter_ms\n");
+	}
+
+	obs_register_source(&bench_source_info);
+	os_mkdirs(out_dir);
+
+	std::vector<bench_scene> scenes = make_scenes(width, height);
+
+	render_target target = {};
+	obs_enter_graphics();
+	target.texrender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	target.stage = gs_stagesurface_create(width, height, GS_RGBA);
+	obs_leave_graphics();
+
+	obs_source_t *source = obs_source_create(BENCH_SOURCE_ID, "bench", nullptr, nullptr);
+	obs_source_inc_showing(source);
+
+	// 各个 pass 的耗时等整张表输出完再列
+	profiler_start();
+	std::vector<std::string> scope_rows;
+
+	printf("| scene | variant | ms/frame | filter ms | mean err | max err | result |\n");
+	printf("|---|---|---:|---:|---:|---:|---|\n");
+
+	for (const bench_scene &scene : scenes) {
+		obs_enter_graphics();
+		const uint8_t *planes[] = {scene.rgba.data()};
+		gs_texture_destroy(current.texture);
+		current.texture = gs_texture_create(width, height, GS_RGBA, 1, planes, 0);
+		obs_leave_graphics();
+		current.width = width;
+		current.height = height;
+
+		// 不带滤镜的耗时：只有测试源本身的绘制和读回
+		const double baseline = time_frames(&target, source, width, height, frames, nullptr, nullptr);
+
+		for (const bench_variant &variant : variants) {
+			obs_data_t *settings = obs_data_create_from_json(variant.json.c_str());
+			std::vector<obs_source_t *> filters;
+			for (int i = 0; i < instances; i++) {
+				obs_source_t *filter =
+					obs_source_create("film_look_creator", variant.name, settings, nullptr);
+				if (!filter)
+					break;
+				obs_source_filter_add(source, filter);
+				filters.push_back(filter);
+			}
+			obs_data_release(settings);
+
+			std::vector<uint8_t> pixels;
+			scope_totals scopes;
+			double ms = 0.0;
+			if ((int)filters.size() == instances)
+				ms = time_frames(&target, source, width, height, frames, &pixels, &scopes);
+			else
+				fprintf(stderr, "failed to create the film look filter\n");
+			if (pixels.empty()) {
+				if ((int)filters.size() == instances)
+					fprintf(stderr, "failed to read back %s / %s\n", scene.name, variant.name);
+				remove_filters(source, filters);
+				exit_code = 1;
+				continue;
+			}
+			const double filter_ms = (ms - baseline) / instances;
+
+			std::string path = std::string(out_dir) + "/" + scene.name + "-" + variant.name + ".ppm";
+			if (!write_ppm(path.c_str(), pixels.data(), width, height))
+				fprintf(stderr, "failed to write %s\n", path.c_str());
+
+			if (variant.compare && instances == 1) {
+				double mean_error, max_error;
+				compare_with_cpu(variant.json.c_str(), scene.rgba, pixels, width, height, &mean_error,
+						 &max_error);
+				const bool pass = mean_error <= tolerance;
+				printf("| %s | %s | %.2f | %.2f | %.5f | %.5f | %s |\n", scene.name, variant.name, ms,
+				       filter_ms, mean_error, max_error, pass ? "ok" : "FAIL");
+				if (!pass)
+					exit_code = 2;
+			} else {
+				printf("| %s | %s | %.2f | %.2f | - | - | - |\n", scene.name, variant.name, ms, filter_ms);
+			}
+			fflush(stdout);
+			if (csv)
+				fprintf(csv, "%u,%u,%s,%s,%.4f,%.4f\n", width, height, scene.name, variant.name, ms,
+					filter_ms);
+
+			for (const auto &scope : scopes) {
+				if (!scope.second.calls)
+					continue;
+				char row[256];
+				snprintf(row, sizeof(row), "| %s | %s | %s | %.3f | %.2f |", scene.name, variant.name,
+					 scope.first.c_str(), (double)scope.second.usec / 1000.0 / frames / instances,
+					 (double)scope.second.calls / frames / instances);
+				scope_rows.push_back(row);
+			}
+
+			remove_filters(source, filters);
+		}
+	}
+
+	printf("\n| scene | variant | pass | cpu ms/frame | calls/frame |\n");
+	printf("|---|---|---|---:|---:|\n");
+	for (const std::string &row : scope_rows)
+		printf("%s\n", row.c_str());
+
+	obs_source_dec_showing(source);
+	obs_source_release(source);
+
+	obs_enter_graphics();
+	gs_texture_destroy(current.texture);
+	current.texture = nullptr;
+	gs_stagesurface_destroy(target.stage);
+	gs_texrender_destroy(target.texrender);
+	obs_leave_graphics();
+
+	obs_shutdown();
+	profiler_stop();
+	profiler_free();
+	XCloseDisplay(display);
+	if (csv)
+		fclose(csv);
+	return exit_code;
+}